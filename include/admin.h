@@ -56,6 +56,17 @@
  */
  void admin_doctor_menu(void);
  
+/**
+ * Views hospital-wide and per-doctor appointment counters.
+ */
+ void admin_view_appointment_stats(void);
+
+/**
+ * Views the call counts and latencies of loads, saves, searches and
+ * logins recorded since the program started with --stats.
+ */
+ void admin_view_operation_stats(void);
+
 /**
  * Main admin menu.
  */
@@ -23,11 +23,24 @@
  int appointment_load_from_file(void);
 
 /**
- * Generates a unique appointment ID.
+ * Generates a unique appointment ID, after the highest one in use.
  * @return The generated appointment ID.
  */
  int appointment_generate_id(void);
 
+/**
+ * Notes an appointment ID that came into the table, so new IDs continue
+ * after it.
+ * @param id The appointment ID.
+ */
+ void appointment_note_id(int id);
+
+/**
+ * Finds the highest appointment ID in use again, from the table and the
+ * sealed history, after either was loaded or replaced.
+ */
+ void appointment_rescan_ids(void);
+
 /**
  * Creates a new appointment (called by receptionist).
  */
@@ -39,6 +52,15 @@
  */
  void appointment_view_by_doctor(int doctor_id);
 
+/**
+ * Books an already validated appointment as pending, giving it the next
+ * ID, and keeps the counters, the doctor portal schedule, the doctor load
+ * heap and the reminders in sync. Does not save or print anything.
+ * @param appt The appointment; receives its ID and status.
+ * @return Index of the appointment in the array, or -1 if the table is full.
+ */
+ int appointment_insert(Appointment* appt);
+
 /**
  * Updates appointment status.
  * @param appt_id The appointment ID.
@@ -46,6 +68,15 @@
  */
  void appointment_update_status(int appt_id, AppointmentStatus status);
 
+/**
+ * Changes an appointment's status and keeps the counters, the doctor
+ * portal schedule, the doctor load heap and the reminders in sync.
+ * Does not save or print anything.
+ * @param index Index of the appointment in the array.
+ * @param status The new status.
+ */
+ void appointment_set_status(int index, AppointmentStatus status);
+
 /**
  * Cancels an appointment.
  * @param appt_id The appointment ID.
@@ -73,4 +104,11 @@
  */
 void ui_print_appointment(Appointment appt, int index);
 
+/**
+ * Lists an appointment as a table row or a card, by ui_list_mode().
+ * @param appt The appointment to list.
+ * @param index The display index (cards only).
+ */
+void ui_list_appointment(Appointment appt, int index);
+
 #endif
@@ -0,0 +1,87 @@
+/**
+ * @file appointment_archive.h
+ * @brief Sealed monthly appointment history for Healthcare Management System
+ *
+ * Completed and cancelled appointments from closed months are moved out of
+ * the resident appointment table into one read-only segment file per month.
+ * Only open appointments stay in appointments.dat; history is read back
+ * from the segments on demand.
+ */
+
+#ifndef APPOINTMENT_ARCHIVE_H
+#define APPOINTMENT_ARCHIVE_H
+
+#include "hospital.h"
+
+#define APPT_ARCHIVE_MAGIC  0x31414D48u     /* "HMA1", starts the segment index */
+
+typedef struct {
+    int month;      /* YYYYMM */
+    int seq;        /* Sequence number within the month */
+    int count;      /* Number of appointments in the segment */
+    int min_id;
+    int max_id;
+} AppointmentSegment;
+
+/**
+ * Loads the segment index from binary file. The index in memory is kept
+ * if the file cannot be read.
+ * @return 0 on success, -1 if file doesn't exist or is unreadable.
+ */
+ int appointment_archive_load_from_file(void);
+
+/**
+ * Saves the segment index to binary file.
+ * @return 0 on success, -1 on failure.
+ */
+ int appointment_archive_save_to_file(void);
+
+/**
+ * Ships the segment index and every segment file, as they are on disk,
+ * to the replica journal.
+ */
+ void appointment_archive_replicate(void);
+
+/**
+ * Seals finished appointments from months before current_month into
+ * read-only segment files and removes them from the resident table.
+ * @param current_month The current month as YYYYMM.
+ * @return Number of appointments sealed, or -1 on failure.
+ */
+ int appointment_archive_seal(int current_month);
+
+/**
+ * Gets the number of appointments stored in sealed segments.
+ * @return The archived appointment count.
+ */
+ int appointment_archive_total(void);
+
+/**
+ * Gets the highest appointment ID stored in sealed segments.
+ * @return The highest archived ID, or 0 if nothing is archived.
+ */
+ int appointment_archive_max_id(void);
+
+/**
+ * Loads every sealed appointment for a month.
+ * @param month The month as YYYYMM.
+ * @param out Buffer to receive the appointments.
+ * @param max Capacity of the buffer.
+ * @return Number of appointments loaded.
+ */
+ int appointment_archive_load_month(int month, Appointment* out, int max);
+
+/**
+ * Calls fn for every sealed appointment, one segment in memory at a time.
+ * @param fn Callback for each appointment.
+ * @return 0 on success, -1 if a segment could not be read.
+ */
+ int appointment_archive_for_each(void (*fn)(const Appointment* appt));
+
+/**
+ * Views a doctor's (or everyone's) appointment history for a month.
+ * @param doctor_id The doctor's ID, or 0 for all doctors.
+ */
+ void appointment_view_history(int doctor_id);
+
+#endif
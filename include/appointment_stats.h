@@ -0,0 +1,94 @@
+/**
+ * @file appointment_stats.h
+ * @brief Appointment counters for Healthcare Management System
+ *
+ * This header declares the per (doctor, status, day) appointment counters.
+ * The counters are updated in O(1) whenever an appointment is created or
+ * changes status, so dashboard views never scan the appointment table.
+ */
+
+#ifndef APPOINTMENT_STATS_H
+#define APPOINTMENT_STATS_H
+
+#include "hospital.h"
+
+#define APPT_STATS_SLOTS    4096    /* Initial hash table size, a power of two; doubles past 3/4 full */
+#define APPT_STATS_ALL      0       /* doctor_id for hospital-wide counters */
+#define APPT_STATS_ANY_DAY  -1      /* day for all-time counters */
+
+typedef struct {
+    int doctor_id;                  /* APPT_STATS_ALL for every doctor */
+    int day;                        /* YYYYMMDD, 0 if undated, APPT_STATS_ANY_DAY for all-time */
+    int counts[APPT_STATUS_COUNT];  /* Indexed by AppointmentStatus */
+    bool in_use;
+} AppointmentStats;
+
+/**
+ * Clears every counter.
+ */
+ void appointment_stats_reset(void);
+
+/**
+ * Rebuilds every counter from the appointment table and sealed history.
+ */
+ void appointment_stats_rebuild(void);
+
+/**
+ * Counts a new appointment under its current status.
+ * @param appt The appointment being added.
+ */
+ void appointment_stats_add(const Appointment* appt);
+
+/**
+ * Stops counting an appointment that was removed or is about to change.
+ * @param appt The appointment as it was counted.
+ */
+ void appointment_stats_remove(const Appointment* appt);
+
+/**
+ * Moves an appointment from its old status to its current status.
+ * @param appt The appointment after the change.
+ * @param old_status The status before the change.
+ */
+ void appointment_stats_move(const Appointment* appt, AppointmentStatus old_status);
+
+/**
+ * Gets the number of appointments for a doctor, status and day.
+ * @param doctor_id The doctor's ID, or APPT_STATS_ALL.
+ * @param day The YYYYMMDD day key, or APPT_STATS_ANY_DAY.
+ * @param status The appointment status.
+ * @return The counter value.
+ */
+ int appointment_stats_count(int doctor_id, int day, AppointmentStatus status);
+
+/**
+ * Gets the number of appointments for a doctor and status in a month.
+ * @param doctor_id The doctor's ID, or APPT_STATS_ALL.
+ * @param year The year (e.g. 2025).
+ * @param month The month (1-12).
+ * @param status The appointment status.
+ * @return The sum of the daily counters for that month.
+ */
+ int appointment_stats_count_month(int doctor_id, int year, int month, AppointmentStatus status);
+
+/**
+ * Saves all counters to binary file.
+ * @return 0 on success, -1 on failure.
+ */
+ int appointment_stats_save_to_file(void);
+
+/**
+ * Loads counters from binary file, rebuilding them from the
+ * appointment table if the file is missing or out of date.
+ * @return 0 if loaded from file, 1 if rebuilt.
+ */
+ int appointment_stats_load_from_file(void);
+
+/**
+ * Prints the counters for a doctor (or the whole hospital) in a box.
+ * @param doctor_id The doctor's ID, or APPT_STATS_ALL.
+ * @param title The title of the box.
+ */
+ void appointment_stats_print(int doctor_id, const char* title);
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file audit.h
+ * @brief Audit trail for Healthcare Management System
+ *
+ * This header declares the audit event stream. Every function that changes
+ * a patient, doctor, receptionist, user or appointment records who made the
+ * change, what changed and when. Recording only copies the event into a
+ * lock-free ring in memory; a background thread writes the events to binary
+ * files in logs/, starting a new file when the current one is full.
+ *
+ * Rotated files are kept until together they pass HMS_AUDIT_MB megabytes
+ * (default AUDIT_KEEP_MB) or, if HMS_AUDIT_DAYS is set, until they are
+ * that many days old, checked at each rotation; audit.1.bin is always kept.
+ *
+ * An audit file is an AuditFileHeader followed by AuditEvent records.
+ */
+
+#ifndef AUDIT_H
+#define AUDIT_H
+
+#include <stdint.h>
+#include "hospital.h"
+
+#define AUDIT_RING_SIZE     1024                /* Events waiting for the writer, power of two */
+#define AUDIT_BATCH         64                  /* Events written per file append */
+#define AUDIT_FILE_MAX      (1024L * 1024L)     /* Bytes before the file is rotated */
+#define AUDIT_KEEP_MB       64                  /* Rotated megabytes kept, unless HMS_AUDIT_MB says otherwise */
+#define AUDIT_POLL_MS       50                  /* Writer idle wake-up */
+#define AUDIT_FULL_WAIT_MS  20                  /* Producer wait for room before appending itself */
+#define AUDIT_MAGIC         0x41534D48u         /* "HMSA", starts an audit file */
+#define AUDIT_FIELD_SIZE    16
+#define AUDIT_VALUE_SIZE    64
+
+typedef enum {
+    AUDIT_PATIENT,
+    AUDIT_DOCTOR,
+    AUDIT_RECEPTIONIST,
+    AUDIT_USER,
+    AUDIT_APPOINTMENT,
+    AUDIT_SYSTEM
+} AuditEntity;
+
+typedef enum {
+    AUDIT_CREATE,
+    AUDIT_UPDATE,
+    AUDIT_DEACTIVATE,       /* Discharge or deactivation */
+    AUDIT_DELETE,
+    AUDIT_LOST              /* System: new_value holds the number of events not written */
+} AuditAction;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+} AuditFileHeader;
+
+typedef struct {
+    int64_t timestamp;                      /* Seconds since the epoch */
+    uint32_t sequence;                      /* Per process, from 0; shared by events appended past a full ring */
+    int32_t process;                        /* Process ID of the terminal */
+    int32_t user_id;                        /* 0 if nobody is logged in */
+    int32_t entity_id;
+    uint8_t role;                           /* UserRole of user_id */
+    uint8_t entity;                         /* AuditEntity */
+    uint8_t action;                         /* AuditAction */
+    uint8_t reserved;
+    char username[USERNAME_SIZE];
+    char field[AUDIT_FIELD_SIZE];
+    char old_value[AUDIT_VALUE_SIZE];
+    char new_value[AUDIT_VALUE_SIZE];
+} AuditEvent;
+
+/**
+ * Starts the audit writer and reads the retention from HMS_AUDIT_MB and
+ * HMS_AUDIT_DAYS. Events recorded before it starts are kept in the ring
+ * and written once it runs.
+ * @return 0 if started, -1 if unsupported (events are then written by
+ *         audit_record and audit_flush).
+ */
+ int audit_start(void);
+
+/**
+ * Records a change made by the logged-in user. Makes no system calls
+ * while the ring has room. When it is full, waits up to AUDIT_FULL_WAIT_MS
+ * for the writer and then appends the event to the file itself.
+ * @param entity The kind of record changed.
+ * @param entity_id ID of the record.
+ * @param action What was done.
+ * @param field Name of the changed field, may be NULL.
+ * @param old_value Value before the change, may be NULL.
+ * @param new_value Value after the change, may be NULL.
+ */
+ void audit_record(AuditEntity entity, int entity_id, AuditAction action,
+                   const char* field, const char* old_value, const char* new_value);
+
+/**
+ * Waits until every event recorded so far is written.
+ * @return 0 on success, -1 if events could not be written.
+ */
+ int audit_flush(void);
+
+#endif
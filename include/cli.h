@@ -0,0 +1,44 @@
+/**
+ * @file cli.h
+ * @brief Non-interactive commands for Healthcare Management System
+ *
+ * This header declares the scripted interface (hms patient ..., hms appt
+ * ..., hms query ...). A command runs one core operation on the loaded
+ * tables without drawing any menus and prints its result as tab-separated
+ * lines: a header line naming the columns, then one line per record.
+ * Errors go to stderr; the exit status is 0 on success, 1 if the
+ * operation failed and 2 for a malformed command.
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include "hospital.h"
+
+#define CLI_EXIT_OK         0
+#define CLI_EXIT_FAILED     1
+#define CLI_EXIT_USAGE      2
+#define CLI_MAX_FILTERS     8       /* FIELD=VALUE terms per query */
+
+/**
+ * Checks whether a program argument names a command.
+ * @param name The first program argument.
+ * @return true for "patient", "appt", "query", "import", "export" and "generate".
+ */
+ bool cli_is_command(const char* name);
+
+/**
+ * Runs a command on the loaded tables and saves what it changed.
+ * @param argc Number of arguments, the command name included.
+ * @param argv The arguments, starting with the command name.
+ * @return Exit status for main.
+ */
+ int cli_run(int argc, char* argv[]);
+
+/**
+ * Prints the usage of every command.
+ * @param program_name Name the program was started as.
+ */
+ void cli_print_usage(const char* program_name);
+
+#endif
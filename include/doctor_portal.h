@@ -24,11 +24,29 @@
 
 /**
  * Views today's appointments for current doctor.
+ * Served from the cached schedule when it covers today_date.
  * @param doctor_id The doctor's ID.
  * @param today_date Today's date string.
  */
  void doctor_portal_view_today(int doctor_id, const char* today_date);
 
+/**
+ * Builds the cached schedule of today's appointments for a doctor.
+ * @param doctor_id The doctor's ID.
+ */
+ void doctor_portal_schedule_build(int doctor_id);
+
+/**
+ * Drops the cached schedule (on logout).
+ */
+ void doctor_portal_schedule_invalidate(void);
+
+/**
+ * Patches the cached schedule after an appointment is created or changes status.
+ * @param appt The appointment after the change.
+ */
+ void doctor_portal_schedule_on_change(const Appointment* appt);
+
 /**
  * Views patient details for a given patient ID.
  */
@@ -58,6 +76,12 @@
  */
  void doctor_portal_view_profile(int doctor_id);
 
+/**
+ * Views appointment counters for current doctor.
+ * @param doctor_id The doctor's ID.
+ */
+ void doctor_portal_view_statistics(int doctor_id);
+
 /**
  * Main doctor portal menu.
  * @param doctor_id The doctor's ID.
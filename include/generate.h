@@ -0,0 +1,68 @@
+/**
+ * @file generate.h
+ * @brief Synthetic dataset generator for Healthcare Management System
+ *
+ * This header declares the generator behind hms generate. It fills the
+ * tables with made-up patients, doctors, receptionists, their accounts
+ * and an appointment history, then saves them through the storage layer,
+ * so the data files are exactly those the menus would have written. The
+ * same options and seed always give the same records, whatever the
+ * number of threads; dates are counted back from options->today.
+ *
+ * Every name, phone, email and address passes the utils_is_valid_*
+ * checks. Generated accounts log in with their username (dr2001,
+ * desk4001, ...) and the password GENERATE_PASSWORD.
+ */
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <stdint.h>
+#include "hospital.h"
+
+#define GENERATE_PASSWORD       "hms12345"
+#define GENERATE_DAILY_SLOTS    32      /* 9:00 AM to 4:45 PM, every 15 minutes */
+#define GENERATE_FUTURE_DAYS    30      /* Bookings reach this far past today */
+
+typedef struct {
+    int patients;
+    int doctors;
+    int receptionists;
+    int appointments;
+    uint64_t seed;
+    int threads;        /* 0 for one per CPU */
+    int today;          /* YYYYMMDD */
+} GenerateOptions;
+
+typedef struct {
+    int users;          /* Accounts added besides the existing admin */
+    int archived;       /* Appointments sealed into the monthly history */
+    int active;         /* Patients not discharged */
+} GenerateStats;
+
+/**
+ * Fills in the counts left at -1 from options->patients, within the
+ * table capacities.
+ * @param options The options to complete.
+ */
+ void generate_defaults(GenerateOptions* options);
+
+/**
+ * Checks the options against the table capacities and the data already
+ * loaded: the generator only starts from an empty hospital (the default
+ * admin account aside).
+ * @param options The options.
+ * @return NULL if they can be used, otherwise the reason they cannot.
+ */
+ const char* generate_check(const GenerateOptions* options);
+
+/**
+ * Generates the tables and saves them, sealing past months' closed
+ * appointments into the history as the program does at start-up.
+ * @param options Options that passed generate_check.
+ * @param stats Receives what was generated besides the requested counts.
+ * @return 0 on success, -1 if a table could not be saved.
+ */
+ int generate_dataset(const GenerateOptions* options, GenerateStats* stats);
+
+#endif
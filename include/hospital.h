@@ -19,11 +19,25 @@
 
 #define UI_SIZE         72
 
+/* Table capacities; override at build time, e.g. -DMAX_PATIENTS=1000 */
+#ifndef MAX_PATIENTS
 #define MAX_PATIENTS    100
+#endif
+#ifndef MAX_DOCTORS
 #define MAX_DOCTORS     20
+#endif
+#ifndef MAX_RECEPTIONISTS
 #define MAX_RECEPTIONISTS 20
+#endif
+#ifndef MAX_USERS
 #define MAX_USERS       50
+#endif
+#ifndef MAX_APPOINTMENTS
 #define MAX_APPOINTMENTS 200
+#endif
+#define MAX_APPT_SEGMENTS 1024
+#define MAX_DAILY_SCHEDULE 64       /* Appointments per doctor per day */
+#define MAX_PENDING_SCHEDULE 256    /* Pending appointments per doctor kept by the portal */
 
 #define NAME_SIZE       50
 #define PHONE_SIZE      15
@@ -55,11 +69,24 @@
 #define STATUS_LINE_SIZE    STATUS_SIZE + 20
 
 #define DATA_DIR            "data/"
-#define PATIENTS_FILE       "data/patients.dat"
+#define LOGS_DIR            "logs/"
+#define PATIENTS_FILE       "data/patients.dat"                /* Before sharding */
+#define PATIENT_SHARD_FMT   "data/patients_%d.dat"             /* Shard number */
 #define DOCTORS_FILE        "data/doctors.dat"
 #define RECEPTIONISTS_FILE  "data/receptionists.dat"
 #define USERS_FILE          "data/users.dat"
 #define APPOINTMENTS_FILE   "data/appointments.dat"
+#define APPT_STATS_FILE     "data/appointment_stats.dat"
+#define APPT_ARCHIVE_FILE   "data/appointment_archive.dat"
+#define APPT_ARCHIVE_LOCK   "data/appointment_archive.lock"    /* Held while the index is read or sealed into */
+#define APPT_SEGMENT_FMT    "data/appointments_%06d_%d.dat"    /* YYYYMM, sequence */
+#define REMINDERS_FILE      "logs/reminders.log"
+#define REMINDERS_MARK_FILE "data/reminders_fired.dat"         /* Minute reminders have been fired up to */
+#define AUDIT_FILE          "logs/audit.bin"
+#define AUDIT_ROTATED_FMT   "logs/audit.%d.bin"                /* 1 = most recent */
+#define STATS_FILE          "logs/stats.log"
+#define STATS_ROTATED_FILE  "logs/stats.1.log"
+#define SERVER_SOCKET       "data/hms.sock"
 
 #define PATIENT_ID_START      1001
 #define DOCTOR_ID_START       2001
@@ -71,6 +98,8 @@
 #define TIME_SIZE       10
 #define DATE_SIZE       15
 
+#define APPT_STATUS_COUNT   4       /* Number of AppointmentStatus values */
+
 
 #define VERSION "1.0.0"
 
@@ -206,7 +235,7 @@ void print_help(const char* program_name);
 void print_version(void);
 
 /**
- * Ensure data directory exists.
+ * Ensure data and logs directories exist.
  */
 void ensure_data_dir(void);
 
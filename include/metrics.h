@@ -0,0 +1,134 @@
+/**
+ * @file metrics.h
+ * @brief Operation timing for Healthcare Management System
+ *
+ * This header declares the counters kept around table loads and saves,
+ * record searches and logins. Each operation counts its calls and
+ * failures and sorts its latencies into a histogram of power-of-two
+ * buckets, from which percentiles are read. Every thread records into
+ * its own set of counters, so recording never contends; a report adds
+ * the sets up.
+ *
+ * Collection is off unless the program starts with --stats or HMS_STATS
+ * set; then metrics_begin returns 0 and metrics_end returns at once. While
+ * on, a snapshot of the counters is appended to logs/stats.log every
+ * HMS_STATS seconds (METRICS_SNAPSHOT_SECONDS by default) and at exit.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "hospital.h"
+
+#define METRICS_BUCKETS          40                 /* Bucket b holds [2^(b-1), 2^b) ns; the last, the rest */
+#define METRICS_THREADS          64                 /* Threads with their own counters; later ones share the last */
+#define METRICS_SNAPSHOT_SECONDS 60
+#define METRICS_FILE_MAX         (1024L * 1024L)    /* Bytes before logs/stats.log is rotated */
+
+typedef enum {
+    METRIC_LOAD_PATIENTS,
+    METRIC_LOAD_DOCTORS,
+    METRIC_LOAD_RECEPTIONISTS,
+    METRIC_LOAD_USERS,
+    METRIC_LOAD_APPOINTMENTS,
+    METRIC_LOAD_ARCHIVE,
+    METRIC_LOAD_APPT_STATS,         /* Failure: the file was missing or stale and was rebuilt */
+    METRIC_SAVE_PATIENTS,
+    METRIC_SAVE_DOCTORS,
+    METRIC_SAVE_RECEPTIONISTS,
+    METRIC_SAVE_USERS,
+    METRIC_SAVE_APPOINTMENTS,
+    METRIC_SAVE_ARCHIVE,
+    METRIC_SAVE_APPT_STATS,
+    METRIC_STORAGE_WRITE,           /* One table file written, by whichever thread writes it */
+    METRIC_SEARCH_PATIENT_ID,
+    METRIC_SEARCH_PATIENT_NAME,
+    METRIC_SEARCH_PATIENT_PHONE,
+    METRIC_SEARCH_DOCTOR_ID,
+    METRIC_SEARCH_DOCTOR_NAME,
+    METRIC_SEARCH_DOCTOR_PHONE,
+    METRIC_SEARCH_RECEPTIONIST_ID,
+    METRIC_SEARCH_APPOINTMENT_ID,
+    METRIC_AUTH_LOGIN,              /* Failure: no account matched */
+    METRIC_COUNT
+} MetricOp;
+
+typedef uint64_t MetricsTimer;      /* Start time in ns, 0 while collection is off */
+
+typedef struct {
+    uint64_t calls;
+    uint64_t failures;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t buckets[METRICS_BUCKETS];
+    int threads;                    /* Threads that recorded the operation */
+} MetricsSummary;
+
+/**
+ * Turns collection on. Call before any other thread starts.
+ * @param report Whether to print the counters to stderr at exit.
+ */
+ void metrics_start(bool report);
+
+/**
+ * Checks whether collection is on.
+ * @return true after metrics_start.
+ */
+ bool metrics_enabled(void);
+
+/**
+ * Starts timing an operation.
+ * @return The timer to pass to metrics_end.
+ */
+ MetricsTimer metrics_begin(void);
+
+/**
+ * Records an operation in the calling thread's counters, and writes a
+ * snapshot when one is due.
+ * @param op The operation.
+ * @param timer What metrics_begin returned.
+ * @param ok false to count the call as a failure.
+ */
+ void metrics_end(MetricOp op, MetricsTimer timer, bool ok);
+
+/**
+ * Adds up every thread's counters for an operation.
+ * @param op The operation.
+ * @param summary Receives the totals.
+ */
+ void metrics_summary(MetricOp op, MetricsSummary* summary);
+
+/**
+ * Reads a percentile off a histogram, as the upper bound of the bucket
+ * it falls in (never above the maximum).
+ * @param summary Totals from metrics_summary.
+ * @param percent 1 to 100.
+ * @return Latency in ns, 0 if nothing was recorded.
+ */
+ uint64_t metrics_percentile(const MetricsSummary* summary, int percent);
+
+/**
+ * Gets the name of an operation, e.g. "load.patients".
+ * @param op The operation.
+ * @return The name.
+ */
+ const char* metrics_name(MetricOp op);
+
+/**
+ * Prints the operations recorded so far as tab-separated lines, a header
+ * line first.
+ * @param out Where to print.
+ * @return 0 on success, -1 if the lines could not be written.
+ */
+ int metrics_write(FILE* out);
+
+/**
+ * Appends a snapshot to logs/stats.log, after a line with the time,
+ * process ID and uptime.
+ * @return 0 on success, -1 if the file could not be written.
+ */
+ int metrics_snapshot(void);
+
+#endif
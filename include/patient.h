@@ -33,6 +33,28 @@
  */
  void patient_add(void);
 
+/**
+ * Adds an already validated patient as active, giving it the next ID.
+ * Does not save or print anything.
+ * @param patient The patient; receives its ID.
+ * @return Index of the patient in the array, or -1 if the table is full.
+ */
+ int patient_insert(Patient* patient);
+
+/**
+ * Marks a patient as discharged and keeps the counters in step.
+ * Does not save or print anything.
+ * @param index Index of an active patient in the array.
+ */
+ void patient_set_discharged(int index);
+
+/**
+ * Removes a patient from the table for good, keeping the array in ID
+ * order and the counters in step. Does not save or print anything.
+ * @param index Index of the patient in the array.
+ */
+ void patient_remove(int index);
+
 /**
  * Searches for a patient by ID.
  */
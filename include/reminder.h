@@ -0,0 +1,95 @@
+/**
+ * @file reminder.h
+ * @brief Appointment reminder engine for Healthcare Management System
+ *
+ * This header declares the reminder scheduler. Reminders are kept in a
+ * hierarchical timing wheel with one-minute ticks, so scheduling and
+ * cancelling are O(1) and advancing the clock never scans every reminder.
+ * The minute reminders have been fired up to is kept in a data file, so a
+ * restart or a reload of the appointments does not fire them again.
+ */
+
+#ifndef REMINDER_H
+#define REMINDER_H
+
+#include "hospital.h"
+
+#define REMINDER_CAPACITY       (1 << 18)   /* Scheduled reminders, power of two */
+#define REMINDER_LEAD_MINUTES   60          /* "Due soon" fires this long before */
+#define REMINDER_GRACE_MINUTES  15          /* "Overdue" fires this long after */
+#define REMINDER_RECENT         16          /* Fired reminders kept for the portals */
+
+typedef enum {
+    REMINDER_DUE_SOON,
+    REMINDER_OVERDUE
+} ReminderKind;
+
+typedef struct {
+    ReminderKind kind;
+    int appt_id;
+    int patient_id;
+    int doctor_id;
+    char date[DATE_SIZE];
+    char time_slot[TIME_SIZE];
+    bool seen_by_doctor;
+    bool seen_by_desk;
+} Reminder;
+
+/**
+ * Resets the wheel and starts its clock. Recent reminders are kept.
+ * @param now_minute Current time in minutes since the epoch.
+ */
+ void reminder_init(int now_minute);
+
+/**
+ * Schedules reminders for every open appointment in the table, except
+ * those fired already (before a restart or a reload of the table).
+ */
+ void reminder_load_from_appointments(void);
+
+/**
+ * (Re)schedules the reminders for one appointment. Closed appointments
+ * only have their reminders cancelled.
+ * @param appt The appointment.
+ * @return 0 on success, -1 if the wheel is full or the time is invalid.
+ */
+ int reminder_schedule(const Appointment* appt);
+
+/**
+ * (Re)schedules the reminders for an appointment changed by another
+ * terminal or process, except those fired already.
+ * @param appt The appointment.
+ * @return 0 on success, -1 if the wheel is full or the time is invalid.
+ */
+ int reminder_reschedule(const Appointment* appt);
+
+/**
+ * Cancels every reminder for an appointment.
+ * @param appt_id The appointment ID.
+ */
+ void reminder_cancel(int appt_id);
+
+/**
+ * Advances the clock, firing every reminder that is due. Fired reminders
+ * are appended to the outbox file and kept for the portal screens, and
+ * the minute fired up to is saved.
+ * @param now_minute Current time in minutes since the epoch.
+ * @return Number of reminders fired.
+ */
+ int reminder_poll(int now_minute);
+
+/**
+ * Gets the number of reminders still waiting in the wheel.
+ * @return Scheduled reminder count.
+ */
+ int reminder_scheduled_count(void);
+
+/**
+ * Prints recent reminders not yet seen by a doctor (or the front desk)
+ * and marks them as seen.
+ * @param doctor_id The doctor's ID, or 0 for the front desk.
+ * @return Number of reminders printed.
+ */
+ int reminder_print_unseen(int doctor_id);
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file replay.h
+ * @brief Scripted session replay for Healthcare Management System
+ *
+ * This header declares the replay engine. hms --replay SCRIPT runs the
+ * normal menus with their input taken from SCRIPT instead of the
+ * keyboard, the screens rendered into the null sink, and reports how long
+ * each operation took. hms --record SCRIPT runs an ordinary session and
+ * writes every line typed to SCRIPT, ready to be replayed.
+ *
+ * A script holds one input line per line, exactly as typed (an empty line
+ * is an Enter). Lines starting with '#' are comments. A line "@ NAME"
+ * starts a timed operation called NAME that lasts until the next "@"
+ * line or the end of the script; repeating a name adds another sample to
+ * it. An input line that itself starts with '#', '@' or '\' is written
+ * with a '\' in front.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "hospital.h"
+
+#define REPLAY_MAX_OPERATIONS   64      /* Distinct operation names */
+#define REPLAY_NAME_SIZE        32
+
+/**
+ * Starts replaying a script: input comes from the script, ui output goes
+ * to the null sink and stdout to the null device, so only the report (on
+ * stderr) is seen. The report is printed when the script runs out or
+ * replay_finish() is called, whichever comes first.
+ * @param path The script.
+ * @return 0 on success, -1 if the script cannot be opened.
+ */
+ int replay_open(const char* path);
+
+/**
+ * Ends the last operation, waits for the queued saves (timed as
+ * "(flush)") and prints the latency report. Does nothing if no replay
+ * is running or the report was already printed.
+ */
+ void replay_finish(void);
+
+/**
+ * Records the session: every line read from stdin is also written to the
+ * script, under a single "@ session" operation.
+ * @param path The script to create.
+ * @return 0 on success, -1 if it cannot be created.
+ */
+ int replay_record(const char* path);
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file replica.h
+ * @brief Hot standby replica for Healthcare Management System
+ *
+ * This header declares log shipping to a standby data directory. With
+ * HMS_REPLICA set, every save committed to a data file is also appended
+ * to a journal in the replica directory, as the counts and the records
+ * the save wrote. A standby (hms --standby DIR) replays the journal into
+ * DIR's own data files as it grows; once stopped, DIR holds a complete
+ * copy and hms can be started from it as the new primary.
+ *
+ * The journal is a sequence of JournalRecord headers, each followed by
+ * `length` payload bytes. A table record's payload is the image counts
+ * followed by records [first, last); a file record's payload is the
+ * file's path (REPLICA_PATH_SIZE bytes) followed by its contents.
+ */
+
+#ifndef REPLICA_H
+#define REPLICA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hospital.h"
+#include "storage.h"
+
+#define REPLICA_JOURNAL     "journal.log"       /* In the replica directory */
+#define REPLICA_POSITION    "replica.pos"       /* Journal bytes the standby has applied */
+#define REPLICA_MAGIC       0x4A534D48u         /* "HMSJ", starts every journal record */
+#define REPLICA_PATH_SIZE   64
+#define REPLICA_POLL_MS     200                 /* Standby wake-up while the journal is idle */
+#define REPLICA_STATUS_SEC  10                  /* Lag report interval while idle */
+
+typedef enum {
+    JOURNAL_TABLE,      /* Records of a table */
+    JOURNAL_FILE        /* A whole file, such as a sealed archive segment */
+} JournalKind;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t kind;          /* JournalKind */
+    uint32_t table;         /* TableId */
+    uint32_t generation;    /* Primary's file generation after the save */
+    uint32_t first;         /* Records [first, last) follow the counts */
+    uint32_t last;
+    uint32_t mode;          /* File records: permission bits */
+    uint32_t length;        /* Payload bytes that follow */
+    uint32_t checksum;      /* FNV-1a of the payload */
+    uint32_t reserved;
+    int64_t timestamp;      /* Seconds since the epoch when committed */
+} JournalRecord;
+
+/**
+ * Starts shipping saves to a replica directory. If its journal is empty
+ * the current contents of every data file are written first, as the base
+ * the standby starts from. Call before hospital_init, so the saves made
+ * while loading (sealing the archive) are shipped too.
+ * @param dir The replica directory, created if missing.
+ * @return 0 on success, -1 on failure or if unsupported.
+ */
+ int replica_open(const char* dir);
+
+/**
+ * Appends a committed table save to the journal. Called by the storage
+ * layer while it still holds the data file's lock, so the journal sees
+ * saves to a table in the order they reached the file.
+ * @param table The table.
+ * @param generation The file's generation after the save.
+ * @param counts The image counts as written.
+ * @param head Size of the counts in bytes.
+ * @param first Index of the first record written.
+ * @param last Index past the last record written.
+ * @param records The records written.
+ */
+ void replica_record(TableId table, uint32_t generation, const unsigned char* counts, size_t head,
+                     uint32_t first, uint32_t last, const unsigned char* records);
+
+/**
+ * Appends a whole file, as just written, to the journal.
+ * @param path Path of the file, relative to the data directory's parent.
+ */
+ void replica_file(const char* path);
+
+/**
+ * Stops shipping and reports whether every save reached the journal.
+ * After a failed append nothing more is shipped, since the standby
+ * cannot replay past a gap.
+ * @return 0 if all appends succeeded (or not shipping), -1 otherwise.
+ */
+ int replica_close(void);
+
+/**
+ * Makes this process a standby for the data in dir: changes into it, so
+ * every table is loaded from and saved to dir, and turns off sealing and
+ * shipping, which only the primary does.
+ * Must be called before hospital_init.
+ * @param dir The replica directory.
+ * @return 0 on success, -1 if dir cannot be entered or if unsupported.
+ */
+ int replica_standby_enter(const char* dir);
+
+/**
+ * Checks whether this process is a standby.
+ * @return true after replica_standby_enter succeeded.
+ */
+ bool replica_is_standby(void);
+
+/**
+ * Replays the journal until interrupted (Ctrl+C), reporting the lag as
+ * it goes, then applies what is left so the directory can be promoted.
+ * @return Exit status for main.
+ */
+ int replica_standby_run(void);
+
+/**
+ * Checksums every table in the current data directory and in dir, one
+ * thread per side, and reports which tables differ.
+ * @param dir The replica directory.
+ * @return 0 if every table matches, 1 otherwise.
+ */
+ int replica_verify(const char* dir);
+
+#endif
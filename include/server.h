@@ -0,0 +1,91 @@
+/**
+ * @file server.h
+ * @brief Multi-terminal data server for Healthcare Management System
+ *
+ * This header declares the HMS server (hms --serve) and its wire protocol.
+ * The server owns the tables in memory and persists them; interactive
+ * terminals connect over a local UNIX-domain socket. A terminal fetches a
+ * table when it changes, asks for single records by ID or name, and sends
+ * its edits as one add, update or delete per record, which the server
+ * applies to its own copy. Every table carries a generation number and the
+ * server remembers which record each recent generation changed, so an edit
+ * is refused only when another terminal changed the same record first.
+ *
+ * A message is a fixed 12-byte header followed by `length` payload bytes,
+ * in native byte order (both ends are on the same machine).
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+#include "hospital.h"
+
+#define SERVER_TICK_MS      60000   /* Idle wake-up for reminders */
+#define SERVER_CHANGE_LOG   1024    /* Record changes remembered per table */
+
+/*
+ * Adds, updates and deletes carry the generation the terminal's copy of
+ * the table was at, and a RecordChange followed by the record (its ID
+ * alone for a delete).
+ */
+typedef enum {
+    MSG_FETCH = 1,      /* generation: last one seen, 0 for none */
+    MSG_GET = 2,        /* Payload: the record ID */
+    MSG_SEARCH = 3,     /* Payload: a name, matched exactly */
+    MSG_ADD = 4,
+    MSG_UPDATE = 5,
+    MSG_DELETE = 6
+} MessageOp;
+
+typedef enum {
+    MSG_OK,             /* Payload: image (fetch), matching records (get, search) or none */
+    MSG_NOT_MODIFIED,   /* Fetch only, no payload */
+    MSG_STALE,          /* Change refused: the record changed since, or its ID is taken */
+    MSG_ERROR,
+    MSG_NOT_FOUND       /* Get only, no payload */
+} MessageStatus;
+
+typedef struct {
+    int32_t available;      /* Change to the table's available count */
+} RecordChange;
+
+typedef struct {
+    uint8_t op;             /* MessageOp in requests, MessageStatus in replies */
+    uint8_t table;          /* TableId */
+    uint16_t reserved;
+    uint32_t generation;
+    uint32_t length;        /* Payload bytes that follow */
+} MessageHeader;
+
+/**
+ * Runs the server until interrupted. The tables must already be loaded.
+ * @param socket_path Path of the socket to listen on.
+ * @return Process exit code.
+ */
+ int server_run(const char* socket_path);
+
+/**
+ * Sends one message.
+ * @param fd Connected socket.
+ * @param op MessageOp or MessageStatus.
+ * @param table The TableId.
+ * @param generation The table generation.
+ * @param payload Payload bytes, may be NULL if length is 0.
+ * @param length Payload length.
+ * @return 0 on success, -1 on failure.
+ */
+ int server_send_message(int fd, int op, int table, uint32_t generation,
+                         const void* payload, uint32_t length);
+
+/**
+ * Receives one message.
+ * @param fd Connected socket.
+ * @param header Receives the header.
+ * @param payload Buffer to receive the payload.
+ * @param capacity Size of the buffer.
+ * @return 0 on success, -1 on failure or if the payload does not fit.
+ */
+ int server_receive_message(int fd, MessageHeader* header, void* payload, uint32_t capacity);
+
+#endif
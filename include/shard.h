@@ -0,0 +1,94 @@
+/**
+ * @file shard.h
+ * @brief Patient table shards for Healthcare Management System
+ *
+ * This header declares the ID-range sharding of the patient table. The
+ * patients array is kept in ascending ID order, so each shard (a range of
+ * PATIENT_SHARD_SPAN IDs) is a contiguous slice of it, found by binary
+ * search. Every shard is saved to its own data file under its own lock.
+ * Scans split the array into PATIENT_SHARDS equal parts instead, one per
+ * thread, since sequential IDs fill the shards unevenly, and merge the
+ * matches back in ID order.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "hospital.h"
+
+#ifndef PATIENT_SHARDS
+#define PATIENT_SHARDS      4
+#endif
+#define PATIENT_SHARD_SPAN  ((MAX_PATIENTS + PATIENT_SHARDS - 1) / PATIENT_SHARDS)   /* IDs per shard */
+#define SHARD_PARALLEL_MIN  4096    /* Smaller tables are scanned on the calling thread */
+
+/* Scan predicate; arg is passed through from shard_scan_patients */
+typedef bool (*PatientFilter)(const Patient* patient, const void* arg);
+
+/**
+ * Gets the shard a patient ID belongs to. IDs past the last range go
+ * to the last shard.
+ * @param id The patient ID.
+ * @return Shard number, 0 to PATIENT_SHARDS - 1.
+ */
+ int shard_of_patient(int id);
+
+/**
+ * Gets the slice of the patients array holding a shard.
+ * @param shard The shard number.
+ * @param begin Receives the index of its first patient.
+ * @param end Receives the index past its last patient.
+ */
+ void shard_patient_slice(int shard, int* begin, int* end);
+
+/**
+ * Finds a patient by ID with a binary search.
+ * @param id The patient ID.
+ * @return Index in the patients array, or -1 if not found.
+ */
+ int shard_find_patient(int id);
+
+/**
+ * Replaces the patients of one shard, keeping the array in ID order and
+ * the available/discharged counters in step.
+ * @param shard The shard number.
+ * @param records The shard's patients, in ascending ID order.
+ * @param count Number of records.
+ * @return 0 on success, -1 if a record is out of order, belongs to another
+ *         shard or the table would overflow.
+ */
+ int shard_replace_patients(int shard, const Patient* records, int count);
+
+/**
+ * Adds, replaces or removes one patient of a shard in place, keeping the
+ * array in ID order and the available/discharged counters in step.
+ * @param shard The shard number.
+ * @param index Position within the shard; the shard's size to add.
+ * @param record The new record, or NULL to remove the one at index.
+ * @return Change to the number of active patients, or INT_MIN if the
+ *         position is out of range, the record belongs elsewhere in the
+ *         array or another shard, or the table is full.
+ */
+ int shard_change_patient(int shard, int index, const Patient* record);
+
+/**
+ * Replaces the whole patient table with records in any order, such as a
+ * table saved before it was sharded, and sorts it into ID order.
+ * @param records The patients.
+ * @param count Number of records.
+ * @return 0 on success, -1 if there are too many.
+ */
+ int shard_adopt_patients(const Patient* records, int count);
+
+/**
+ * Finds the patients matching a filter, scanning equal parts of the
+ * table in parallel.
+ * @param filter The predicate.
+ * @param arg Passed to the predicate.
+ * @param out Receives the indices of the matches in ID order.
+ * @param max Maximum number of matches wanted.
+ * @return Number of matches stored.
+ */
+ int shard_scan_patients(PatientFilter filter, const void* arg, int* out, int max);
+
+#endif
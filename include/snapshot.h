@@ -0,0 +1,104 @@
+/**
+ * @file snapshot.h
+ * @brief Versioned table snapshots for Healthcare Management System
+ *
+ * This header declares the multi-version table store used by the HMS
+ * server. Each table is published as an immutable version (its image and
+ * generation) behind an atomic pointer. Readers pin the current version
+ * without taking any lock; the single writer publishes a new version with
+ * a pointer swap. Replaced versions are freed by epoch-based reclamation
+ * once no reader can still be using them.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include "storage.h"
+
+#define SNAPSHOT_READERS    64      /* Reader slots, one per connected terminal */
+
+typedef struct {
+    uint32_t generation;
+    uint32_t length;
+    unsigned char image[];          /* Table image, see storage.h */
+} TableVersion;
+
+/**
+ * Publishes generation 1 of every table from the loaded data.
+ * @return 0 on success, -1 if out of memory.
+ */
+ int snapshot_init(void);
+
+/**
+ * Claims a reader slot for the calling thread.
+ * @return Slot number, or -1 if every slot is taken.
+ */
+ int snapshot_register(void);
+
+/**
+ * Releases a reader slot.
+ * @param slot The slot from snapshot_register.
+ */
+ void snapshot_unregister(int slot);
+
+/**
+ * Pins the current version of a table. It stays valid and unchanged
+ * until snapshot_unpin, however many versions are published meanwhile.
+ * A slot pins one version at a time.
+ * @param slot The reader's slot.
+ * @param table The table.
+ * @return The pinned version.
+ */
+ const TableVersion* snapshot_pin(int slot, TableId table);
+
+/**
+ * Releases the version pinned by a slot.
+ * @param slot The reader's slot.
+ */
+ void snapshot_unpin(int slot);
+
+/**
+ * Locks out other writers. Reads are never blocked.
+ */
+ void snapshot_write_lock(void);
+
+/**
+ * Releases the writer lock.
+ */
+ void snapshot_write_unlock(void);
+
+/**
+ * Gets the latest generation of a table. Caller holds the writer lock.
+ * @param table The table.
+ * @return The generation.
+ */
+ uint32_t snapshot_generation(TableId table);
+
+/**
+ * Starts the next version of a table as a copy of the current one, with
+ * room for `extra` more bytes, to be changed in place by the writer and
+ * then published with snapshot_commit or dropped with snapshot_discard.
+ * Readers never see it before. Caller holds the writer lock.
+ * @param table The table.
+ * @param extra Bytes the image may grow by.
+ * @return The new version, or NULL if out of memory.
+ */
+ TableVersion* snapshot_prepare(TableId table, uint32_t extra);
+
+/**
+ * Publishes a version from snapshot_prepare and retires the old one.
+ * Caller holds the writer lock.
+ * @param table The table.
+ * @param version The prepared version.
+ * @return The new generation.
+ */
+ uint32_t snapshot_commit(TableId table, TableVersion* version);
+
+/**
+ * Drops a version from snapshot_prepare without publishing it.
+ * @param version The prepared version.
+ */
+ void snapshot_discard(TableVersion* version);
+
+#endif
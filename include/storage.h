@@ -0,0 +1,209 @@
+/**
+ * @file storage.h
+ * @brief Table storage for Healthcare Management System
+ *
+ * This header declares the storage layer shared by every data module.
+ * Each table is saved as one image (count, available count if any, then
+ * the records), which is both the body of its .dat file and the payload
+ * sent by an HMS server. When connected to a server the tables are fetched
+ * from the server, and a save sends the records that were added, changed
+ * or removed since instead of writing the data files. Each patient shard
+ * is a table of its own, with its own file, lock and generation.
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "hospital.h"
+#include "shard.h"
+
+/* The patient table is stored as PATIENT_SHARDS tables, one per shard */
+typedef enum {
+    TABLE_PATIENTS,                                 /* Shard 0, shard k is TABLE_PATIENTS + k */
+    TABLE_DOCTORS = TABLE_PATIENTS + PATIENT_SHARDS,
+    TABLE_RECEPTIONISTS,
+    TABLE_USERS,
+    TABLE_APPOINTMENTS,
+    TABLE_COUNT
+} TableId;
+
+/* Sized by the largest table */
+typedef union {
+    Patient patients[MAX_PATIENTS];
+    Doctor doctors[MAX_DOCTORS];
+    Receptionist receptionists[MAX_RECEPTIONISTS];
+    User users[MAX_USERS];
+    Appointment appointments[MAX_APPOINTMENTS];
+} TableRecords;
+
+#define STORAGE_IMAGE_MAX   (2 * sizeof(int) + sizeof(TableRecords))
+#define STORAGE_MAGIC       0x31534D48u     /* "HMS1", starts a data file header */
+#define STORAGE_CHANGE_LOG  32              /* Saves remembered in a file header */
+#define STORAGE_QUEUE_SIZE  16              /* Saves waiting for the writer, power of two */
+#define STORAGE_OWN_LOG     64              /* Generations this process wrote, > queue size */
+
+/**
+ * Encodes a table into its image.
+ * @param table The table.
+ * @param buffer Buffer to receive the image.
+ * @param capacity Size of the buffer.
+ * @return Image length in bytes, or -1 if the buffer is too small.
+ */
+ int storage_encode(TableId table, unsigned char* buffer, size_t capacity);
+
+/**
+ * Gets the path of a table's data file, relative to the data directory's parent.
+ * @param table The table.
+ * @param buffer Buffer for paths that have to be built (patient shards).
+ * @param size Size of the buffer.
+ * @return The path.
+ */
+ const char* storage_table_path(TableId table, char* buffer, size_t size);
+
+/**
+ * Gets the size of the counts at the start of a table image.
+ * @param table The table.
+ * @return Size in bytes.
+ */
+ size_t storage_counts_size(TableId table);
+
+/**
+ * Gets the size of one record of a table.
+ * @param table The table.
+ * @return Size in bytes.
+ */
+ size_t storage_record_size(TableId table);
+
+/**
+ * Finds a record in a table image by ID.
+ * @param table The table.
+ * @param image The image.
+ * @param length Image length in bytes.
+ * @param id The record ID.
+ * @return Index of the record, or -1 if the image has none with that ID.
+ */
+ int storage_find_record(TableId table, const unsigned char* image, size_t length, int id);
+
+/**
+ * Replaces a table with the contents of an image. The table is left
+ * untouched if the image is malformed.
+ * @param table The table.
+ * @param image The image.
+ * @param length Image length in bytes.
+ * @return 0 on success, -1 if the image is malformed.
+ */
+ int storage_decode(TableId table, const unsigned char* image, size_t length);
+
+/**
+ * Replaces a table with an image received from another process and
+ * refreshes everything derived from it (counters, workload, reminders).
+ * @param table The table.
+ * @param image The image.
+ * @param length Image length in bytes.
+ * @return 0 on success, -1 if the image is malformed.
+ */
+ int storage_apply(TableId table, const unsigned char* image, size_t length);
+
+/**
+ * Adds, replaces or removes one record of a table in memory and brings
+ * what is derived from it up to date for that record alone, instead of
+ * decoding the table again as storage_apply does.
+ * @param table The table.
+ * @param index Index of the record in the table's image; its record count to add.
+ * @param record The new record, or NULL to remove the one at index.
+ * @param available In: the change to the available count. Out: the change
+ *                  made, which patient shards derive from the records.
+ * @return 0 on success, -1 if the index is out of range, the table is full
+ *         or the record is out of ID order in a patient shard.
+ */
+ int storage_apply_record(TableId table, int index, const unsigned char* record, int* available);
+
+/**
+ * Saves a table to its data file, or to the server when connected.
+ * With the background writer running the save is only queued.
+ * @param table The table.
+ * @return 0 on success or once queued, -1 on failure or if another
+ *         terminal changed the same records first (the newer data is loaded instead).
+ */
+ int storage_save(TableId table);
+
+/**
+ * Loads a table from its data file, or from the server when connected.
+ * @param table The table.
+ * @return 0 on success, -1 on failure.
+ */
+ int storage_load(TableId table);
+
+/**
+ * Reads a table image straight from a data file under a shared lock,
+ * without touching the table in memory.
+ * @param table The table.
+ * @param dir Directory holding data/, such as "." or a replica directory.
+ * @param buffer Buffer to receive the image.
+ * @param capacity Size of the buffer.
+ * @param generation Receives the file's generation (0 without a header), may be NULL.
+ * @return Image length in bytes, or -1 if the file is missing or malformed.
+ */
+ int storage_read_image(TableId table, const char* dir, unsigned char* buffer, size_t capacity,
+                        uint32_t* generation);
+
+/**
+ * Starts the background writer. Later saves to the data files return at
+ * once; failures are reported on the next storage_sync or storage_flush.
+ * @return 0 if started, -1 if unsupported or connected to a server.
+ */
+ int storage_start_writer(void);
+
+/**
+ * Waits until every queued save is on disk and reports any failures.
+ * @return 0 if all saves succeeded, -1 otherwise.
+ */
+ int storage_flush(void);
+
+/**
+ * Connects to a running HMS server. Without a server the tables are
+ * read and written through the data files as before.
+ * @param socket_path Path of the server socket.
+ * @return 0 if connected, -1 if no server is running.
+ */
+ int storage_connect(const char* socket_path);
+
+/**
+ * Checks whether tables are served by an HMS server.
+ * @return true if connected to a server.
+ */
+ bool storage_is_remote(void);
+
+/**
+ * Brings one record up to date before it is edited. When connected, the
+ * server is asked for the record, and the table is fetched again only if
+ * another terminal changed it; otherwise the table's data file is caught up.
+ * @param table The table.
+ * @param id The record ID.
+ * @return 0 on success, -1 if the server is unreachable.
+ */
+ int storage_refresh_record(TableId table, int id);
+
+/**
+ * Asks the server for the records of a table with the given name (the
+ * username for users).
+ * @param table The table; appointments have no name.
+ * @param name The name, matched exactly.
+ * @param records Buffer to receive the records, in table order.
+ * @param max Records the buffer holds.
+ * @return Number of records received, or -1 if not connected or the
+ *         table cannot be searched (the table in memory is searched instead).
+ */
+ int storage_search(TableId table, const char* name, void* records, int max);
+
+/**
+ * Picks up every table another terminal has changed since it was last
+ * read, from the server when connected, otherwise from the data files
+ * (reading only the changed records).
+ * @return Number of tables refreshed, or -1 if the server is unreachable.
+ */
+ int storage_sync(void);
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file storage_io.h
+ * @brief Data file write backends for Healthcare Management System
+ *
+ * This header declares the backends the storage layer commits saves
+ * through. A commit is a small batch of positioned writes whose last
+ * write (the file header) must land after the others, followed by an
+ * optional fsync. The stdio backend issues them one call at a time, the
+ * pwrite backend skips stdio buffering, and on Linux the io_uring backend
+ * submits the whole batch, fsync included, with a single system call.
+ * Commits made inside a group are synced together when it ends, one
+ * fsync per file however many commits it took.
+ */
+
+#ifndef STORAGE_IO_H
+#define STORAGE_IO_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define STORAGE_IO_BATCH    8       /* Writes per commit, fsync excluded */
+#define STORAGE_IO_GROUP    16      /* Files a group syncs at its end, more than a batch */
+
+typedef enum {
+    STORAGE_IO_STDIO,
+    STORAGE_IO_PWRITE,
+    STORAGE_IO_URING
+} StorageIoBackend;
+
+typedef struct {
+    long offset;
+    const void* data;
+    size_t length;
+} StorageWrite;
+
+/**
+ * Selects the write backend. io_uring falls back to pwrite where the
+ * kernel does not offer it.
+ * @param backend The backend wanted.
+ * @return The backend now in use.
+ */
+ StorageIoBackend storage_io_select(StorageIoBackend backend);
+
+/**
+ * Selects the write backend by name ("stdio", "pwrite" or "uring").
+ * @param name The backend name.
+ * @return 0 on success, -1 if the name is unknown.
+ */
+ int storage_io_select_name(const char* name);
+
+/**
+ * Gets the write backend in use.
+ * @return The backend.
+ */
+ StorageIoBackend storage_io_backend(void);
+
+/**
+ * Gets the name of a backend.
+ * @param backend The backend.
+ * @return The name.
+ */
+ const char* storage_io_name(StorageIoBackend backend);
+
+/**
+ * Sets whether commits end with an fsync (on by default).
+ * @param durable true to sync every commit.
+ */
+ void storage_io_set_durable(bool durable);
+
+/**
+ * Commits a batch of writes to an open file: truncates it to `size`,
+ * performs the writes (the last one only after all others are done)
+ * and syncs it if durable, or leaves the sync to the end of the
+ * calling thread's group. Callers must not commit from two threads
+ * at once.
+ * @param file The file, opened for update.
+ * @param writes The writes, header last.
+ * @param count Number of writes, at most STORAGE_IO_BATCH.
+ * @param size Final size of the file in bytes.
+ * @return 0 on success, -1 on failure.
+ */
+ int storage_io_commit(FILE* file, const StorageWrite* writes, int count, long size);
+
+/**
+ * Starts a group on the calling thread: until storage_io_group_end its
+ * durable commits skip their fsync, and the files are synced at the end.
+ * Until then a duplicate of each file's descriptor stays open, so a
+ * flock taken on the file must be released explicitly before it is
+ * closed. Commits on other threads are not affected.
+ */
+ void storage_io_group_begin(void);
+
+/**
+ * Ends the calling thread's group and syncs every file committed in it,
+ * under io_uring with a single submission.
+ * @return 0 on success, -1 if a file could not be synced.
+ */
+ int storage_io_group_end(void);
+
+#endif
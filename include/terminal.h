@@ -0,0 +1,59 @@
+/**
+ * @file terminal.h
+ * @brief Terminal output backend for Healthcare Management System
+ *
+ * This header declares the layer between the menus and the terminal.
+ * The interactive menus run on the terminal's alternate screen, and
+ * clearing the screen is an escape sequence rather than running "clear"
+ * or "cls" through system().
+ *
+ * On Linux the backend also stands in for stdout and keeps the lines of
+ * the previous screen. After a clear, a line that is already on its row
+ * is stepped over with a line feed instead of being sent again, so moving
+ * from one menu to the next sends only the lines that changed. Rows are
+ * only tracked until the program reads input partway through a line or
+ * the screen scrolls. After that, output passes through unchanged and the
+ * rest of the old screen is erased.
+ */
+
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <stddef.h>
+#include "hospital.h"
+
+#define TERMINAL_ROWS_MAX       128             /* Lines tracked per screen */
+#define TERMINAL_LINE_MAX       1024            /* Longer lines are sent as they are */
+#define TERMINAL_SCREEN_SIZE    (64 * 1024)     /* Text kept per screen */
+
+/**
+ * Switches to the alternate screen if stdout is a terminal (and TERM is
+ * not "dumb"). The normal screen comes back on exit or on a fatal signal.
+ */
+ void terminal_open(void);
+
+/**
+ * Leaves the alternate screen and gives stdout back. Safe to call twice.
+ */
+ void terminal_close(void);
+
+/**
+ * Starts a new screen. Does nothing when stdout is not a terminal.
+ */
+ void terminal_clear(void);
+
+/**
+ * Checks whether the backend stands in for stdout.
+ * @return true between terminal_open() and terminal_close() on a Linux terminal.
+ */
+ bool terminal_is_active(void);
+
+/**
+ * Writes text that bypassed stdio (such as a composed frame) through the
+ * backend, as one write to the terminal.
+ * @param data The text.
+ * @param size Number of bytes.
+ */
+ void terminal_write(const char* data, size_t size);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @file transfer.h
+ * @brief Bulk import and export for Healthcare Management System
+ *
+ * This header declares the column layout of every table and the streaming
+ * import and export built on it. Export writes a table as CSV (a header
+ * line, then one line per record) or JSON lines (one flat object per
+ * record). Import reads the same formats in fixed-size chunks, checks each
+ * row with the same validators as the menus, appends the accepted rows and
+ * saves them every TRANSFER_BATCH rows, recording one audit event per save. Each rejected row is copied to a
+ * side file after a "# line N: reason" comment, so the file can be fixed
+ * and imported again (import skips lines starting with '#').
+ *
+ * Columns may come in any order and unknown ones are ignored. A missing
+ * or zero id gets the table's next free ID. Users are exported without
+ * their password; importing a user needs one, in plain text.
+ */
+
+#ifndef TRANSFER_H
+#define TRANSFER_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "hospital.h"
+#include "audit.h"
+
+#define TRANSFER_CHUNK      (64 * 1024)     /* Bytes read per chunk */
+#define TRANSFER_LINE_MAX   4096            /* Longer rows are rejected */
+#define TRANSFER_BATCH      4096            /* Accepted rows per save */
+#define TRANSFER_FIELD_SIZE 128             /* Largest formatted field, plus one */
+
+typedef enum {
+    TRANSFER_CSV,
+    TRANSFER_JSONL
+} TransferFormat;
+
+typedef enum {
+    COL_INT,
+    COL_TEXT,
+    COL_BOOL,
+    COL_GENDER,
+    COL_ROLE,
+    COL_STATUS
+} ColumnType;
+
+#define COLUMN_REQUIRED     1       /* Import rejects rows without it */
+#define COLUMN_SECRET       2       /* Read on import, never printed */
+
+typedef struct {
+    const char* name;
+    ColumnType type;
+    size_t offset;          /* In the record */
+    size_t size;            /* Text buffer size, COL_TEXT only */
+    int flags;              /* COLUMN_* */
+} TransferColumn;
+
+typedef struct {
+    const char* name;
+    const TransferColumn* columns;
+    int column_count;
+    void* records;
+    int* count;
+    size_t record_size;
+    int max;
+    int min_id;             /* Lowest ID the table hands out */
+    AuditEntity entity;     /* Of the audit event recorded per batch */
+    /* Checks and normalises a parsed row; returns why it is rejected, or NULL */
+    const char* (*check)(void* record);
+    /* Appends a checked row and keeps the counters in step */
+    void (*append)(const void* record);
+    /* Saves the table after a batch of rows was appended */
+    int (*save)(void);
+} TransferTable;
+
+typedef struct {
+    long rows;          /* Data rows read, comments and blank lines excluded */
+    long accepted;
+    long rejected;
+    long batches;       /* Saves made */
+} TransferStats;
+
+/**
+ * Finds a table by name.
+ * @param name "patients", "doctors", "receptionists", "users" or "appointments".
+ * @return The table, or NULL if there is none by that name.
+ */
+ const TransferTable* transfer_table(const char* name);
+
+/**
+ * Formats one field of a record as text. Tabs and line breaks become spaces.
+ * @param column The column.
+ * @param record The record.
+ * @param out Buffer to receive the text.
+ * @param size Size of the buffer.
+ */
+ void transfer_format_field(const TransferColumn* column, const void* record, char* out, size_t size);
+
+/**
+ * Parses text into one field of a record.
+ * @param column The column.
+ * @param record The record.
+ * @param text The text.
+ * @return true if the text is a valid value for the column.
+ */
+ bool transfer_parse_field(const TransferColumn* column, void* record, const char* text);
+
+/**
+ * Picks a format from a file name: .jsonl and .json are JSON lines,
+ * anything else CSV.
+ * @param path The file name.
+ * @return The format.
+ */
+ TransferFormat transfer_format_of(const char* path);
+
+/**
+ * Writes every record of a table, and for appointments the sealed history too.
+ * @param table The table.
+ * @param format The output format.
+ * @param out The output stream.
+ * @return Number of records written, or -1 on a write error.
+ */
+ long transfer_export(const TransferTable* table, TransferFormat format, FILE* out);
+
+/**
+ * Imports rows into a table, saving every TRANSFER_BATCH accepted rows
+ * and once more at the end.
+ * @param table The table.
+ * @param format The input format.
+ * @param in The input stream.
+ * @param rejects Stream for rejected rows.
+ * @param stats Receives the row counts.
+ * @return 0 on success (rows may still be rejected), -1 on a read or save error.
+ */
+ int transfer_import(const TransferTable* table, TransferFormat format, FILE* in, FILE* rejects,
+                     TransferStats* stats);
+
+#endif
@@ -9,6 +9,7 @@
 #ifndef UI_H
 #define UI_H
 
+#include <stddef.h>
 #include "hospital.h"
 
 /* 
@@ -86,6 +87,39 @@
 #define HIDE_CURSOR    "\033[?25l"
 #define SHOW_CURSOR    "\033[?25h"
 
+/* Table view */
+#ifndef UI_TABLE_PAGE_ROWS
+#define UI_TABLE_PAGE_ROWS    15      /* Rows under one copy of the headings */
+#endif
+#define UI_TABLE_MAX_COLUMNS  8
+#define UI_TABLE_CELL_SIZE    96      /* Longer values are cut */
+
+/* Bytes composed before a frame is written out early */
+#ifndef UI_FRAME_SIZE
+#define UI_FRAME_SIZE  (64 * 1024)
+#endif
+
+typedef struct {
+    const char *heading;
+    int max_width;          /* Longer values are cut with "...", 0 for no limit */
+} UiColumn;
+
+typedef enum {
+    UI_SINK_TERMINAL,       /* stdout, through the terminal backend (default) */
+    UI_SINK_BUFFER,         /* Kept in memory, see ui_sink_buffer() */
+    UI_SINK_NULL            /* Dropped, only counted */
+} UiSinkKind;
+
+typedef struct {
+    size_t writes;          /* Frames handed to the sink */
+    size_t bytes;
+} UiSinkStats;
+
+typedef enum {
+    UI_LIST_TABLE,          /* One row per record (default) */
+    UI_LIST_CARDS           /* One box per record, HMS_VIEW=cards */
+} UiListMode;
+
 /* 
  *=======================================================================
  *                         FUNCTION PROTOTYPES                                
@@ -93,6 +127,36 @@
  */
 
  
+/**
+ * Picks where the ui_* functions send their output. Outside the terminal
+ * sink clearing the screen writes nothing. Pauses still read a line from
+ * the input source (see utils_set_input()), so a test that renders
+ * without a user gives them an input that has ended.
+ *
+ * @param kind The sink.
+ */
+ void ui_sink_select(UiSinkKind kind);
+
+/**
+ * Gets what the buffer sink has collected since the last ui_sink_reset().
+ *
+ * @param length Set to the number of bytes, if not NULL.
+ * @return The text, NUL-terminated; owned by the ui layer.
+ */
+ const char* ui_sink_buffer(size_t *length);
+
+/**
+ * Empties the buffer sink and zeroes the counters.
+ */
+ void ui_sink_reset(void);
+
+/**
+ * Gets the frames and bytes written to the sinks since the last reset.
+ *
+ * @return The counters.
+ */
+ UiSinkStats ui_sink_stats(void);
+
 /**
  * Clears the console screen.
  */
@@ -145,7 +209,20 @@
  void ui_print_banner(void);
  
 /**
- * Prints a menu in a box.
+ * Starts a frame: menus and cards printed until the matching
+ * ui_frame_end() are composed in one buffer and written together.
+ * Nothing else may be printed to stdout inside a frame.
+ */
+ void ui_frame_begin(void);
+
+/**
+ * Ends a frame started with ui_frame_begin() and writes it out.
+ */
+ void ui_frame_end(void);
+
+/**
+ * Prints a menu in a box, composed in the frame buffer and written with a
+ * single write() unless a frame is already open.
  *
  * @param title The title of the menu.
  * @param items The array of menu items.
@@ -177,6 +254,84 @@
  */
  void ui_print_receptionist(Receptionist receptionist, int index);
 
+/**
+ * Starts a table. Rows are printed a page (UI_TABLE_PAGE_ROWS) at a
+ * time, each page under the title and headings, with the column widths
+ * fitted to that page and the box. The user presses enter between pages.
+ *
+ * @param title The title of the table.
+ * @param columns The columns; the array must outlive the table.
+ * @param column_count The number of columns (at most UI_TABLE_MAX_COLUMNS).
+ */
+ void ui_table_begin(const char *title, const UiColumn columns[], int column_count);
+
+/**
+ * Adds a row to the table.
+ *
+ * @param cells One text per column.
+ */
+ void ui_table_row(const char *const cells[]);
+
+/**
+ * Prints the last page of the table.
+ *
+ * @return The number of rows printed.
+ */
+ int ui_table_end(void);
+
+/**
+ * Gets how listings show their records, from HMS_VIEW on first use.
+ *
+ * @return UI_LIST_CARDS if HMS_VIEW is "cards", UI_LIST_TABLE otherwise.
+ */
+ UiListMode ui_list_mode(void);
+
+/**
+ * Starts a listing. In table mode the records become rows of one table
+ * with this title; in card mode the cards are written as one frame.
+ *
+ * @param title The title of the listing.
+ */
+ void ui_list_begin(const char *title);
+
+/**
+ * Adds a table row to the listing, starting its table on the first row.
+ *
+ * @param columns The columns of the listing.
+ * @param column_count The number of columns.
+ * @param cells One text per column.
+ */
+ void ui_list_row(const UiColumn columns[], int column_count, const char *const cells[]);
+
+/**
+ * Ends a listing started with ui_list_begin().
+ */
+ void ui_list_end(void);
+
+/**
+ * Lists a patient as a table row or a card, by ui_list_mode().
+ *
+ * @param patient The patient.
+ * @param index The display index (cards only).
+ */
+ void ui_list_patient(Patient patient, int index);
+
+/**
+ * Lists a doctor as a table row or a card, by ui_list_mode().
+ *
+ * @param doctor The doctor.
+ * @param index The display index (cards only).
+ */
+ void ui_list_doctor(Doctor doctor, int index);
+
+/**
+ * Lists a receptionist as a table row or a card, by ui_list_mode().
+ *
+ * @param receptionist The receptionist.
+ * @param index The display index (cards only).
+ */
+ void ui_list_receptionist(Receptionist receptionist, int index);
+
 /**
  * Prints a dummy loading animation.
  */
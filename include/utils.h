@@ -13,12 +13,102 @@
 #include "hospital.h"
 
 /**
- * Clears the input buffer to prevent leftover characters.
+ *==========================================================
+ *                      Input Source
+ *==========================================================
+ */
+
+/* Longest line the utils_get_* functions keep; the rest is dropped */
+#define UTILS_LINE_SIZE 1024
+
+/* Bytes of stdin read at a time */
+#ifndef UTILS_INPUT_BLOCK
+#define UTILS_INPUT_BLOCK (64 * 1024)
+#endif
+
+typedef enum {
+    PARSE_OK,
+    PARSE_EMPTY,            /* Nothing but spaces */
+    PARSE_INVALID,          /* Does not start with a number */
+    PARSE_RANGE,            /* Does not fit the type */
+    PARSE_TRAILING          /* Text after the number */
+} ParseStatus;
+
+/*
+ * Where the utils_get_* functions read from. read_line stores the next
+ * line without its line ending, cut to fit size, and returns its length,
+ * or -1 once the input has ended.
+ */
+typedef struct {
+    int (*read_line)(void *context, char *buffer, size_t size);
+    void *context;
+} InputSource;
+
+/**
+ * Makes the utils_get_* functions (and the ui pauses) read from source.
+ *
+ * @param source The source, which must outlive its use; NULL for stdin.
+ */
+ void utils_set_input(const InputSource *source);
+
+/**
+ * Reads a line from stdin; the read_line of the default source, for
+ * sources that wrap it.
+ */
+ int utils_stdin_read_line(void *context, char *buffer, size_t size);
+
+/**
+ * Reads the next line from the input source, after flushing stdout.
+ *
+ * @param buffer The buffer to store the line.
+ * @param size The size of the buffer.
+ *
+ * @return The length of the line, or -1 at the end of the input.
+ */
+ int utils_read_line(char *buffer, size_t size);
+
+/**
+ * Parses a whole line as a decimal integer. Spaces and tabs around the
+ * number are allowed, anything else after it is not.
+ *
+ * @param text The line.
+ * @param value Set to the number on PARSE_OK, untouched otherwise.
+ *
+ * @return PARSE_OK, or why the line is not an int.
+ */
+ ParseStatus utils_parse_int(const char *text, int *value);
+
+/**
+ * Parses a whole line as a decimal number with an optional fraction and
+ * exponent ("-12", "3.5", "1e-3"). The result may differ from strtod()
+ * in the last bit.
+ *
+ * @param text The line.
+ * @param value Set to the number on PARSE_OK, untouched otherwise.
+ *
+ * @return PARSE_OK, or why the line is not a number.
+ */
+ ParseStatus utils_parse_double(const char *text, double *value);
+
+/**
+ * Describes a parse status for an error message.
+ *
+ * @param status The status.
+ *
+ * @return A short sentence without a full stop, such as "Number out of range".
+ */
+ const char *utils_parse_message(ParseStatus status);
+
+/**
+ * Drops the rest of the current input line.
  */
  void utils_clear_input_buffer(void);
 
 /**
- * Scans an integer value from the user with validation.
+ * Scans an integer value from the user with validation. Like the other
+ * utils_get_* functions it reads whole lines, skips blank ones, says why
+ * a line was refused and ends the program (through its exit handlers)
+ * when the input ends.
  *
  * @return The valid integer entered by the user.
  */
@@ -144,4 +234,65 @@
  */
  bool utils_is_valid_address(const char *address);
 
+/**
+ *==========================================================
+ *                      Date Functions                      
+ *==========================================================
+ */
+
+/**
+ * Converts a "DD-MM-YYYY" date string to a sortable YYYYMMDD key.
+ * Example: "05-12-2025" -> 20251205
+ *
+ * @param date The date string to convert.
+ *
+ * @return The date key, or 0 if the date is not in the expected format
+ *         or the day does not exist (e.g. "31-04-2025", "29-02-2025").
+ */
+ int utils_date_key(const char *date);
+
+/**
+ * Gets today's date key (YYYYMMDD) from the local clock.
+ *
+ * @return Today's date key.
+ */
+ int utils_today_key(void);
+
+/**
+ * Writes today's date as "DD-MM-YYYY".
+ *
+ * @param buffer The buffer to store the date.
+ * @param size The size of the buffer (at least DATE_SIZE).
+ *
+ * @return Pointer to buffer.
+ */
+ char* utils_get_today(char *buffer, size_t size);
+
+/**
+ * Converts a time slot to minutes after midnight.
+ * Accepts 12-hour ("10:00 AM", "2:30pm") and 24-hour ("14:30") forms.
+ *
+ * @param time_slot The time string to convert.
+ *
+ * @return Minutes after midnight, or -1 if the time is not valid.
+ */
+ int utils_time_minutes(const char *time_slot);
+
+/**
+ * Converts a local date and time to minutes since the Unix epoch.
+ *
+ * @param date_key The YYYYMMDD date key.
+ * @param minute_of_day Minutes after midnight.
+ *
+ * @return Minutes since the epoch, or -1 if the date is not valid.
+ */
+ int utils_epoch_minutes(int date_key, int minute_of_day);
+
+/**
+ * Gets the current time in minutes since the Unix epoch.
+ *
+ * @return Minutes since the epoch.
+ */
+ int utils_now_minutes(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,102 @@
+/**
+ * @file validate.h
+ * @brief Batch field validators for Healthcare Management System
+ *
+ * This header declares batch versions of the utils_is_valid_* checks for
+ * bulk work such as imports. Each takes an array of fixed-width fields
+ * (NAME_SIZE, PHONE_SIZE, EMAIL_SIZE, ADDRESS_SIZE or BLOOD_SIZE bytes,
+ * `stride` bytes apart, so a field can be checked in place in an array of
+ * records) and gives the same answer as the single-string check, except
+ * that a field with no NUL within its width is invalid rather than read
+ * past its end.
+ *
+ * On x86-64 the character classes are checked 16 (SSE2) or 32 (AVX2)
+ * bytes at a time; elsewhere, and with VALIDATE_SCALAR, each field goes
+ * through the utils_is_valid_* function it mirrors.
+ */
+
+#ifndef VALIDATE_H
+#define VALIDATE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "hospital.h"
+
+typedef enum {
+    VALIDATE_SCALAR,
+    VALIDATE_SSE2,
+    VALIDATE_AVX2
+} ValidateKernel;
+
+/**
+ * Selects the kernel. The best one the CPU supports is used until then.
+ * @param kernel The kernel wanted.
+ * @return The kernel now in use: the one wanted, or the best supported below it.
+ */
+ ValidateKernel validate_select(ValidateKernel kernel);
+
+/**
+ * Gets the kernel in use.
+ * @return The kernel.
+ */
+ ValidateKernel validate_kernel(void);
+
+/**
+ * Gets the name of a kernel.
+ * @param kernel The kernel.
+ * @return "scalar", "sse2" or "avx2".
+ */
+ const char* validate_name(ValidateKernel kernel);
+
+/**
+ * Checks names as utils_is_valid_name does.
+ * @param fields The first field, NAME_SIZE bytes.
+ * @param stride Bytes from one field to the next (at least NAME_SIZE).
+ * @param count Number of fields.
+ * @param valid Receives one result per field.
+ * @return The number of valid fields.
+ */
+ size_t validate_names(const char* fields, size_t stride, size_t count, bool* valid);
+
+/**
+ * Checks phone numbers as utils_is_valid_phone does.
+ * @param fields The first field, PHONE_SIZE bytes.
+ * @param stride Bytes from one field to the next (at least PHONE_SIZE).
+ * @param count Number of fields.
+ * @param valid Receives one result per field.
+ * @return The number of valid fields.
+ */
+ size_t validate_phones(const char* fields, size_t stride, size_t count, bool* valid);
+
+/**
+ * Checks email addresses as utils_is_valid_email does.
+ * @param fields The first field, EMAIL_SIZE bytes.
+ * @param stride Bytes from one field to the next (at least EMAIL_SIZE).
+ * @param count Number of fields.
+ * @param valid Receives one result per field.
+ * @return The number of valid fields.
+ */
+ size_t validate_emails(const char* fields, size_t stride, size_t count, bool* valid);
+
+/**
+ * Checks addresses as utils_is_valid_address does.
+ * @param fields The first field, ADDRESS_SIZE bytes.
+ * @param stride Bytes from one field to the next (at least ADDRESS_SIZE).
+ * @param count Number of fields.
+ * @param valid Receives one result per field.
+ * @return The number of valid fields.
+ */
+ size_t validate_addresses(const char* fields, size_t stride, size_t count, bool* valid);
+
+/**
+ * Checks blood groups as utils_is_valid_blood_group does. The fields are
+ * too short for vectors to pay off, so every kernel checks them in turn.
+ * @param fields The first field, BLOOD_SIZE bytes.
+ * @param stride Bytes from one field to the next (at least BLOOD_SIZE).
+ * @param count Number of fields.
+ * @param valid Receives one result per field.
+ * @return The number of valid fields.
+ */
+ size_t validate_blood_groups(const char* fields, size_t stride, size_t count, bool* valid);
+
+#endif
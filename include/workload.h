@@ -0,0 +1,53 @@
+/**
+ * @file workload.h
+ * @brief Doctor workload tracking for Healthcare Management System
+ *
+ * This header declares the doctor load heaps used to recommend the least
+ * busy doctors when a receptionist books a new appointment, one heap per
+ * day asked for, ordered by each doctor's load on that day.
+ */
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "hospital.h"
+
+#define APPT_SLOT_MINUTES       30      /* Length of one appointment */
+#define DOCTOR_DAY_MINUTES      480     /* Bookable minutes per doctor per day */
+#define MAX_RECOMMENDATIONS     5
+#define WORKLOAD_DAYS           8       /* Days whose heaps are kept */
+
+/**
+ * Drops every day's heap, to be built again from the appointment counters
+ * when next asked for, and re-indexes the doctors by ID.
+ */
+ void workload_rebuild(void);
+
+/**
+ * Re-reads one doctor's load on a day from the appointment counters and
+ * restores the order of that day's heap, if kept, in O(log n). Adds the
+ * doctor if not tracked yet.
+ * @param doctor_id The doctor's ID.
+ * @param day The YYYYMMDD day key, or APPT_STATS_ANY_DAY for every kept day.
+ */
+ void workload_update(int doctor_id, int day);
+
+/**
+ * Gets a doctor's booked minutes on a day.
+ * @param doctor_id The doctor's ID.
+ * @param day The YYYYMMDD day key.
+ * @return Booked minutes for that day.
+ */
+ int workload_booked_minutes(int doctor_id, int day);
+
+/**
+ * Ranks active, available doctors by load, least busy first.
+ * @param specialization Required specialization, or "*" for any.
+ * @param day The YYYYMMDD day key of the appointment.
+ * @param out_ids Buffer to receive doctor IDs.
+ * @param max Capacity of the buffer.
+ * @return Number of doctors written.
+ */
+ int workload_recommend(const char* specialization, int day, int* out_ids, int max);
+
+#endif
@@ -11,42 +11,30 @@
 #include "include/admin.h"
 #include "include/doctor_portal.h"
 #include "include/auth.h"
+#include "include/audit.h"
+#include "include/storage.h"
+#include "include/storage_io.h"
+#include "include/server.h"
+#include "include/replica.h"
+#include "include/cli.h"
+#include "include/terminal.h"
+#include "include/replay.h"
+#include "include/metrics.h"
 
-int main(int argc, char* argv[]) {
-    if (argc > 1) {
-        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
-            print_help(argv[0]);
-            return 0;
-        }
-        else if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0) {
-            print_version();
-            return 0;
-        }
-    }
-    
-    // Initialize the system
-    // ui_dummy_loading(30);
-    hospital_init();
-    ensure_data_dir();
-    
-    if (argc > 1) {
-        if (strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "--about") == 0) {
-            show_about();
-            ui_clear_screen();
-            return 0;
-        } 
-        else if (strcmp(argv[1], "-l") == 0 || strcmp(argv[1], "--login") == 0) {
-            login_menu();
-            ui_clear_screen();
-            return 0;
-        }
-        else {
-            ui_print_error("Invalid option!\n");
-            print_help(argv[0]);
-            return 1;
-        }
+/* Puts the session's saves on disk, also when the input ends inside a menu */
+static void session_end(void) {
+    static bool ended = false;
+    if (ended) return;
+    ended = true;
+
+    storage_flush();
+    audit_flush();
+    if (replica_close() != 0) {
+        ui_print_error("Some saves did not reach the replica journal.");
     }
-    
+}
+
+static void main_menu(void) {
     int choice;
     
     do {
@@ -71,6 +59,7 @@ int main(int argc, char* argv[]) {
                 show_about();
             break;
             case 3:
+                session_end();
                 ui_print_success("Goodbye!");
                 ui_pause();
                 ui_clear_screen();
@@ -80,6 +69,125 @@ int main(int argc, char* argv[]) {
                 ui_pause();
         }
     } while (choice != 3);
+}
+
+int main(int argc, char* argv[]) {
+    // --stats comes before the other options and only turns the counters on
+    bool stats = argc > 1 && strcmp(argv[1], "--stats") == 0;
+    if (stats) {
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+    if (stats || getenv("HMS_STATS") != NULL) {
+        metrics_start(stats);
+    }
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+            print_help(argv[0]);
+            return 0;
+        }
+        else if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--version") == 0) {
+            print_version();
+            return 0;
+        }
+    }
+    
+    bool serve = argc > 1 && (strcmp(argv[1], "-s") == 0 || strcmp(argv[1], "--serve") == 0);
+    bool standby = argc > 2 && strcmp(argv[1], "--standby") == 0;
+    bool command = argc > 1 && cli_is_command(argv[1]);
+
+    if (argc > 2 && strcmp(argv[1], "--verify") == 0) {
+        return replica_verify(argv[2]);
+    }
+    if (standby && replica_standby_enter(argv[2]) != 0) {
+        return 1;
+    }
+    
+    // Initialize the system, from the server if one is running
+    // ui_dummy_loading(30);
+    if (!serve && !standby) {
+        storage_connect(SERVER_SOCKET);
+    }
+    ensure_data_dir();
+    // Before anything is written: the journal base, the seal at startup and the writer thread
+    if (getenv("HMS_IO") != NULL && storage_io_select_name(getenv("HMS_IO")) != 0) {
+        ui_print_error("Unknown HMS_IO backend, using stdio.");
+    }
+    audit_start();
+    // Saves reach the data files only without a server, so only then are they shipped
+    if (!standby && !storage_is_remote() && getenv("HMS_REPLICA") != NULL &&
+        replica_open(getenv("HMS_REPLICA")) != 0) {
+        ui_print_error("Could not open the HMS_REPLICA journal, saves are not shipped.");
+    }
+    hospital_init();
+    // A command saves once and exits, so it writes directly
+    if (!serve && !standby && !command) {
+        storage_start_writer();
+    }
+
+    if (argc > 1) {
+        if (strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "--about") == 0) {
+            terminal_open();
+            show_about();
+            ui_clear_screen();
+            return 0;
+        } 
+        else if (strcmp(argv[1], "-l") == 0 || strcmp(argv[1], "--login") == 0) {
+            atexit(session_end);
+            terminal_open();
+            login_menu();
+            session_end();
+            ui_clear_screen();
+            return 0;
+        }
+        else if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+            if (replay_open(argv[2]) != 0) {
+                fprintf(stderr, "hms: cannot read the script %s\n", argv[2]);
+                return 1;
+            }
+            atexit(session_end);
+            main_menu();
+            replay_finish();
+            return 0;
+        }
+        else if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+            if (replay_record(argv[2]) != 0) {
+                fprintf(stderr, "hms: cannot create the script %s\n", argv[2]);
+                return 1;
+            }
+            atexit(session_end);
+            terminal_open();
+            main_menu();
+            return 0;
+        }
+        else if (serve) {
+            int status = server_run(SERVER_SOCKET);
+            if (replica_close() != 0) {
+                ui_print_error("Some saves did not reach the replica journal.");
+            }
+            return status;
+        }
+        else if (standby) {
+            return replica_standby_run();
+        }
+        else if (command) {
+            int status = cli_run(argc - 1, argv + 1);
+            if (audit_flush() != 0 || replica_close() != 0) {
+                fprintf(stderr, "hms: the audit trail or the replica journal could not be written\n");
+            }
+            return status;
+        }
+        else {
+            ui_print_error("Invalid option!\n");
+            print_help(argv[0]);
+            return 1;
+        }
+    }
     
+    atexit(session_end);
+    terminal_open();
+    main_menu();
     return 0;
 }
@@ -11,10 +11,15 @@
 #include "../include/admin.h"
 #include "../include/patient.h"
 #include "../include/doctor.h"
+#include "../include/appointment_stats.h"
 #include "../include/receptionist.h"
 #include "../include/auth.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
+#include "../include/shard.h"
 #include "../include/hospital.h"
 
 /*
@@ -23,6 +28,17 @@
  *==========================================================================
  */
 
+static int found[MAX_PATIENTS];     /* Scan results, indices in ID order */
+
+static bool patient_is_discharged(const Patient* patient, const void* arg) {
+    (void)arg;
+    return !patient->is_active;
+}
+
+static bool patient_is_discharged_named(const Patient* patient, const void* name) {
+    return !patient->is_active && strcmp(patient->name, name) == 0;
+}
+
 void admin_view_discharged_patients(void) {
     int count = 0;
     ui_clear_screen();
@@ -35,11 +51,12 @@ void admin_view_discharged_patients(void) {
         return;
     }
 
-    for (int i = 0; i < patient_count; i++) {
-        if (!patients[i].is_active) {
-            ui_print_patient(patients[i], count++);
-        }
+    int matches = shard_scan_patients(patient_is_discharged, NULL, found, MAX_PATIENTS);
+    ui_list_begin("Discharged Patients");
+    for (int i = 0; i < matches; i++) {
+        ui_list_patient(patients[found[i]], count++);
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -47,6 +64,7 @@ void admin_search_discharged_by_id(void) {
     int id;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -66,14 +84,13 @@ void admin_search_discharged_by_id(void) {
             continue;
         }
 
-        for (int i = 0; i < patient_count; i++) {
-            if (patients[i].id == id && !patients[i].is_active) {
-                ui_clear_screen();
-                ui_print_banner();
-                ui_print_patient(patients[i], i);
-                ui_pause();
-                return;
-            }
+        int i = patient_search_id(id);
+        if (i != -1 && !patients[i].is_active) {
+            ui_clear_screen();
+            ui_print_banner();
+            ui_print_patient(patients[i], i);
+            ui_pause();
+            return;
         }
         ui_print_error("Discharged patient not found with that ID!");
         ui_pause();
@@ -85,6 +102,7 @@ void admin_search_discharged_by_name(void) {
     char name[NAME_SIZE];
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -103,14 +121,15 @@ void admin_search_discharged_by_name(void) {
         }
 
         utils_fix_name(name);
-        for (int i = 0; i < patient_count; i++) {
-            if (strcmp(patients[i].name, name) == 0 && !patients[i].is_active) {
-                ui_clear_screen();
-                ui_print_banner();
-                ui_print_patient(patients[i], i);
-                ui_pause();
-                return;
-            }
+        MetricsTimer timer = metrics_begin();
+        bool match = shard_scan_patients(patient_is_discharged_named, name, found, 1) == 1;
+        metrics_end(METRIC_SEARCH_PATIENT_NAME, timer, match);
+        if (match) {
+            ui_clear_screen();
+            ui_print_banner();
+            ui_print_patient(patients[found[0]], found[0]);
+            ui_pause();
+            return;
         }
         ui_print_error("Discharged patient not found with that name!");
         ui_pause();
@@ -122,6 +141,7 @@ void admin_search_discharged(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -177,12 +197,9 @@ void admin_delete_patient(void) {
     }
 
     // Find the patient
-    int index = -1;
-    for (int i = 0; i < patient_count; i++) {
-        if (patients[i].id == id && !patients[i].is_active) {
-            index = i;
-            break;
-        }
+    int index = shard_find_patient(id);
+    if (index != -1 && patients[index].is_active) {
+        index = -1;
     }
 
     if (index == -1) {
@@ -205,13 +222,7 @@ void admin_delete_patient(void) {
     int input = utils_get_int();
 
     if (input == 1) {
-        // Shift all patients after this index
-        for (int i = index; i < patient_count - 1; i++) {
-            patients[i] = patients[i + 1];
-        }
-        patient_count--;
-        patient_unavailable--;
-        
+        patient_remove(index);
         ui_print_success("Patient permanently deleted from the system!");
         patient_save_to_file();
         ui_pause();
@@ -225,6 +236,7 @@ void admin_patient_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -301,11 +313,13 @@ void admin_view_discharged_doctors(void) {
         return;
     }
 
+    ui_list_begin("Inactive Doctors");
     for (int i = 0; i < doctor_count; i++) {
         if (!doctors[i].is_active) {
-            ui_print_doctor(doctors[i], count++);
+            ui_list_doctor(doctors[i], count++);
         }
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -363,6 +377,8 @@ void admin_delete_doctor(void) {
     int input = utils_get_int();
 
     if (input == 1) {
+        audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_DELETE, "name", doctors[index].name, NULL);
+
         // Shift all doctors after this index
         for (int i = index; i < doctor_count - 1; i++) {
             doctors[i] = doctors[i + 1];
@@ -383,6 +399,7 @@ void admin_doctor_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -436,6 +453,7 @@ void admin_receptionist_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -476,16 +494,103 @@ void admin_receptionist_menu(void) {
     } while (choice != 4);
 }
 
+/*
+ *==========================================================================
+ *                         APPOINTMENT STATISTICS
+ *==========================================================================
+ */
+
+void admin_view_appointment_stats(void) {
+    ui_clear_screen();
+    ui_print_banner();
+    appointment_stats_print(APPT_STATS_ALL, "Hospital Appointment Statistics");
+
+    int today = utils_today_key();
+    char doctor_lines[MAX_DOCTORS][90];
+    const char* items[MAX_DOCTORS + 1];
+    int count = 0;
+
+    for (int i = 0; i < doctor_count; i++) {
+        if (!doctors[i].is_active) continue;
+        snprintf(doctor_lines[count], sizeof(doctor_lines[count]),
+                 "Dr. %s: %d pending, %d completed today",
+                 doctors[i].name,
+                 appointment_stats_count(doctors[i].id, APPT_STATS_ANY_DAY, APPT_PENDING),
+                 appointment_stats_count(doctors[i].id, today, APPT_COMPLETED));
+        items[count] = doctor_lines[count];
+        count++;
+    }
+
+    if (count > 0) {
+        items[count] = "";
+        ui_print_menu("Per Doctor", items, count + 1, UI_SIZE);
+    }
+    ui_pause();
+}
+
 /*
  *==========================================================================
  *                             MAIN ADMIN MENU
  *==========================================================================
  */
 
+/*
+ *==========================================================================
+ *                         OPERATION STATISTICS
+ *==========================================================================
+ */
+
+/* Latency in the shortest unit that keeps it readable */
+static void format_latency(uint64_t ns, char* out, size_t size) {
+    if (ns < 1000) snprintf(out, size, "%llu ns", (unsigned long long)ns);
+    else if (ns < 1000000) snprintf(out, size, "%.1f us", ns / 1e3);
+    else if (ns < 1000000000) snprintf(out, size, "%.1f ms", ns / 1e6);
+    else snprintf(out, size, "%.1f s", ns / 1e9);
+}
+
+void admin_view_operation_stats(void) {
+    ui_clear_screen();
+    ui_print_banner();
+
+    if (!metrics_enabled()) {
+        ui_print_info("Operation statistics are off. Start the program with --stats or set HMS_STATS.");
+        ui_pause();
+        return;
+    }
+
+    char lines[METRIC_COUNT + 1][128];
+    const char* items[METRIC_COUNT + 2];
+    int count = 0;
+
+    snprintf(lines[count], sizeof(lines[count]), "%-22s %6s %6s %8s %8s %8s",
+             "Operation", "Calls", "Failed", "Average", "p99", "Max");
+    items[count] = lines[count];
+    count++;
+    for (int op = 0; op < METRIC_COUNT; op++) {
+        MetricsSummary s;
+        metrics_summary((MetricOp)op, &s);
+        if (s.calls == 0) continue;
+
+        char average[16], p99[16], max[16];
+        format_latency(s.total_ns / s.calls, average, sizeof(average));
+        format_latency(metrics_percentile(&s, 99), p99, sizeof(p99));
+        format_latency(s.max_ns, max, sizeof(max));
+        snprintf(lines[count], sizeof(lines[count]), "%-22s %6llu %6llu %8s %8s %8s",
+                 metrics_name((MetricOp)op), (unsigned long long)s.calls, (unsigned long long)s.failures,
+                 average, p99, max);
+        items[count] = lines[count];
+        count++;
+    }
+    items[count] = "";
+    ui_print_menu("Operation Statistics", items, count + 1, UI_SIZE);
+    ui_pause();
+}
+
 void admin_main_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -494,11 +599,13 @@ void admin_main_menu(void) {
             "Patient Management",
             "Doctor Management",
             "Receptionist Management",
+            "Appointment Statistics",
+            "Operation Statistics",
             "Logout",
             ">> "
         };
         
-        ui_print_menu("Admin Portal", menu_items, 6, UI_SIZE);
+        ui_print_menu("Admin Portal", menu_items, 8, UI_SIZE);
         choice = utils_get_int();
         
         switch (choice) {
@@ -515,6 +622,12 @@ void admin_main_menu(void) {
                 admin_receptionist_menu();
                 break;
             case 5:
+                admin_view_appointment_stats();
+                break;
+            case 6:
+                admin_view_operation_stats();
+                break;
+            case 7:
                 ui_print_info("Logging out...");
                 ui_pause();
                 break;
@@ -522,5 +635,5 @@ void admin_main_menu(void) {
                 ui_print_error("Invalid choice!");
                 ui_pause();
         }
-    } while (choice != 5);
+    } while (choice != 7);
 }
@@ -8,51 +8,56 @@
 #include <stdio.h>
 #include <string.h>
 #include "../include/appointment.h"
+#include "../include/appointment_stats.h"
+#include "../include/appointment_archive.h"
+#include "../include/doctor_portal.h"
+#include "../include/workload.h"
+#include "../include/reminder.h"
 #include "../include/patient.h"
 #include "../include/doctor.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
 #include "../include/hospital.h"
 
 int appointment_save_to_file(void) {
-    FILE* file = fopen(APPOINTMENTS_FILE, "wb");
-    if (file == NULL) {
+    MetricsTimer timer = metrics_begin();
+    int result = storage_save(TABLE_APPOINTMENTS);
+    metrics_end(METRIC_SAVE_APPOINTMENTS, timer, result == 0);
+    if (result != 0) {
         return -1;
     }
-    if (fwrite(&appointment_count, sizeof(int), 1, file) != 1 ||
-        fwrite(appointments, sizeof(Appointment), appointment_count, file) != (size_t)appointment_count) {
-        fclose(file);
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    // The server keeps the counter file of its own tables
+    return storage_is_remote() ? 0 : appointment_stats_save_to_file();
 }
 
+/* Highest ID in the table or the sealed history, kept as records come in */
+static int max_id = 0;
+
 int appointment_load_from_file(void) {
-    FILE* file = fopen(APPOINTMENTS_FILE, "rb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fread(&appointment_count, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (appointment_count < 0 || appointment_count > MAX_APPOINTMENTS) {
-        fclose(file);
-        appointment_count = 0;
-        return -1;
-    }
-    if (fread(appointments, sizeof(Appointment), appointment_count, file) != (size_t)appointment_count) {
-        fclose(file);
-        appointment_count = 0;
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_load(TABLE_APPOINTMENTS);
+    metrics_end(METRIC_LOAD_APPOINTMENTS, timer, result == 0);
+    appointment_rescan_ids();
+    return result;
 }
 
 int appointment_generate_id(void) {
-    return APPOINTMENT_ID_START + appointment_count;
+    // Sealed history keeps its IDs, so continue after the highest one in use
+    return max_id < APPOINTMENT_ID_START ? APPOINTMENT_ID_START : max_id + 1;
+}
+
+void appointment_note_id(int id) {
+    if (id > max_id) max_id = id;
+}
+
+void appointment_rescan_ids(void) {
+    max_id = appointment_archive_max_id();
+    for (int i = 0; i < appointment_count; i++) {
+        appointment_note_id(appointments[i].id);
+    }
 }
 
 const char* appointment_status_str(AppointmentStatus status) {
@@ -65,13 +70,47 @@ const char* appointment_status_str(AppointmentStatus status) {
     }
 }
 
+void appointment_set_status(int index, AppointmentStatus status) {
+    AppointmentStatus old_status = appointments[index].status;
+    audit_record(AUDIT_APPOINTMENT, appointments[index].id, AUDIT_UPDATE, "status",
+                 appointment_status_str(old_status), appointment_status_str(status));
+    appointments[index].status = status;
+    appointment_stats_move(&appointments[index], old_status);
+    doctor_portal_schedule_on_change(&appointments[index]);
+    workload_update(appointments[index].doctor_id, utils_date_key(appointments[index].date));
+    reminder_schedule(&appointments[index]);
+}
+
+int appointment_insert(Appointment* appt) {
+    if (appointment_count >= MAX_APPOINTMENTS) return -1;
+
+    appt->id = appointment_generate_id();
+    appt->status = APPT_PENDING;
+    appointments[appointment_count] = *appt;
+    appointment_count++;
+    appointment_note_id(appt->id);
+    char booking[AUDIT_VALUE_SIZE];
+    snprintf(booking, sizeof(booking), "patient %d, doctor %d, %s %s",
+             appt->patient_id, appt->doctor_id, appt->date, appt->time_slot);
+    audit_record(AUDIT_APPOINTMENT, appt->id, AUDIT_CREATE, "booking", NULL, booking);
+    appointment_stats_add(appt);
+    doctor_portal_schedule_on_change(appt);
+    workload_update(appt->doctor_id, utils_date_key(appt->date));
+    reminder_schedule(appt);
+    return appointment_count - 1;
+}
+
 int appointment_search_id(int id) {
+    MetricsTimer timer = metrics_begin();
+    int index = -1;
     for (int i = 0; i < appointment_count; i++) {
         if (appointments[i].id == id) {
-            return i;
+            index = i;
+            break;
         }
     }
-    return -1;
+    metrics_end(METRIC_SEARCH_APPOINTMENT_ID, timer, index != -1);
+    return index;
 }
 
 void appointment_create(void) {
@@ -112,12 +151,55 @@ void appointment_create(void) {
         break;
     }
     
-    // Step 2: Get Doctor ID
+    // Step 2: Get Date
     while (1) {
         ui_clear_screen();
         ui_print_banner();
-        const char* step2[] = {patient_line, "Doctor ID:", ">> "};
+        const char* step2[] = {patient_line, "Date (DD-MM-YYYY):", ">> "};
         ui_print_menu("Create Appointment", step2, 3, UI_SIZE);
+        utils_get_string(new_appt.date, DATE_SIZE);
+        
+        if (utils_date_key(new_appt.date) != 0) {
+            snprintf(date_line, sizeof(date_line), "Date: %s", new_appt.date);
+            break;
+        }
+        ui_print_error("Invalid date! Use DD-MM-YYYY.");
+        ui_pause();
+    }
+    
+    // Step 3: Get Doctor ID, suggesting the least busy doctors
+    char spec[SPEC_SIZE];
+    ui_clear_screen();
+    ui_print_banner();
+    const char* spec_items[] = {patient_line, date_line, "Specialization (* for any):", ">> "};
+    ui_print_menu("Create Appointment", spec_items, 4, UI_SIZE);
+    utils_get_string(spec, SPEC_SIZE);
+    
+    int day = utils_date_key(new_appt.date);
+    int recommended[MAX_RECOMMENDATIONS];
+    int rec_count = workload_recommend(spec, day, recommended, MAX_RECOMMENDATIONS);
+    
+    char rec_lines[MAX_RECOMMENDATIONS][90];
+    const char* step3[MAX_RECOMMENDATIONS + 5];
+    int step3_count = 0;
+    step3[step3_count++] = patient_line;
+    step3[step3_count++] = date_line;
+    for (int r = 0; r < rec_count; r++) {
+        int idx = doctor_search_id(recommended[r]);
+        snprintf(rec_lines[r], sizeof(rec_lines[r]), "Suggested: Dr. %s (ID: %d) - %d min booked",
+                 doctors[idx].name, recommended[r], workload_booked_minutes(recommended[r], day));
+        step3[step3_count++] = rec_lines[r];
+    }
+    if (rec_count == 0) {
+        step3[step3_count++] = "No available doctor found for that specialization.";
+    }
+    step3[step3_count++] = "Doctor ID:";
+    step3[step3_count++] = ">> ";
+    
+    while (1) {
+        ui_clear_screen();
+        ui_print_banner();
+        ui_print_menu("Create Appointment", step3, step3_count, UI_SIZE);
         new_appt.doctor_id = utils_get_int();
         
         if (!utils_is_valid_id(new_appt.doctor_id, ROLE_DOCTOR)) {
@@ -141,22 +223,6 @@ void appointment_create(void) {
         break;
     }
     
-    // Step 3: Get Date
-    while (1) {
-        ui_clear_screen();
-        ui_print_banner();
-        const char* step3[] = {patient_line, doctor_line, "Date (DD-MM-YYYY):", ">> "};
-        ui_print_menu("Create Appointment", step3, 4, UI_SIZE);
-        utils_get_string(new_appt.date, DATE_SIZE);
-        
-        if (strlen(new_appt.date) > 0) {
-            snprintf(date_line, sizeof(date_line), "Date: %s", new_appt.date);
-            break;
-        }
-        ui_print_error("Date cannot be empty!");
-        ui_pause();
-    }
-    
     // Step 4: Get Time Slot
     while (1) {
         ui_clear_screen();
@@ -165,11 +231,11 @@ void appointment_create(void) {
         ui_print_menu("Create Appointment", step4, 5, UI_SIZE);
         utils_get_string(new_appt.time_slot, TIME_SIZE);
         
-        if (strlen(new_appt.time_slot) > 0) {
+        if (utils_time_minutes(new_appt.time_slot) != -1) {
             snprintf(time_line, sizeof(time_line), "Time: %s", new_appt.time_slot);
             break;
         }
-        ui_print_error("Time cannot be empty!");
+        ui_print_error("Invalid time! Use e.g. 10:00 AM.");
         ui_pause();
     }
     
@@ -206,9 +272,7 @@ void appointment_create(void) {
         return;
     }
     
-    // Add to array
-    appointments[appointment_count] = new_appt;
-    appointment_count++;
+    appointment_insert(&new_appt);
     
     ui_clear_screen();
     ui_print_banner();
@@ -269,17 +333,45 @@ void ui_print_appointment(Appointment appt, int index) {
     ui_print_menu(title, items, 8, 72);
 }
 
+static const UiColumn appointment_columns[] = {
+    { "ID", 0 }, { "Date", 0 }, { "Time", 0 }, { "Patient", 16 },
+    { "Doctor", 16 }, { "Status", 0 }, { "Reason", 0 }
+};
+
+void ui_list_appointment(Appointment appt, int index) {
+    if (ui_list_mode() == UI_LIST_CARDS) {
+        ui_print_appointment(appt, index);
+        return;
+    }
+    int p_idx = patient_search_id(appt.patient_id);
+    int d_idx = doctor_search_id(appt.doctor_id);
+
+    char id[12], patient[12], doctor[12];
+    snprintf(id, sizeof(id), "%d", appt.id);
+    snprintf(patient, sizeof(patient), "%d", appt.patient_id);
+    snprintf(doctor, sizeof(doctor), "%d", appt.doctor_id);
+    const char* cells[] = {
+        id, appt.date, appt.time_slot,
+        p_idx != -1 ? patients[p_idx].name : patient,
+        d_idx != -1 ? doctors[d_idx].name : doctor,
+        appointment_status_str(appt.status), appt.reason
+    };
+    ui_list_row(appointment_columns, 7, cells);
+}
+
 void appointment_view_by_doctor(int doctor_id) {
     int count = 0;
     ui_clear_screen();
     ui_print_banner();
     
+    ui_list_begin("My Appointments");
     for (int i = 0; i < appointment_count; i++) {
         if (appointments[i].doctor_id == doctor_id && 
             appointments[i].status != APPT_CANCELLED) {
-            ui_print_appointment(appointments[i], count++);
+            ui_list_appointment(appointments[i], count++);
         }
     }
+    ui_list_end();
     
     if (count == 0) {
         const char* menu_items[] = {"No appointments found!"};
@@ -296,7 +388,7 @@ void appointment_update_status(int appt_id, AppointmentStatus status) {
         return;
     }
     
-    appointments[idx].status = status;
+    appointment_set_status(idx, status);
     appointment_save_to_file();
     ui_print_success("Appointment status updated!");
     ui_pause();
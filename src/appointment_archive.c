@@ -0,0 +1,406 @@
+/**
+ * @file appointment_archive.c
+ * @brief Sealed monthly appointment history for Healthcare Management System
+ *
+ * A segment file is a count followed by the records, without the header
+ * and counters of appointments.dat, and is made read-only once written.
+ * Late completions for a month that already has a segment go into a new
+ * segment with the next sequence number, so a sealed file is never
+ * rewritten.
+ *
+ * The segment index is replaced whole through a temporary file and a
+ * rename, so a crash leaves the old index or the new one. Like the data
+ * files it starts with a magic number and a generation, and it is read
+ * under a shared flock and sealed into under an exclusive one. The lock is
+ * taken on a file of its own, since the rename swaps the index's inode.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <errno.h>
+    #include <sys/file.h>
+#endif
+
+#include "../include/appointment_archive.h"
+#include "../include/appointment.h"
+#include "../include/replica.h"
+#include "../include/metrics.h"
+#include "../include/utils.h"
+#include "../include/ui.h"
+#include "../include/hospital.h"
+
+typedef struct {
+    uint32_t magic;         /* APPT_ARCHIVE_MAGIC */
+    uint32_t generation;    /* Bumped by every save */
+} ArchiveHeader;
+
+static AppointmentSegment segments[MAX_APPT_SEGMENTS];
+static int segment_count = 0;
+static uint32_t index_generation = 0;   /* Of the index last read or written */
+
+/* Scratch buffers: one segment being read, one being sealed */
+static Appointment segment_buffer[MAX_APPOINTMENTS];
+static Appointment seal_buffer[MAX_APPOINTMENTS];
+static bool sealed[MAX_APPOINTMENTS];
+static bool pick[MAX_APPOINTMENTS];
+
+static void segment_path(const AppointmentSegment* seg, char* path, size_t size) {
+    snprintf(path, size, APPT_SEGMENT_FMT, seg->month, seg->seq);
+}
+
+static int segment_read(const AppointmentSegment* seg, Appointment* out, int max) {
+    char path[64];
+    segment_path(seg, path, sizeof(path));
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    int count;
+    if (fread(&count, sizeof(int), 1, file) != 1 || count < 0 || count > max ||
+        fread(out, sizeof(Appointment), count, file) != (size_t)count) {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    return count;
+}
+
+static int segment_write(const AppointmentSegment* seg, const Appointment* records) {
+    char path[64];
+    segment_path(seg, path, sizeof(path));
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    if (fwrite(&seg->count, sizeof(int), 1, file) != 1 ||
+        fwrite(records, sizeof(Appointment), seg->count, file) != (size_t)seg->count) {
+        fclose(file);
+        remove(path);
+        return -1;
+    }
+    fclose(file);
+
+    // Sealed: nothing writes to this file again
+    #ifdef _WIN32
+        _chmod(path, _S_IREAD);
+    #else
+        chmod(path, 0444);
+    #endif
+    replica_file(path);
+    return 0;
+}
+
+/* Opens and locks the index's lock file; NULL if it cannot be opened. */
+static FILE* index_lock(bool exclusive) {
+    FILE* file = fopen(APPT_ARCHIVE_LOCK, "ab");
+    #ifndef _WIN32
+        while (file != NULL && flock(fileno(file), exclusive ? LOCK_EX : LOCK_SH) == -1 && errno == EINTR) {
+        }
+    #else
+        (void)exclusive;
+    #endif
+    return file;
+}
+
+static void index_unlock(FILE* lock) {
+    if (lock == NULL) return;
+    #ifndef _WIN32
+        flock(fileno(lock), LOCK_UN);
+    #endif
+    fclose(lock);
+}
+
+/* Replaces the index whole; the caller holds the exclusive lock. */
+static int index_save(void) {
+    FILE* file = fopen(APPT_ARCHIVE_FILE ".tmp", "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    ArchiveHeader header = { APPT_ARCHIVE_MAGIC, index_generation + 1 };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(&segment_count, sizeof(int), 1, file) == 1 &&
+              fwrite(segments, sizeof(AppointmentSegment), segment_count, file) == (size_t)segment_count;
+    if (fclose(file) != 0) ok = false;
+    if (!ok || rename(APPT_ARCHIVE_FILE ".tmp", APPT_ARCHIVE_FILE) != 0) {
+        remove(APPT_ARCHIVE_FILE ".tmp");
+        return -1;
+    }
+    index_generation = header.generation;
+    replica_file(APPT_ARCHIVE_FILE);
+    return 0;
+}
+
+/* Reads the index; the one in memory is kept if it cannot be read. */
+static int index_load(void) {
+    static AppointmentSegment loaded[MAX_APPT_SEGMENTS];
+    FILE* file = fopen(APPT_ARCHIVE_FILE, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    // An index from before the header starts with its count
+    ArchiveHeader header = { APPT_ARCHIVE_MAGIC, 0 };
+    int count;
+    bool ok = fread(&header.magic, sizeof(header.magic), 1, file) == 1;
+    if (ok && header.magic == APPT_ARCHIVE_MAGIC) {
+        ok = fread(&header.generation, sizeof(header.generation), 1, file) == 1 &&
+             fread(&count, sizeof(int), 1, file) == 1;
+    } else {
+        memcpy(&count, &header.magic, sizeof(int));
+        header.generation = 0;
+    }
+    ok = ok && count >= 0 && count <= MAX_APPT_SEGMENTS &&
+         fread(loaded, sizeof(AppointmentSegment), count, file) == (size_t)count;
+    fclose(file);
+    if (!ok) {
+        return -1;
+    }
+    memcpy(segments, loaded, (size_t)count * sizeof(AppointmentSegment));
+    segment_count = count;
+    index_generation = header.generation;
+    appointment_note_id(appointment_archive_max_id());
+    return 0;
+}
+
+int appointment_archive_save_to_file(void) {
+    MetricsTimer timer = metrics_begin();
+    FILE* lock = index_lock(true);
+    int result = index_save();
+    index_unlock(lock);
+    metrics_end(METRIC_SAVE_ARCHIVE, timer, result == 0);
+    return result;
+}
+
+int appointment_archive_load_from_file(void) {
+    MetricsTimer timer = metrics_begin();
+    FILE* lock = index_lock(false);
+    int result = index_load();
+    index_unlock(lock);
+    metrics_end(METRIC_LOAD_ARCHIVE, timer, result == 0);
+    return result;
+}
+
+void appointment_archive_replicate(void) {
+    appointment_archive_load_from_file();
+    for (int i = 0; i < segment_count; i++) {
+        char path[64];
+        segment_path(&segments[i], path, sizeof(path));
+        replica_file(path);
+    }
+    replica_file(APPT_ARCHIVE_FILE);
+}
+
+static int compare_id(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Reads the IDs already sealed for a month, sorted, so an interrupted run's
+ * appointments can be told apart without reading the segments again.
+ * Returns the number of IDs, or -1 if out of memory; *ids is freed by the caller.
+ */
+static int archived_ids(int month, int** ids) {
+    size_t total = 0;
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].month == month) total += (size_t)segments[s].count;
+    }
+    *ids = malloc((total > 0 ? total : 1) * sizeof(int));
+    if (*ids == NULL) return -1;
+
+    int found = 0;
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].month != month) continue;
+        int count = segment_read(&segments[s], segment_buffer, MAX_APPOINTMENTS);
+        for (int i = 0; i < count && (size_t)found < total; i++) {
+            (*ids)[found++] = segment_buffer[i].id;
+        }
+    }
+    qsort(*ids, (size_t)found, sizeof(int), compare_id);
+    return found;
+}
+
+static bool is_cold(const Appointment* appt, int current_month) {
+    if (appt->status != APPT_COMPLETED && appt->status != APPT_CANCELLED) return false;
+    int day = utils_date_key(appt->date);
+    return day != 0 && day / 100 < current_month;
+}
+
+static int seal_months(int current_month) {
+    int sealed_total = 0;
+    memset(sealed, 0, sizeof(sealed));
+
+    for (int i = 0; i < appointment_count; i++) {
+        if (sealed[i] || !is_cold(&appointments[i], current_month)) continue;
+
+        int month = utils_date_key(appointments[i].date) / 100;
+        if (segment_count >= MAX_APPT_SEGMENTS) break;
+
+        // Gather every cold appointment from the same month
+        AppointmentSegment seg = {month, 0, 0, 0, 0};
+        for (int s = 0; s < segment_count; s++) {
+            if (segments[s].month == month && segments[s].seq >= seg.seq) {
+                seg.seq = segments[s].seq + 1;
+            }
+        }
+
+        int* ids;
+        int archived = archived_ids(month, &ids);
+        if (archived < 0) return -1;
+
+        memset(pick, 0, sizeof(pick));
+        for (int j = i; j < appointment_count; j++) {
+            if (sealed[j] || !is_cold(&appointments[j], current_month) ||
+                utils_date_key(appointments[j].date) / 100 != month) {
+                continue;
+            }
+            pick[j] = true;
+            if (bsearch(&appointments[j].id, ids, (size_t)archived, sizeof(int), compare_id) != NULL) {
+                continue;   /* Already sealed by an interrupted run */
+            }
+
+            seal_buffer[seg.count++] = appointments[j];
+            if (seg.min_id == 0 || appointments[j].id < seg.min_id) seg.min_id = appointments[j].id;
+            if (appointments[j].id > seg.max_id) seg.max_id = appointments[j].id;
+        }
+        free(ids);
+
+        if (seg.count > 0) {
+            if (segment_write(&seg, seal_buffer) != 0) return -1;
+            segments[segment_count++] = seg;
+            MetricsTimer timer = metrics_begin();
+            int saved = index_save();
+            metrics_end(METRIC_SAVE_ARCHIVE, timer, saved == 0);
+            if (saved != 0) {
+                segment_count--;
+                return -1;
+            }
+        }
+
+        for (int j = i; j < appointment_count; j++) {
+            if (pick[j]) {
+                sealed[j] = true;
+                sealed_total++;
+            }
+        }
+    }
+
+    // Compact the resident table
+    int kept = 0;
+    for (int i = 0; i < appointment_count; i++) {
+        if (!sealed[i]) {
+            appointments[kept++] = appointments[i];
+        }
+    }
+    appointment_count = kept;
+
+    return sealed_total;
+}
+
+int appointment_archive_seal(int current_month) {
+    // Another process may have sealed since the index was read
+    FILE* lock = index_lock(true);
+    index_load();
+    int result = seal_months(current_month);
+    index_unlock(lock);
+    return result;
+}
+
+int appointment_archive_total(void) {
+    int total = 0;
+    for (int s = 0; s < segment_count; s++) {
+        total += segments[s].count;
+    }
+    return total;
+}
+
+int appointment_archive_max_id(void) {
+    int max_id = 0;
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].max_id > max_id) max_id = segments[s].max_id;
+    }
+    return max_id;
+}
+
+int appointment_archive_load_month(int month, Appointment* out, int max) {
+    int loaded = 0;
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].month != month) continue;
+
+        int count = segment_read(&segments[s], segment_buffer, MAX_APPOINTMENTS);
+        for (int i = 0; i < count && loaded < max; i++) {
+            out[loaded++] = segment_buffer[i];
+        }
+    }
+    return loaded;
+}
+
+int appointment_archive_for_each(void (*fn)(const Appointment* appt)) {
+    for (int s = 0; s < segment_count; s++) {
+        int count = segment_read(&segments[s], segment_buffer, MAX_APPOINTMENTS);
+        if (count < 0) return -1;
+        for (int i = 0; i < count; i++) {
+            fn(&segment_buffer[i]);
+        }
+    }
+    return 0;
+}
+
+void appointment_view_history(int doctor_id) {
+    char month_input[DATE_SIZE];
+    int month, year, consumed = 0;
+
+    while (1) {
+        ui_clear_screen();
+        ui_print_banner();
+        const char* menu_items[] = {"Month (MM-YYYY):", ">> "};
+        ui_print_menu("Appointment History", menu_items, 2, UI_SIZE);
+        utils_get_string(month_input, DATE_SIZE);
+
+        if (sscanf(month_input, "%2d-%4d%n", &month, &year, &consumed) == 2 &&
+            month_input[consumed] == '\0' && month >= 1 && month <= 12) {
+            break;
+        }
+        ui_print_error("Invalid month! Use MM-YYYY.");
+        ui_pause();
+    }
+
+    int month_key = year * 100 + month;
+    int count = 0;
+    ui_clear_screen();
+    ui_print_banner();
+
+    // Sealed segments first, then anything from that month still resident
+    ui_list_begin("Appointment History");
+    for (int s = 0; s < segment_count; s++) {
+        if (segments[s].month != month_key) continue;
+
+        int loaded = segment_read(&segments[s], segment_buffer, MAX_APPOINTMENTS);
+        for (int i = 0; i < loaded; i++) {
+            if (doctor_id == 0 || segment_buffer[i].doctor_id == doctor_id) {
+                ui_list_appointment(segment_buffer[i], count++);
+            }
+        }
+    }
+    for (int i = 0; i < appointment_count; i++) {
+        if (utils_date_key(appointments[i].date) / 100 == month_key &&
+            (doctor_id == 0 || appointments[i].doctor_id == doctor_id)) {
+            ui_list_appointment(appointments[i], count++);
+        }
+    }
+    ui_list_end();
+
+    if (count == 0) {
+        const char* menu_items[] = {"No appointments found for that month!"};
+        ui_print_menu("Appointment History", menu_items, 1, UI_SIZE);
+    }
+    ui_pause();
+}
@@ -0,0 +1,297 @@
+/**
+ * @file appointment_stats.c
+ * @brief Appointment counters implementation for Healthcare Management System
+ *
+ * Counters live in an open-addressing hash table keyed by (doctor, day).
+ * Every appointment is counted four times: for its doctor and for the whole
+ * hospital, each on its own day and across all days. That keeps every
+ * update at four O(1) slot lookups. The table doubles and rehashes once it
+ * is three quarters full; if it cannot grow, the lost update is reported
+ * and the counters are rebuilt from the appointments on the next load.
+ * A saved file is only trusted if its per-doctor and per-day counters add
+ * up to the hospital-wide ones.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/appointment_stats.h"
+#include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/metrics.h"
+#include "../include/utils.h"
+#include "../include/ui.h"
+#include "../include/hospital.h"
+
+static AppointmentStats* stats_table = NULL;
+static unsigned int stats_slots = 0;    /* Power of two */
+static int stats_used = 0;
+static int stats_lost = 0;              /* Updates dropped because the table could not grow */
+
+static unsigned int stats_hash(int doctor_id, int day) {
+    unsigned int h = (unsigned int)doctor_id * 2654435761u;
+    h ^= (unsigned int)day * 40503u;
+    h ^= h >> 15;
+    return h;
+}
+
+/* Moves every entry to a table of the given size. */
+static int stats_resize(unsigned int slots) {
+    AppointmentStats* table = calloc(slots, sizeof(AppointmentStats));
+    if (table == NULL) return -1;
+
+    for (unsigned int i = 0; i < stats_slots; i++) {
+        if (!stats_table[i].in_use) continue;
+        unsigned int slot = stats_hash(stats_table[i].doctor_id, stats_table[i].day) & (slots - 1);
+        while (table[slot].in_use) slot = (slot + 1) & (slots - 1);
+        table[slot] = stats_table[i];
+    }
+    free(stats_table);
+    stats_table = table;
+    stats_slots = slots;
+    return 0;
+}
+
+/* Makes room for `entries` keys without passing 3/4 full. */
+static int stats_reserve(int entries) {
+    unsigned int slots = stats_slots != 0 ? stats_slots : APPT_STATS_SLOTS;
+    while ((size_t)entries * 4 > (size_t)slots * 3) slots *= 2;
+    return slots == stats_slots ? 0 : stats_resize(slots);
+}
+
+/* Finds the slot for a key; creates it when create is true. */
+static AppointmentStats* stats_find(int doctor_id, int day, bool create) {
+    if (stats_slots == 0 && (!create || stats_reserve(1) != 0)) return NULL;
+
+    unsigned int slot = stats_hash(doctor_id, day) & (stats_slots - 1);
+    while (stats_table[slot].in_use) {
+        AppointmentStats* entry = &stats_table[slot];
+        if (entry->doctor_id == doctor_id && entry->day == day) {
+            return entry;
+        }
+        slot = (slot + 1) & (stats_slots - 1);
+    }
+    if (!create) return NULL;
+
+    if ((size_t)(stats_used + 1) * 4 > (size_t)stats_slots * 3) {
+        if (stats_reserve(stats_used + 1) != 0) return NULL;
+        return stats_find(doctor_id, day, true);
+    }
+    AppointmentStats* entry = &stats_table[slot];
+    entry->in_use = true;
+    entry->doctor_id = doctor_id;
+    entry->day = day;
+    memset(entry->counts, 0, sizeof(entry->counts));
+    stats_used++;
+    return entry;
+}
+
+static void stats_bump(int doctor_id, int day, AppointmentStatus status, int delta) {
+    if (status < 0 || status >= APPT_STATUS_COUNT) return;
+
+    AppointmentStats* entry = stats_find(doctor_id, day, true);
+    if (entry != NULL) {
+        entry->counts[status] += delta;
+    } else if (stats_lost++ == 0) {
+        ui_print_error("Out of memory: appointment counters are incomplete until the next restart.");
+    }
+}
+
+static void stats_apply(const Appointment* appt, AppointmentStatus status, int delta) {
+    int day = utils_date_key(appt->date);
+
+    stats_bump(appt->doctor_id, day, status, delta);
+    stats_bump(appt->doctor_id, APPT_STATS_ANY_DAY, status, delta);
+    stats_bump(APPT_STATS_ALL, day, status, delta);
+    stats_bump(APPT_STATS_ALL, APPT_STATS_ANY_DAY, status, delta);
+}
+
+void appointment_stats_reset(void) {
+    if (stats_table != NULL) memset(stats_table, 0, stats_slots * sizeof(AppointmentStats));
+    stats_used = 0;
+    stats_lost = 0;
+}
+
+void appointment_stats_rebuild(void) {
+    appointment_stats_reset();
+    for (int i = 0; i < appointment_count; i++) {
+        appointment_stats_add(&appointments[i]);
+    }
+    appointment_archive_for_each(appointment_stats_add);
+}
+
+void appointment_stats_add(const Appointment* appt) {
+    stats_apply(appt, appt->status, 1);
+}
+
+void appointment_stats_remove(const Appointment* appt) {
+    stats_apply(appt, appt->status, -1);
+}
+
+void appointment_stats_move(const Appointment* appt, AppointmentStatus old_status) {
+    if (old_status == appt->status) return;
+    stats_apply(appt, old_status, -1);
+    stats_apply(appt, appt->status, 1);
+}
+
+int appointment_stats_count(int doctor_id, int day, AppointmentStatus status) {
+    if (status < 0 || status >= APPT_STATUS_COUNT) return 0;
+
+    AppointmentStats* entry = stats_find(doctor_id, day, false);
+    return entry != NULL ? entry->counts[status] : 0;
+}
+
+int appointment_stats_count_month(int doctor_id, int year, int month, AppointmentStatus status) {
+    int total = 0;
+    for (int day = 1; day <= 31; day++) {
+        total += appointment_stats_count(doctor_id, year * 10000 + month * 100 + day, status);
+    }
+    return total;
+}
+
+/* Total number of appointments the counters should account for. */
+static int appointment_total(void) {
+    return appointment_count + appointment_archive_total();
+}
+
+/* Total number of appointments the counters currently account for. */
+static int stats_total(void) {
+    int total = 0;
+    for (int s = 0; s < APPT_STATUS_COUNT; s++) {
+        total += appointment_stats_count(APPT_STATS_ALL, APPT_STATS_ANY_DAY, s);
+    }
+    return total;
+}
+
+/* Whether the per-doctor and per-day counters add up to the hospital-wide ones, status by status. */
+static bool stats_consistent(void) {
+    long doctors_total[APPT_STATUS_COUNT] = { 0 }, days_total[APPT_STATUS_COUNT] = { 0 };
+    for (unsigned int i = 0; i < stats_slots; i++) {
+        const AppointmentStats* entry = &stats_table[i];
+        if (!entry->in_use) continue;
+        for (int s = 0; s < APPT_STATUS_COUNT; s++) {
+            if (entry->counts[s] < 0) return false;
+            if (entry->doctor_id != APPT_STATS_ALL && entry->day == APPT_STATS_ANY_DAY) {
+                doctors_total[s] += entry->counts[s];
+            }
+            if (entry->doctor_id == APPT_STATS_ALL && entry->day != APPT_STATS_ANY_DAY) {
+                days_total[s] += entry->counts[s];
+            }
+        }
+    }
+    for (int s = 0; s < APPT_STATUS_COUNT; s++) {
+        long all = appointment_stats_count(APPT_STATS_ALL, APPT_STATS_ANY_DAY, s);
+        if (doctors_total[s] != all || days_total[s] != all) return false;
+    }
+    return true;
+}
+
+static int file_save(void) {
+    // Counters missing updates would be trusted on the next load
+    if (stats_lost > 0) {
+        remove(APPT_STATS_FILE);
+        return -1;
+    }
+    FILE* file = fopen(APPT_STATS_FILE, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    int total = appointment_total();
+    if (fwrite(&total, sizeof(int), 1, file) != 1 ||
+        fwrite(&stats_used, sizeof(int), 1, file) != 1) {
+        fclose(file);
+        return -1;
+    }
+    for (unsigned int i = 0; i < stats_slots; i++) {
+        if (stats_table[i].in_use &&
+            fwrite(&stats_table[i], sizeof(AppointmentStats), 1, file) != 1) {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+static int file_load(void) {
+    appointment_stats_reset();
+
+    FILE* file = fopen(APPT_STATS_FILE, "rb");
+    if (file == NULL) {
+        appointment_stats_rebuild();
+        return 1;
+    }
+
+    int saved_count, saved_used;
+    bool ok = fread(&saved_count, sizeof(int), 1, file) == 1 &&
+              fread(&saved_used, sizeof(int), 1, file) == 1 &&
+              saved_count == appointment_total() &&
+              saved_used >= 0 && saved_used <= 4 * saved_count + 1 && stats_reserve(saved_used) == 0;
+
+    for (int i = 0; ok && i < saved_used; i++) {
+        AppointmentStats entry;
+        if (fread(&entry, sizeof(AppointmentStats), 1, file) != 1) {
+            ok = false;
+            break;
+        }
+        AppointmentStats* slot = stats_find(entry.doctor_id, entry.day, true);
+        if (slot == NULL) {
+            ok = false;
+            break;
+        }
+        memcpy(slot->counts, entry.counts, sizeof(slot->counts));
+    }
+    fclose(file);
+
+    // Stale or damaged file: the appointment table is the source of truth
+    if (!ok || stats_total() != appointment_total() || !stats_consistent()) {
+        appointment_stats_rebuild();
+        return 1;
+    }
+    return 0;
+}
+
+int appointment_stats_save_to_file(void) {
+    MetricsTimer timer = metrics_begin();
+    int result = file_save();
+    metrics_end(METRIC_SAVE_APPT_STATS, timer, result == 0);
+    return result;
+}
+
+int appointment_stats_load_from_file(void) {
+    MetricsTimer timer = metrics_begin();
+    int result = file_load();
+    metrics_end(METRIC_LOAD_APPT_STATS, timer, result == 0);
+    return result;
+}
+
+void appointment_stats_print(int doctor_id, const char* title) {
+    int today = utils_today_key();
+    int year = today / 10000;
+    int month = (today / 100) % 100;
+
+    char pending_line[70], confirmed_line[70], completed_line[70], cancelled_line[70];
+    char today_line[90], month_line[90];
+
+    snprintf(pending_line, sizeof(pending_line), "Pending: %d",
+             appointment_stats_count(doctor_id, APPT_STATS_ANY_DAY, APPT_PENDING));
+    snprintf(confirmed_line, sizeof(confirmed_line), "Confirmed: %d",
+             appointment_stats_count(doctor_id, APPT_STATS_ANY_DAY, APPT_CONFIRMED));
+    snprintf(completed_line, sizeof(completed_line), "Completed: %d",
+             appointment_stats_count(doctor_id, APPT_STATS_ANY_DAY, APPT_COMPLETED));
+    snprintf(cancelled_line, sizeof(cancelled_line), "Cancelled: %d",
+             appointment_stats_count(doctor_id, APPT_STATS_ANY_DAY, APPT_CANCELLED));
+    snprintf(today_line, sizeof(today_line), "Today: %d pending, %d completed, %d cancelled",
+             appointment_stats_count(doctor_id, today, APPT_PENDING),
+             appointment_stats_count(doctor_id, today, APPT_COMPLETED),
+             appointment_stats_count(doctor_id, today, APPT_CANCELLED));
+    snprintf(month_line, sizeof(month_line), "This month: %d completed, %d cancelled",
+             appointment_stats_count_month(doctor_id, year, month, APPT_COMPLETED),
+             appointment_stats_count_month(doctor_id, year, month, APPT_CANCELLED));
+
+    const char* items[] = {
+        pending_line, confirmed_line, completed_line, cancelled_line,
+        today_line, month_line, ""
+    };
+    ui_print_menu(title, items, 7, UI_SIZE);
+}
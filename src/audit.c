@@ -0,0 +1,331 @@
+/**
+ * @file audit.c
+ * @brief Audit trail implementation for Healthcare Management System
+ *
+ * The ring is a bounded multi-producer queue in which every slot carries
+ * a sequence number. A producer claims a position with one compare-and-swap
+ * on the head, fills the slot and publishes it by storing position + 1 in
+ * the slot's sequence; the single consumer (the writer thread) takes slots
+ * in order once their sequence says they are filled and hands them back by
+ * storing position + AUDIT_RING_SIZE. Producers never wake the writer: it
+ * polls every AUDIT_POLL_MS. A producer that finds the ring full sleeps a
+ * millisecond at a time for up to AUDIT_FULL_WAIT_MS and then appends its
+ * event to the file itself, so a burst costs latency but loses nothing.
+ * Timestamps come from time(), which Linux serves from the vDSO without
+ * entering the kernel.
+ *
+ * Several terminals may append to the same files; each append and rotation
+ * happens under an exclusive lock on the current file. Rotation also
+ * removes the oldest rotated files once they pass the retention limits.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "../include/audit.h"
+#include "../include/hospital.h"
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <errno.h>
+    #include <pthread.h>
+    #include <stdatomic.h>
+    #include <unistd.h>
+    #include <sys/file.h>
+#endif
+
+static int32_t process_id = 0;
+static int64_t keep_bytes = AUDIT_KEEP_MB * 1024LL * 1024LL;
+static int64_t keep_seconds = 0;            /* 0: no age limit */
+
+/*
+ *==========================================================================
+ *                              AUDIT FILES
+ *==========================================================================
+ */
+
+/* Reads the retention limits from the environment. */
+static void retention_read(void) {
+    const char* megabytes = getenv("HMS_AUDIT_MB");
+    const char* days = getenv("HMS_AUDIT_DAYS");
+    if (megabytes != NULL && atol(megabytes) > 0) keep_bytes = atol(megabytes) * 1024LL * 1024LL;
+    if (days != NULL && atol(days) > 0) keep_seconds = atol(days) * 86400LL;
+}
+
+/* Removes, from the oldest end, the rotated files past the size or age limit. */
+static void file_prune(int count) {
+    char name[64];
+    struct stat info;
+    int64_t kept = 0;
+    time_t now = time(NULL);
+    bool past = false;
+
+    for (int i = 1; i <= count; i++) {
+        snprintf(name, sizeof(name), AUDIT_ROTATED_FMT, i);
+        if (stat(name, &info) != 0) continue;
+        kept += (int64_t)info.st_size;
+        // The newest rotated file stays whatever the limits
+        if (i > 1 && (kept > keep_bytes || (keep_seconds > 0 && (int64_t)(now - info.st_mtime) > keep_seconds))) {
+            past = true;
+        }
+        if (past) remove(name);
+    }
+}
+
+/* Renames audit.bin to audit.1.bin, audit.1.bin to audit.2.bin and so on. */
+static void file_rotate(void) {
+    char from[64], to[64];
+    struct stat info;
+    int count = 0;
+    while (1) {
+        snprintf(from, sizeof(from), AUDIT_ROTATED_FMT, count + 1);
+        if (stat(from, &info) != 0) break;
+        count++;
+    }
+    for (int i = count; i >= 1; i--) {
+        snprintf(from, sizeof(from), AUDIT_ROTATED_FMT, i);
+        snprintf(to, sizeof(to), AUDIT_ROTATED_FMT, i + 1);
+        rename(from, to);
+    }
+    snprintf(to, sizeof(to), AUDIT_ROTATED_FMT, 1);
+    rename(AUDIT_FILE, to);
+    file_prune(count + 1);
+}
+
+/* Opens and locks the current audit file, rotating it if the events would not fit. */
+static FILE* file_open(size_t incoming) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        FILE* file = fopen(AUDIT_FILE, "ab");
+        if (file == NULL) return NULL;
+
+        #ifndef _WIN32
+            while (flock(fileno(file), LOCK_EX) == -1 && errno == EINTR) {
+            }
+            // Another terminal may have rotated it while we waited
+            struct stat opened, current;
+            if (fstat(fileno(file), &opened) != 0 || stat(AUDIT_FILE, &current) != 0 ||
+                opened.st_ino != current.st_ino) {
+                fclose(file);
+                continue;
+            }
+        #endif
+
+        if (fseek(file, 0L, SEEK_END) != 0) {
+            fclose(file);
+            return NULL;
+        }
+        long size = ftell(file);
+        if (size > 0 && size + (long)incoming > AUDIT_FILE_MAX) {
+            file_rotate();
+            fclose(file);       /* Releases the lock on the rotated file */
+            continue;
+        }
+        if (size == 0) {
+            AuditFileHeader header = { AUDIT_MAGIC, 1, sizeof(AuditEvent) };
+            if (fwrite(&header, sizeof(header), 1, file) != 1) {
+                fclose(file);
+                return NULL;
+            }
+        }
+        return file;
+    }
+    return NULL;
+}
+
+static int file_append(const AuditEvent* events, int count) {
+    FILE* file = file_open((size_t)count * sizeof(AuditEvent));
+    if (file == NULL) return -1;
+    bool ok = fwrite(events, sizeof(AuditEvent), (size_t)count, file) == (size_t)count;
+    if (fclose(file) != 0) ok = false;
+    return ok ? 0 : -1;
+}
+
+static void event_fill(AuditEvent* event, uint32_t sequence, AuditEntity entity, int entity_id,
+                       AuditAction action, const char* field, const char* old_value,
+                       const char* new_value) {
+    memset(event, 0, sizeof(*event));
+    event->timestamp = (int64_t)time(NULL);
+    event->sequence = sequence;
+    event->process = process_id;
+    event->entity_id = entity_id;
+    event->entity = (uint8_t)entity;
+    event->action = (uint8_t)action;
+    if (entity != AUDIT_SYSTEM && current_user != NULL) {
+        event->user_id = current_user->id;
+        event->role = (uint8_t)current_user->role;
+        snprintf(event->username, sizeof(event->username), "%s", current_user->username);
+    }
+    // Longer values are cut short; snprintf always leaves the terminator
+    if (field != NULL) snprintf(event->field, sizeof(event->field), "%s", field);
+    if (old_value != NULL) snprintf(event->old_value, sizeof(event->old_value), "%s", old_value);
+    if (new_value != NULL) snprintf(event->new_value, sizeof(event->new_value), "%s", new_value);
+}
+
+#ifdef _WIN32
+
+/*
+ * No writer thread on Windows: events are appended as they are recorded.
+ */
+
+static uint32_t next_sequence = 0;
+static bool write_failed = false;
+
+int audit_start(void) {
+    process_id = (int32_t)_getpid();
+    retention_read();
+    return -1;
+}
+
+void audit_record(AuditEntity entity, int entity_id, AuditAction action,
+                  const char* field, const char* old_value, const char* new_value) {
+    AuditEvent event;
+    event_fill(&event, next_sequence++, entity, entity_id, action, field, old_value, new_value);
+    if (file_append(&event, 1) != 0) write_failed = true;
+}
+
+int audit_flush(void) {
+    bool failed = write_failed;
+    write_failed = false;
+    return failed ? -1 : 0;
+}
+
+#else
+
+/* A slot's sequence is kept minus its index, so an all-zero ring is ready to use */
+typedef struct {
+    atomic_uint sequence;       /* position + 1 once filled */
+    AuditEvent event;
+} AuditSlot;
+
+static AuditSlot ring[AUDIT_RING_SIZE];
+static atomic_uint ring_head = 0;           /* Next position to claim */
+static unsigned int ring_tail = 0;          /* Next position to write, writer only */
+static atomic_uint written = 0;             /* Positions taken off the ring */
+static atomic_uint dropped = 0;             /* Events that could not be written, not yet reported */
+static atomic_bool write_failed = false;
+static bool writer_running = false;
+
+static void poll_wait(long ms) {
+    struct timespec pause = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&pause, NULL);
+}
+
+/* Moves every filled slot to the files; returns the number of events taken. */
+static int ring_drain(void) {
+    AuditEvent batch[AUDIT_BATCH];
+    int total = 0;
+
+    while (1) {
+        int count = 0;
+        while (count < AUDIT_BATCH - 1) {      /* Room for a lost-events note */
+            unsigned int index = ring_tail & (AUDIT_RING_SIZE - 1);
+            AuditSlot* slot = &ring[index];
+            if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != ring_tail + 1 - index) break;
+            batch[count++] = slot->event;
+            atomic_store_explicit(&slot->sequence, ring_tail + AUDIT_RING_SIZE - index, memory_order_release);
+            ring_tail++;
+        }
+        int taken = count;
+
+        // Lost events are reported in the stream itself, after the ones that got in
+        unsigned int lost = atomic_exchange(&dropped, 0);
+        if (lost > 0) {
+            char value[AUDIT_VALUE_SIZE];
+            snprintf(value, sizeof(value), "%u", lost);
+            event_fill(&batch[count++], 0, AUDIT_SYSTEM, 0, AUDIT_LOST, "events", NULL, value);
+        }
+        if (count == 0) break;
+
+        if (file_append(batch, count) != 0) {
+            atomic_store(&write_failed, true);
+        }
+        atomic_fetch_add_explicit(&written, (unsigned int)taken, memory_order_release);
+        total += taken;
+        if (taken < AUDIT_BATCH - 1) break;
+    }
+    return total;
+}
+
+static void* writer_thread(void* arg) {
+    (void)arg;
+    while (1) {
+        if (ring_drain() == 0) poll_wait(AUDIT_POLL_MS);
+    }
+    return NULL;
+}
+
+int audit_start(void) {
+    process_id = (int32_t)getpid();
+    retention_read();
+    if (writer_running) return -1;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, writer_thread, NULL) != 0) return -1;
+    pthread_detach(thread);
+    writer_running = true;
+    return 0;
+}
+
+/* Appends an event the ring had no room for; a failed append is reported like the writer's. */
+static void direct_append(unsigned int position, AuditEntity entity, int entity_id, AuditAction action,
+                          const char* field, const char* old_value, const char* new_value) {
+    AuditEvent event;
+    event_fill(&event, position, entity, entity_id, action, field, old_value, new_value);
+    if (file_append(&event, 1) != 0) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        atomic_store(&write_failed, true);
+    }
+}
+
+void audit_record(AuditEntity entity, int entity_id, AuditAction action,
+                  const char* field, const char* old_value, const char* new_value) {
+    unsigned int position = atomic_load_explicit(&ring_head, memory_order_relaxed);
+    unsigned int index;
+    AuditSlot* slot;
+    int waited = 0;
+
+    while (1) {
+        index = position & (AUDIT_RING_SIZE - 1);
+        slot = &ring[index];
+        unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire) + index;
+        int diff = (int)(sequence - position);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring_head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full: give the writer a moment, then write the event ourselves
+            if (!writer_running || waited == AUDIT_FULL_WAIT_MS) {
+                direct_append(position, entity, entity_id, action, field, old_value, new_value);
+                return;
+            }
+            poll_wait(1);
+            waited++;
+            position = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        } else {
+            position = atomic_load_explicit(&ring_head, memory_order_relaxed);
+        }
+    }
+
+    event_fill(&slot->event, position, entity, entity_id, action, field, old_value, new_value);
+    atomic_store_explicit(&slot->sequence, position + 1 - index, memory_order_release);
+}
+
+int audit_flush(void) {
+    unsigned int target = atomic_load_explicit(&ring_head, memory_order_acquire);
+    if (writer_running) {
+        while ((int)(atomic_load_explicit(&written, memory_order_acquire) - target) < 0) {
+            poll_wait(1);
+        }
+    } else {
+        ring_drain();
+    }
+    return atomic_exchange(&write_failed, false) ? -1 : 0;
+}
+
+#endif
@@ -8,50 +8,29 @@
 #include "../include/auth.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
 #include "../include/hospital.h"
 #include "../include/receptionist.h"
 #include "../include/admin.h"
 #include "../include/doctor_portal.h"
 #include "../include/doctor.h"
+#include "../include/workload.h"
+#include "../include/appointment_stats.h"
 
 int auth_save_to_file(void) {
-    FILE* file = fopen(USERS_FILE, "wb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fwrite(&user_count, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (fwrite(users, sizeof(User), user_count, file) != (size_t)user_count) {
-        fclose(file);
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_save(TABLE_USERS);
+    metrics_end(METRIC_SAVE_USERS, timer, result == 0);
+    return result;
 }
 
 int auth_load_from_file(void) {
-    FILE* file = fopen(USERS_FILE, "rb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fread(&user_count, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (user_count < 0 || user_count > MAX_USERS) {
-        fclose(file);
-        user_count = 0;
-        return -1;
-    }
-    if (fread(users, sizeof(User), user_count, file) != (size_t)user_count) {
-        fclose(file);
-        user_count = 0;
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_load(TABLE_USERS);
+    metrics_end(METRIC_LOAD_USERS, timer, result == 0);
+    return result;
 }
 
 void auth_init_default_admin(void) {
@@ -63,6 +42,7 @@ void auth_init_default_admin(void) {
         users[0].role = ROLE_ADMIN;
         users[0].is_active = true;
         user_count = 1;
+        audit_record(AUDIT_USER, users[0].id, AUDIT_CREATE, "username", NULL, users[0].username);
         auth_save_to_file();
     }
 }
@@ -294,7 +274,9 @@ void auth_register_user(void) {
         doctors[doctor_count] = new_doctor;
         doctor_count++;
         doctor_available++;
+        audit_record(AUDIT_DOCTOR, new_doctor.id, AUDIT_CREATE, "name", NULL, new_doctor.name);
         doctor_save_to_file();
+        workload_update(new_doctor.id, APPT_STATS_ANY_DAY);
         
     } else {
         // Confirm Admin/Receptionist registration
@@ -321,6 +303,7 @@ void auth_register_user(void) {
     encrypt(new_user.password);  // Encryption
     users[user_count] = new_user;
     user_count++;
+    audit_record(AUDIT_USER, new_user.id, AUDIT_CREATE, "username", NULL, new_user.username);
     auth_save_to_file();
     
     ui_print_success("User registered successfully!");
@@ -456,36 +439,49 @@ void auth_role_login(UserRole required_role) {
     };
     ui_print_menu(title, pass_items, 3, UI_SIZE);
     utils_get_string(password, PASSWORD_SIZE);
+    MetricsTimer timer = metrics_begin();
     encrypt(password);  // Encryption for comparison
     
     // Find user with matching role
+    int match = -1;
     for (int i = 0; i < user_count; i++) {
         if (strcmp(users[i].username, username) == 0 &&
             strcmp(users[i].password, password) == 0 &&
             users[i].is_active &&
             users[i].role == required_role) {
-            
-            current_user = &users[i];
-            
-            // Route to appropriate portal
-            switch (required_role) {
-                case ROLE_ADMIN:
-                    admin_main_menu();
-                    break;
-                case ROLE_RECEPTIONIST:
-                    receptionist_menu();
-                    break;
-                case ROLE_DOCTOR:
-                    doctor_portal_menu(users[i].id, username);
-                    break;
-                default:
-                    break;
-            }
-            
-            current_user = NULL;
-            return;
+            match = i;
+            break;
         }
     }
+    metrics_end(METRIC_AUTH_LOGIN, timer, match != -1);
+
+    if (match != -1) {
+        current_user = &users[match];
+        
+        // Route to appropriate portal
+        switch (required_role) {
+            case ROLE_ADMIN:
+                admin_main_menu();
+                break;
+            case ROLE_RECEPTIONIST:
+                receptionist_menu();
+                break;
+            case ROLE_DOCTOR:
+                doctor_portal_menu(users[match].id, username);
+                break;
+            default:
+                break;
+        }
+        
+        // Logging out: make sure this session's saves and audit events are on disk
+        storage_flush();
+        if (audit_flush() != 0) {
+            ui_print_error("Could not write the audit log.");
+            ui_pause();
+        }
+        current_user = NULL;
+        return;
+    }
     
     char error_msg[80];
     snprintf(error_msg, sizeof(error_msg), "Invalid credentials or not a %s!", role_name);
@@ -522,6 +518,7 @@ void login_menu(void) {
                 auth_role_login(ROLE_DOCTOR);
                 break;
             case 4:
+                storage_flush();
                 return;
             default:
                 ui_print_error("Invalid choice!");
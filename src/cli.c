@@ -0,0 +1,534 @@
+/**
+ * @file cli.c
+ * @brief Non-interactive commands implementation for Healthcare Management System
+ *
+ * Every table is described once as a list of columns (see transfer.h);
+ * printing a record, matching a query term and bulk import and export all
+ * go through that list, so each command is only argument checking and a
+ * call into the same core functions the menus use.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "../include/cli.h"
+#include "../include/transfer.h"
+#include "../include/patient.h"
+#include "../include/doctor.h"
+#include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/generate.h"
+#include "../include/utils.h"
+#include "../include/hospital.h"
+
+typedef struct {
+    int column;
+    const char* value;
+} Filter;
+
+/* Filters for the archive walk, which only takes a callback */
+static const TransferTable* history_table;
+static const Filter* history_filters;
+static int history_filter_count;
+
+/*
+ *==========================================================================
+ *                              OUTPUT
+ *==========================================================================
+ */
+
+static int fail(const char* message) {
+    fprintf(stderr, "hms: %s\n", message);
+    return CLI_EXIT_FAILED;
+}
+
+static int usage(const char* message) {
+    fprintf(stderr, "hms: %s (see --help)\n", message);
+    return CLI_EXIT_USAGE;
+}
+
+static void print_header(const TransferTable* table) {
+    const char* separator = "";
+    for (int c = 0; c < table->column_count; c++) {
+        if (table->columns[c].flags & COLUMN_SECRET) continue;
+        printf("%s%s", separator, table->columns[c].name);
+        separator = "\t";
+    }
+    putchar('\n');
+}
+
+static void print_record(const TransferTable* table, const void* record) {
+    char field[TRANSFER_FIELD_SIZE];
+    const char* separator = "";
+    for (int c = 0; c < table->column_count; c++) {
+        if (table->columns[c].flags & COLUMN_SECRET) continue;
+        transfer_format_field(&table->columns[c], record, field, sizeof(field));
+        printf("%s%s", separator, field);
+        separator = "\t";
+    }
+    putchar('\n');
+}
+
+/*
+ *==========================================================================
+ *                              FILTERS
+ *==========================================================================
+ */
+
+static bool equal_ignore_case(const char* a, const char* b) {
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return *a == '\0' && *b == '\0';
+}
+
+static int column_index(const TransferTable* table, const char* name, size_t length) {
+    for (int c = 0; c < table->column_count; c++) {
+        if (table->columns[c].flags & COLUMN_SECRET) continue;
+        if (strlen(table->columns[c].name) == length && strncmp(table->columns[c].name, name, length) == 0) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+/* Parses a FIELD=VALUE term; false if it is malformed or names no column. */
+static bool filter_parse(const TransferTable* table, const char* term, Filter* filter) {
+    const char* equals = strchr(term, '=');
+    if (equals == NULL) return false;
+    filter->column = column_index(table, term, (size_t)(equals - term));
+    filter->value = equals + 1;
+    return filter->column >= 0;
+}
+
+static bool filters_match(const TransferTable* table, const void* record, const Filter* filters, int count) {
+    char field[TRANSFER_FIELD_SIZE];
+    for (int f = 0; f < count; f++) {
+        transfer_format_field(&table->columns[filters[f].column], record, field, sizeof(field));
+        if (!equal_ignore_case(field, filters[f].value)) return false;
+    }
+    return true;
+}
+
+static int print_matches(const TransferTable* table, const Filter* filters, int count) {
+    const char* record = table->records;
+    int printed = 0;
+    for (int i = 0; i < *table->count; i++, record += table->record_size) {
+        if (filters_match(table, record, filters, count)) {
+            print_record(table, record);
+            printed++;
+        }
+    }
+    return printed;
+}
+
+static void print_history_match(const Appointment* appt) {
+    if (filters_match(history_table, appt, history_filters, history_filter_count)) {
+        print_record(history_table, appt);
+    }
+}
+
+/*
+ *==========================================================================
+ *                              ARGUMENTS
+ *==========================================================================
+ */
+
+/* Value given for --option, or NULL. */
+static const char* option_value(int argc, char* argv[], int first, const char* option) {
+    for (int i = first; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], option) == 0) return argv[i + 1];
+    }
+    return NULL;
+}
+
+/* Checks that arguments from first on are pairs of known options and values. */
+static bool options_valid(int argc, char* argv[], int first, const char* const* known, int known_count) {
+    for (int i = first; i < argc; i += 2) {
+        bool found = false;
+        for (int k = 0; k < known_count && !found; k++) {
+            found = strcmp(argv[i], known[k]) == 0;
+        }
+        if (!found || i + 1 >= argc) return false;
+    }
+    return true;
+}
+
+/* Parses a whole positive number; false for anything else. */
+static bool parse_id(const char* text, int* id) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || value <= 0 || value > 0x7FFFFFFFL) return false;
+    *id = (int)value;
+    return true;
+}
+
+/* Parses a whole number from 0 up; false for anything else. */
+static bool parse_count(const char* text, int* count) {
+    if (strcmp(text, "0") == 0) {
+        *count = 0;
+        return true;
+    }
+    return parse_id(text, count);
+}
+
+static bool copy_text(char* out, size_t size, const char* text) {
+    if (text == NULL || strlen(text) >= size) return false;
+    strcpy(out, text);
+    return true;
+}
+
+/*
+ *==========================================================================
+ *                              COMMANDS
+ *==========================================================================
+ */
+
+static int patient_command_add(int argc, char* argv[]) {
+    static const char* const known[] = { "--name", "--age", "--gender", "--phone", "--address", "--blood" };
+    if (!options_valid(argc, argv, 2, known, 6)) return usage("patient add: unknown or incomplete option");
+
+    Patient patient;
+    memset(&patient, 0, sizeof(patient));
+    const char* age = option_value(argc, argv, 2, "--age");
+    const char* gender = option_value(argc, argv, 2, "--gender");
+
+    if (!copy_text(patient.name, NAME_SIZE, option_value(argc, argv, 2, "--name")) ||
+        !utils_is_valid_name(patient.name)) {
+        return fail("invalid or missing --name");
+    }
+    if (age == NULL || !parse_id(age, &patient.age) || patient.age >= 120) {
+        return fail("invalid or missing --age (1-119)");
+    }
+    if (gender == NULL || (!equal_ignore_case(gender, "M") && !equal_ignore_case(gender, "F") &&
+                           !equal_ignore_case(gender, "Male") && !equal_ignore_case(gender, "Female"))) {
+        return fail("invalid or missing --gender (M/F)");
+    }
+    patient.gender = tolower((unsigned char)gender[0]) == 'm' ? MALE : FEMALE;
+    if (!copy_text(patient.phone, PHONE_SIZE, option_value(argc, argv, 2, "--phone")) ||
+        !utils_is_valid_phone(patient.phone)) {
+        return fail("invalid or missing --phone (11 digits)");
+    }
+    if (!copy_text(patient.address, ADDRESS_SIZE, option_value(argc, argv, 2, "--address")) ||
+        !utils_is_valid_address(patient.address)) {
+        return fail("invalid or missing --address");
+    }
+    if (!copy_text(patient.blood_group, BLOOD_SIZE, option_value(argc, argv, 2, "--blood")) ||
+        !utils_is_valid_blood_group(patient.blood_group)) {
+        return fail("invalid or missing --blood (e.g. A+, O-, or U)");
+    }
+    utils_fix_name(patient.name);
+    utils_str_to_upper(patient.blood_group);
+
+    int index = patient_insert(&patient);
+    if (index < 0) return fail("maximum patient limit reached");
+    if (patient_save_to_file() != 0) return fail("could not save the patient table");
+
+    print_header(transfer_table("patients"));
+    print_record(transfer_table("patients"), &patients[index]);
+    return CLI_EXIT_OK;
+}
+
+static int patient_command(int argc, char* argv[]) {
+    if (argc < 2) return usage("patient: missing subcommand");
+    if (strcmp(argv[1], "add") == 0) return patient_command_add(argc, argv);
+
+    int id;
+    if (argc != 3 || !parse_id(argv[2], &id)) return usage("patient: expected a subcommand and an ID");
+    int index = patient_search_id(id);
+    if (index < 0) return fail("patient not found");
+
+    if (strcmp(argv[1], "get") == 0) {
+        // Found by ID, so printed as is
+    } else if (strcmp(argv[1], "discharge") == 0) {
+        if (!patients[index].is_active) return fail("patient is already discharged");
+        patient_set_discharged(index);
+        if (patient_save_to_file() != 0) return fail("could not save the patient table");
+    } else {
+        return usage("patient: unknown subcommand");
+    }
+    print_header(transfer_table("patients"));
+    print_record(transfer_table("patients"), &patients[index]);
+    return CLI_EXIT_OK;
+}
+
+static int appt_command_add(int argc, char* argv[]) {
+    static const char* const known[] = { "--patient", "--doctor", "--date", "--time", "--reason" };
+    if (!options_valid(argc, argv, 2, known, 5)) return usage("appt add: unknown or incomplete option");
+
+    Appointment appt;
+    memset(&appt, 0, sizeof(appt));
+    const char* patient = option_value(argc, argv, 2, "--patient");
+    const char* doctor = option_value(argc, argv, 2, "--doctor");
+
+    if (patient == NULL || !parse_id(patient, &appt.patient_id) ||
+        !utils_is_valid_id(appt.patient_id, ROLE_PATIENT)) {
+        return fail("invalid or missing --patient");
+    }
+    int p_idx = patient_search_id(appt.patient_id);
+    if (p_idx == -1 || !patients[p_idx].is_active) return fail("patient not found or inactive");
+
+    if (!copy_text(appt.date, DATE_SIZE, option_value(argc, argv, 2, "--date")) ||
+        utils_date_key(appt.date) == 0) {
+        return fail("invalid or missing --date (DD-MM-YYYY)");
+    }
+    if (doctor == NULL || !parse_id(doctor, &appt.doctor_id) ||
+        !utils_is_valid_id(appt.doctor_id, ROLE_DOCTOR)) {
+        return fail("invalid or missing --doctor");
+    }
+    int d_idx = doctor_search_id(appt.doctor_id);
+    if (d_idx == -1 || !doctors[d_idx].is_active) return fail("doctor not found or inactive");
+    if (!doctors[d_idx].is_available) fprintf(stderr, "hms: warning: doctor is marked as unavailable\n");
+
+    if (!copy_text(appt.time_slot, TIME_SIZE, option_value(argc, argv, 2, "--time")) ||
+        utils_time_minutes(appt.time_slot) == -1) {
+        return fail("invalid or missing --time (e.g. 10:00 AM)");
+    }
+    if (!copy_text(appt.reason, REASON_SIZE, option_value(argc, argv, 2, "--reason")) ||
+        strlen(appt.reason) == 0) {
+        return fail("invalid or missing --reason");
+    }
+
+    int index = appointment_insert(&appt);
+    if (index < 0) return fail("maximum appointment limit reached");
+    if (appointment_save_to_file() != 0) return fail("could not save the appointment table");
+
+    print_header(transfer_table("appointments"));
+    print_record(transfer_table("appointments"), &appointments[index]);
+    return CLI_EXIT_OK;
+}
+
+static int appt_command_list(int argc, char* argv[]) {
+    static const char* const options[] = { "--doctor", "--patient", "--date", "--status" };
+    static const char* const columns[] = { "doctor_id", "patient_id", "date", "status" };
+    const TransferTable* table = transfer_table("appointments");
+    Filter filters[4];
+    int count = 0;
+    bool history = false;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--history") == 0) {
+            history = true;
+            continue;
+        }
+        int o = 0;
+        while (o < 4 && strcmp(argv[i], options[o]) != 0) o++;
+        if (o == 4 || i + 1 >= argc || count == 4) return usage("appt list: unknown or incomplete option");
+        filters[count].column = column_index(table, columns[o], strlen(columns[o]));
+        filters[count].value = argv[++i];
+        count++;
+    }
+
+    print_header(table);
+    if (history) {
+        history_table = table;
+        history_filters = filters;
+        history_filter_count = count;
+        appointment_archive_for_each(print_history_match);
+    }
+    print_matches(table, filters, count);
+    return CLI_EXIT_OK;
+}
+
+static AppointmentStatus status_named(const char* name, bool* found) {
+    for (int s = APPT_PENDING; s <= APPT_CANCELLED; s++) {
+        if (equal_ignore_case(name, appointment_status_str((AppointmentStatus)s))) {
+            *found = true;
+            return (AppointmentStatus)s;
+        }
+    }
+    *found = false;
+    return APPT_PENDING;
+}
+
+static int appt_command(int argc, char* argv[]) {
+    if (argc < 2) return usage("appt: missing subcommand");
+    if (strcmp(argv[1], "add") == 0) return appt_command_add(argc, argv);
+    if (strcmp(argv[1], "list") == 0) return appt_command_list(argc, argv);
+    if (strcmp(argv[1], "status") != 0) return usage("appt: unknown subcommand");
+
+    int id;
+    bool found;
+    if (argc != 4 || !parse_id(argv[2], &id)) return usage("appt status: expected an ID and a status");
+    AppointmentStatus status = status_named(argv[3], &found);
+    if (!found) return usage("appt status: status must be pending, confirmed, completed or cancelled");
+
+    int index = appointment_search_id(id);
+    if (index < 0) return fail("appointment not found (sealed history cannot be changed)");
+    if (appointments[index].status != status) {
+        appointment_set_status(index, status);
+        if (appointment_save_to_file() != 0) return fail("could not save the appointment table");
+    }
+    print_header(transfer_table("appointments"));
+    print_record(transfer_table("appointments"), &appointments[index]);
+    return CLI_EXIT_OK;
+}
+
+static int query_command(int argc, char* argv[]) {
+    if (argc < 2) return usage("query: missing table");
+    const TransferTable* table = transfer_table(argv[1]);
+    if (table == NULL) return usage("query: table must be patients, doctors, receptionists, users or appointments");
+    if (argc - 2 > CLI_MAX_FILTERS) return usage("query: too many terms");
+
+    Filter filters[CLI_MAX_FILTERS];
+    for (int i = 2; i < argc; i++) {
+        if (!filter_parse(table, argv[i], &filters[i - 2])) return usage("query: terms are FIELD=VALUE with a column name");
+    }
+    print_header(table);
+    print_matches(table, filters, argc - 2);
+    return CLI_EXIT_OK;
+}
+
+/* Format from --format, else from the file name; false for an unknown name. */
+static bool format_option(int argc, char* argv[], int first, const char* path, TransferFormat* format) {
+    const char* name = option_value(argc, argv, first, "--format");
+    if (name == NULL) {
+        *format = path != NULL ? transfer_format_of(path) : TRANSFER_CSV;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = TRANSFER_CSV;
+    } else if (strcmp(name, "jsonl") == 0) {
+        *format = TRANSFER_JSONL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static int export_command(int argc, char* argv[]) {
+    static const char* const known[] = { "--format", "--output" };
+    if (argc < 2) return usage("export: missing table");
+    const TransferTable* table = transfer_table(argv[1]);
+    if (table == NULL) return usage("export: table must be patients, doctors, receptionists, users or appointments");
+    if (!options_valid(argc, argv, 2, known, 2)) return usage("export: unknown or incomplete option");
+
+    const char* path = option_value(argc, argv, 2, "--output");
+    TransferFormat format;
+    if (!format_option(argc, argv, 2, path, &format)) return usage("export: format must be csv or jsonl");
+
+    FILE* out = path != NULL ? fopen(path, "w") : stdout;
+    if (out == NULL) return fail("could not open the output file");
+    long written = transfer_export(table, format, out);
+    if (out != stdout && fclose(out) != 0) written = -1;
+    if (written < 0) return fail("could not write the export");
+    return CLI_EXIT_OK;
+}
+
+static int import_command(int argc, char* argv[]) {
+    static const char* const known[] = { "--format", "--rejects" };
+    char rejects_path[FILENAME_MAX];
+    TransferStats stats;
+    TransferFormat format;
+
+    if (argc < 3) return usage("import: expected a table and a file");
+    const TransferTable* table = transfer_table(argv[1]);
+    if (table == NULL) return usage("import: table must be patients, doctors, receptionists, users or appointments");
+    if (!options_valid(argc, argv, 3, known, 2)) return usage("import: unknown or incomplete option");
+
+    bool from_stdin = strcmp(argv[2], "-") == 0;
+    if (!format_option(argc, argv, 3, from_stdin ? NULL : argv[2], &format)) {
+        return usage("import: format must be csv or jsonl");
+    }
+    const char* rejects_option = option_value(argc, argv, 3, "--rejects");
+    if (rejects_option != NULL) snprintf(rejects_path, sizeof(rejects_path), "%s", rejects_option);
+    else snprintf(rejects_path, sizeof(rejects_path), "%s.rejected", from_stdin ? "import" : argv[2]);
+
+    FILE* in = from_stdin ? stdin : fopen(argv[2], "rb");
+    if (in == NULL) return fail("could not open the input file");
+    FILE* rejects = fopen(rejects_path, "w");
+    if (rejects == NULL) {
+        if (in != stdin) fclose(in);
+        return fail("could not create the rejects file");
+    }
+
+    int result = transfer_import(table, format, in, rejects, &stats);
+    if (in != stdin) fclose(in);
+    if (fclose(rejects) != 0) result = -1;
+    if (stats.rejected == 0 && result == 0) remove(rejects_path);
+
+    printf("rows\taccepted\trejected\tbatches\trejects\n");
+    printf("%ld\t%ld\t%ld\t%ld\t%s\n", stats.rows, stats.accepted, stats.rejected, stats.batches,
+           stats.rejected > 0 ? rejects_path : "-");
+    if (result != 0) return fail("import stopped: could not read the input or save the table");
+    return CLI_EXIT_OK;
+}
+
+static int generate_command(int argc, char* argv[]) {
+    static const char* const known[] = { "--patients", "--doctors", "--receptionists", "--appointments",
+                                         "--seed", "--threads", "--date" };
+    static const char* const counts[] = { "--patients", "--doctors", "--receptionists", "--appointments",
+                                          "--threads" };
+    GenerateOptions options = { -1, -1, -1, -1, 1, 0, utils_today_key() };
+    int* targets[] = { &options.patients, &options.doctors, &options.receptionists, &options.appointments,
+                       &options.threads };
+    GenerateStats stats;
+
+    if (!options_valid(argc, argv, 1, known, 7)) return usage("generate: unknown or incomplete option");
+    for (int i = 0; i < 5; i++) {
+        const char* value = option_value(argc, argv, 1, counts[i]);
+        if (value != NULL && !parse_count(value, targets[i])) return usage("generate: counts must be whole numbers");
+    }
+    const char* seed = option_value(argc, argv, 1, "--seed");
+    if (seed != NULL) {
+        char* end;
+        options.seed = strtoull(seed, &end, 10);
+        if (!isdigit((unsigned char)*seed) || *end != '\0') return usage("generate: seed must be a whole number");
+    }
+    const char* date = option_value(argc, argv, 1, "--date");
+    if (date != NULL && (options.today = utils_date_key(date)) == 0) return usage("generate: date must be DD-MM-YYYY");
+
+    generate_defaults(&options);
+    const char* problem = generate_check(&options);
+    if (problem != NULL) {
+        fprintf(stderr, "hms: generate: %s\n", problem);
+        return CLI_EXIT_FAILED;
+    }
+
+    int result = generate_dataset(&options, &stats);
+    printf("patients\tactive\tdoctors\treceptionists\tusers\tappointments\tarchived\n");
+    printf("%d\t%d\t%d\t%d\t%d\t%d\t%d\n", options.patients, stats.active, options.doctors,
+           options.receptionists, stats.users, options.appointments, stats.archived);
+    if (result != 0) return fail("generate: could not save the generated tables");
+    return CLI_EXIT_OK;
+}
+
+/*
+ *==========================================================================
+ *                              ENTRY POINT
+ *==========================================================================
+ */
+
+bool cli_is_command(const char* name) {
+    return strcmp(name, "patient") == 0 || strcmp(name, "appt") == 0 || strcmp(name, "query") == 0 ||
+           strcmp(name, "import") == 0 || strcmp(name, "export") == 0 || strcmp(name, "generate") == 0;
+}
+
+int cli_run(int argc, char* argv[]) {
+    int status;
+    if (strcmp(argv[0], "patient") == 0) status = patient_command(argc, argv);
+    else if (strcmp(argv[0], "appt") == 0) status = appt_command(argc, argv);
+    else if (strcmp(argv[0], "import") == 0) status = import_command(argc, argv);
+    else if (strcmp(argv[0], "export") == 0) status = export_command(argc, argv);
+    else if (strcmp(argv[0], "generate") == 0) status = generate_command(argc, argv);
+    else status = query_command(argc, argv);
+
+    if (fflush(stdout) != 0 && status == CLI_EXIT_OK) status = CLI_EXIT_FAILED;
+    return status;
+}
+
+void cli_print_usage(const char* program_name) {
+    printf("Commands (tab-separated output, header line first):\n");
+    printf("  %s patient add --name N --age A --gender M|F --phone P --address A --blood B\n", program_name);
+    printf("  %s patient get|discharge ID\n", program_name);
+    printf("  %s appt add --patient ID --doctor ID --date DD-MM-YYYY --time T --reason R\n", program_name);
+    printf("  %s appt list [--doctor ID] [--patient ID] [--date D] [--status S] [--history]\n", program_name);
+    printf("  %s appt status ID pending|confirmed|completed|cancelled\n", program_name);
+    printf("  %s query patients|doctors|receptionists|users|appointments [FIELD=VALUE]...\n", program_name);
+    printf("  %s export TABLE [--format csv|jsonl] [--output FILE]\n", program_name);
+    printf("  %s import TABLE FILE|- [--format csv|jsonl] [--rejects FILE]\n", program_name);
+    printf("  %s generate [--patients N] [--doctors N] [--receptionists N] [--appointments N]\n", program_name);
+    printf("      [--seed S] [--threads T] [--date DD-MM-YYYY]   (into an empty data directory)\n");
+    printf("Exit status: 0 success, 1 failed, 2 malformed command.\n\n");
+}
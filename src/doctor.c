@@ -10,45 +10,23 @@
 #include "../include/doctor.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
 #include "../include/hospital.h"
 
 int doctor_save_to_file(void) {
-    FILE* file = fopen(DOCTORS_FILE, "wb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fwrite(&doctor_count, sizeof(int), 1, file) != 1 ||
-        fwrite(&doctor_available, sizeof(int), 1, file) != 1 ||
-        fwrite(doctors, sizeof(Doctor), doctor_count, file) != (size_t)doctor_count) {
-        fclose(file);
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_save(TABLE_DOCTORS);
+    metrics_end(METRIC_SAVE_DOCTORS, timer, result == 0);
+    return result;
 }
 
 int doctor_load_from_file(void) {
-    FILE* file = fopen(DOCTORS_FILE, "rb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fread(&doctor_count, sizeof(int), 1, file) != 1 ||
-        fread(&doctor_available, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (doctor_count < 0 || doctor_count > MAX_DOCTORS) {
-        fclose(file);
-        doctor_count = 0;
-        return -1;
-    }
-    if (fread(doctors, sizeof(Doctor), doctor_count, file) != (size_t)doctor_count) {
-        fclose(file);
-        doctor_count = 0;
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_load(TABLE_DOCTORS);
+    metrics_end(METRIC_LOAD_DOCTORS, timer, result == 0);
+    return result;
 }
 
 int doctor_generate_id(void) {
@@ -68,11 +46,13 @@ void doctor_view_all() {
         return;
     }
 
+    ui_list_begin("All Doctors");
     for (int i = 0; i < doctor_count; i++) {
         if (doctors[i].is_active) {
-            ui_print_doctor(doctors[i], count++);
+            ui_list_doctor(doctors[i], count++);
         }
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -155,15 +135,19 @@ void doctor_search_by_id(void) {
             ui_pause();
             continue;
         }
-        for (int i = 0; i < doctor_count; i++) {
-            if (doctors[i].id == id) {
-                ui_clear_screen();
-                ui_print_banner();
-                
-                ui_print_doctor(doctors[i], (doctors[i].id - DOCTOR_ID_START));
-                ui_pause();
-                return;
-            }
+        MetricsTimer timer = metrics_begin();
+        int match = -1;
+        for (int i = 0; i < doctor_count && match == -1; i++) {
+            if (doctors[i].id == id) match = i;
+        }
+        metrics_end(METRIC_SEARCH_DOCTOR_ID, timer, match != -1);
+        if (match != -1) {
+            ui_clear_screen();
+            ui_print_banner();
+
+            ui_print_doctor(doctors[match], (doctors[match].id - DOCTOR_ID_START));
+            ui_pause();
+            return;
         }
         ui_print_error("Doctor not found!");
         ui_pause();
@@ -194,16 +178,25 @@ void doctor_search_by_name(void) {
         }
 
         utils_fix_name(name);
-        for (int i = 0; i < doctor_count; i++) {
+        MetricsTimer timer = metrics_begin();
+        // The server's copy when connected, else the table in memory
+        Doctor doctor;
+        int matches = storage_search(TABLE_DOCTORS, name, &doctor, 1);
+        for (int i = 0; i < doctor_count && matches < 0; i++) {
             if (strcmp(doctors[i].name, name) == 0) {
-                ui_clear_screen();
-                ui_print_banner();
-                
-                ui_print_doctor(doctors[i], (doctors[i].id - DOCTOR_ID_START));
-                ui_pause();
-                return;
+                doctor = doctors[i];
+                matches = 1;
             }
         }
+        metrics_end(METRIC_SEARCH_DOCTOR_NAME, timer, matches == 1);
+        if (matches == 1) {
+            ui_clear_screen();
+            ui_print_banner();
+
+            ui_print_doctor(doctor, (doctor.id - DOCTOR_ID_START));
+            ui_pause();
+            return;
+        }
         ui_print_error("Doctor not found!");
         ui_pause();
         return;
@@ -230,15 +223,19 @@ void doctor_search_by_phone(void) {
             ui_pause();
             continue;
         }
-        for (int i = 0; i < doctor_count; i++) {
-            if (strcmp(doctors[i].phone, phone) == 0) {
-                ui_clear_screen();
-                ui_print_banner();
+        MetricsTimer timer = metrics_begin();
+        int match = -1;
+        for (int i = 0; i < doctor_count && match == -1; i++) {
+            if (strcmp(doctors[i].phone, phone) == 0) match = i;
+        }
+        metrics_end(METRIC_SEARCH_DOCTOR_PHONE, timer, match != -1);
+        if (match != -1) {
+            ui_clear_screen();
+            ui_print_banner();
 
-                ui_print_doctor(doctors[i], (doctors[i].id - DOCTOR_ID_START));
-                ui_pause();
-                return;
-            }
+            ui_print_doctor(doctors[match], (doctors[match].id - DOCTOR_ID_START));
+            ui_pause();
+            return;
         }
         ui_print_error("Doctor not found!");
         ui_pause();
@@ -286,12 +283,16 @@ void doctor_search_by(void) {
 }
 
 int doctor_search_id (int id) {
+    MetricsTimer timer = metrics_begin();
+    int index = -1;
     for (int i = 0; i < doctor_count; i++) {
         if (doctors[i].id == id) {
-            return i;
+            index = i;
+            break;
         }
     }
-    return -1;
+    metrics_end(METRIC_SEARCH_DOCTOR_ID, timer, index != -1);
+    return index;
 }
 
 void doctor_update_name(const char* menu_items[], int index) {
@@ -314,6 +315,7 @@ void doctor_update_name(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "name", doctors[index].name, name);
     doctors[index].name[0] = '\0';
     strncpy(doctors[index].name, name, NAME_SIZE);
 }
@@ -337,6 +339,7 @@ void doctor_update_phone(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "phone", doctors[index].phone, phone);
     doctors[index].phone[0] = '\0';
     strncpy(doctors[index].phone, phone, PHONE_SIZE);
 }
@@ -360,6 +363,7 @@ void doctor_update_email(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "email", doctors[index].email, email);
     doctors[index].email[0] = '\0';
     strncpy(doctors[index].email, email, EMAIL_SIZE);
 }
@@ -384,6 +388,7 @@ void doctor_update_specialization(const char* menu_items[], int index) {
         return;
     }
     utils_fix_name(spec);
+    audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "specialization", doctors[index].specialization, spec);
     doctors[index].specialization[0] = '\0';
     strncpy(doctors[index].specialization, spec, SPEC_SIZE);
 }
@@ -406,6 +411,10 @@ void doctor_update_room(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    char old_room[ROOM_SIZE], new_room[ROOM_SIZE];
+    snprintf(old_room, sizeof(old_room), "%d", doctors[index].room_number);
+    snprintf(new_room, sizeof(new_room), "%d", room);
+    audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "room", old_room, new_room);
     doctors[index].room_number = room;
 }
 
@@ -423,10 +432,11 @@ void doctor_update_availability(const char* menu_items[], int index) {
     ui_print_menu("Update Doctor", menu, 3, UI_SIZE);
     input = utils_get_int();
 
-    if (input == 1) {
-        doctors[index].is_available = true;
-    } else if (input == 2) {
-        doctors[index].is_available = false;
+    if (input == 1 || input == 2) {
+        audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "availability",
+                     doctors[index].is_available ? "Available" : "Unavailable",
+                     input == 1 ? "Available" : "Unavailable");
+        doctors[index].is_available = input == 1;
     } else {
         ui_print_error("Invalid input! Could not update.");
         ui_pause();
@@ -443,17 +453,19 @@ void doctor_update_status(const char* menu_items[], int index) {
         ">> "
     };
     
-    bool status;
     int input;
     ui_print_menu("Update Doctor", menu, 3, UI_SIZE);
     input = utils_get_int();
 
-    if (input == 1) {
-        status = true;
-    } else if (input == 2) {
-        status = false;
+    if (input == 1 || input == 2) {
+        bool status = input == 1;
+        audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_UPDATE, "status",
+                     doctors[index].is_active ? "Active" : "Inactive", status ? "Active" : "Inactive");
+        doctors[index].is_active = status;
+    } else {
+        ui_print_error("Invalid input! Could not update.");
+        ui_pause();
     }
-    doctors[index].is_active = status;
 }
 
 void doctor_update_using_id() {
@@ -486,6 +498,8 @@ void doctor_update_using_id() {
         }
     } while (1);
 
+    // Edit the record as it is now, not as this terminal last saw it
+    storage_refresh_record(TABLE_DOCTORS, id);
     int index = doctor_search_id(id);
     if (index == -1) return;
 
@@ -610,6 +624,7 @@ void doctor_deactivate_account() {
 
     if (input == 1) {
         doctors[index].is_active = false;
+        audit_record(AUDIT_DOCTOR, doctors[index].id, AUDIT_DEACTIVATE, "status", "Active", "Inactive");
         ui_print_success("Doctor deactivated successfully!");
         doctor_available--;
         doctor_unavailable++;
@@ -632,10 +647,12 @@ void doctor_view_discharged(void) {
         return;
     }
 
+    ui_list_begin("Inactive Doctors");
     for (int i = 0; i < doctor_count; i++) {
         if (!doctors[i].is_active) {
-            ui_print_doctor(doctors[i], count++);
+            ui_list_doctor(doctors[i], count++);
         }
     }
+    ui_list_end();
     ui_pause();
 }
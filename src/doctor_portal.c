@@ -10,51 +10,196 @@
 #include <string.h>
 #include "../include/doctor_portal.h"
 #include "../include/appointment.h"
+#include "../include/appointment_stats.h"
+#include "../include/appointment_archive.h"
+#include "../include/reminder.h"
 #include "../include/patient.h"
 #include "../include/doctor.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
 #include "../include/hospital.h"
 
 void doctor_portal_view_appointments(int doctor_id) {
     appointment_view_by_doctor(doctor_id);
 }
 
-void doctor_portal_view_pending(int doctor_id) {
+/*
+ *==========================================================================
+ *                         TODAY'S SCHEDULE CACHE
+ *==========================================================================
+ */
+
+/*
+ * Today's appointments and the pending ones for the logged-in doctor,
+ * built once at login and patched by doctor_portal_schedule_on_change()
+ * instead of rescanning the appointment table every time a list is opened.
+ */
+static struct {
+    bool valid;
+    bool overflow;          /* More entries than fit; fall back to a scan */
+    int doctor_id;
+    int day;                /* YYYYMMDD the schedule was built for */
+    int count;
+    Appointment entries[MAX_DAILY_SCHEDULE];
+    bool pending_overflow;
+    int pending_count;
+    Appointment pending[MAX_PENDING_SCHEDULE];     /* In table order */
+} schedule;
+
+void doctor_portal_schedule_build(int doctor_id) {
+    schedule.valid = true;
+    schedule.overflow = false;
+    schedule.pending_overflow = false;
+    schedule.doctor_id = doctor_id;
+    schedule.day = utils_today_key();
+    schedule.count = 0;
+    schedule.pending_count = 0;
+
+    for (int i = 0; i < appointment_count; i++) {
+        if (appointments[i].doctor_id != doctor_id) continue;
+
+        if (appointments[i].status == APPT_PENDING) {
+            if (schedule.pending_count == MAX_PENDING_SCHEDULE) schedule.pending_overflow = true;
+            else schedule.pending[schedule.pending_count++] = appointments[i];
+        }
+        if (appointments[i].status == APPT_CANCELLED ||
+            utils_date_key(appointments[i].date) != schedule.day) {
+            continue;
+        }
+        if (schedule.count == MAX_DAILY_SCHEDULE) {
+            schedule.overflow = true;
+            continue;
+        }
+        schedule.entries[schedule.count++] = appointments[i];
+    }
+}
+
+void doctor_portal_schedule_invalidate(void) {
+    schedule.valid = false;
+}
+
+/* Keeps the pending list in step: in it while pending, out of it otherwise. */
+static void pending_on_change(const Appointment* appt) {
+    int i = 0;
+    while (i < schedule.pending_count && schedule.pending[i].id != appt->id) i++;
+    bool listed = i < schedule.pending_count;
+
+    if (appt->status == APPT_PENDING && listed) {
+        schedule.pending[i] = *appt;
+    } else if (appt->status == APPT_PENDING) {
+        if (schedule.pending_count == MAX_PENDING_SCHEDULE) {
+            schedule.pending_overflow = true;
+            return;
+        }
+        // New bookings take the next ID and go at the end, as in the table
+        i = 0;
+        while (i < schedule.pending_count && schedule.pending[i].id < appt->id) i++;
+        memmove(&schedule.pending[i + 1], &schedule.pending[i],
+                (size_t)(schedule.pending_count - i) * sizeof(Appointment));
+        schedule.pending[i] = *appt;
+        schedule.pending_count++;
+    } else if (listed) {
+        memmove(&schedule.pending[i], &schedule.pending[i + 1],
+                (size_t)(schedule.pending_count - i - 1) * sizeof(Appointment));
+        schedule.pending_count--;
+    }
+}
+
+void doctor_portal_schedule_on_change(const Appointment* appt) {
+    if (!schedule.valid || appt->doctor_id != schedule.doctor_id) return;
+
+    pending_on_change(appt);
+    if (utils_date_key(appt->date) != schedule.day) return;
+
+    for (int i = 0; i < schedule.count; i++) {
+        if (schedule.entries[i].id != appt->id) continue;
+
+        if (appt->status == APPT_CANCELLED) {
+            // Keep the remaining entries in booking order
+            for (int j = i; j < schedule.count - 1; j++) {
+                schedule.entries[j] = schedule.entries[j + 1];
+            }
+            schedule.count--;
+        } else {
+            schedule.entries[i] = *appt;
+        }
+        return;
+    }
+
+    if (appt->status == APPT_CANCELLED) return;
+    if (schedule.count == MAX_DAILY_SCHEDULE) {
+        schedule.overflow = true;
+        return;
+    }
+    schedule.entries[schedule.count++] = *appt;
+}
+
+void doctor_portal_view_today(int doctor_id, const char* today_date) {
     int count = 0;
+    int day = utils_date_key(today_date);
     ui_clear_screen();
     ui_print_banner();
-    
-    for (int i = 0; i < appointment_count; i++) {
-        if (appointments[i].doctor_id == doctor_id && 
-            appointments[i].status == APPT_PENDING) {
-            ui_print_appointment(appointments[i], count++);
+
+    // Past midnight the cached schedule belongs to yesterday; it is also
+    // dropped when another terminal changes the appointments
+    if (schedule.doctor_id == doctor_id && (!schedule.valid || schedule.day != utils_today_key())) {
+        doctor_portal_schedule_build(doctor_id);
+    }
+
+    ui_list_begin("Today's Appointments");
+    if (schedule.valid && !schedule.overflow &&
+        schedule.doctor_id == doctor_id && schedule.day == day) {
+        for (int i = 0; i < schedule.count; i++) {
+            ui_list_appointment(schedule.entries[i], count++);
+        }
+    } else {
+        for (int i = 0; i < appointment_count; i++) {
+            if (appointments[i].doctor_id == doctor_id && 
+                strcmp(appointments[i].date, today_date) == 0 &&
+                appointments[i].status != APPT_CANCELLED) {
+                ui_list_appointment(appointments[i], count++);
+            }
         }
     }
+    ui_list_end();
     
     if (count == 0) {
-        const char* menu_items[] = {"No pending appointments!"};
-        ui_print_menu("Pending Appointments", menu_items, 1, UI_SIZE);
+        const char* menu_items[] = {"No appointments for today!"};
+        ui_print_menu("Today's Appointments", menu_items, 1, UI_SIZE);
     }
     ui_pause();
 }
 
-void doctor_portal_view_today(int doctor_id, const char* today_date) {
+void doctor_portal_view_pending(int doctor_id) {
     int count = 0;
     ui_clear_screen();
     ui_print_banner();
-    
-    for (int i = 0; i < appointment_count; i++) {
-        if (appointments[i].doctor_id == doctor_id && 
-            strcmp(appointments[i].date, today_date) == 0 &&
-            appointments[i].status != APPT_CANCELLED) {
-            ui_print_appointment(appointments[i], count++);
+
+    // Rebuilt if another terminal changed the appointments
+    if (schedule.doctor_id == doctor_id && !schedule.valid) {
+        doctor_portal_schedule_build(doctor_id);
+    }
+
+    ui_list_begin("Pending Appointments");
+    if (schedule.valid && !schedule.pending_overflow && schedule.doctor_id == doctor_id) {
+        for (int i = 0; i < schedule.pending_count; i++) {
+            ui_list_appointment(schedule.pending[i], count++);
+        }
+    } else {
+        for (int i = 0; i < appointment_count; i++) {
+            if (appointments[i].doctor_id == doctor_id && 
+                appointments[i].status == APPT_PENDING) {
+                ui_list_appointment(appointments[i], count++);
+            }
         }
     }
+    ui_list_end();
     
     if (count == 0) {
-        const char* menu_items[] = {"No appointments for today!"};
-        ui_print_menu("Today's Appointments", menu_items, 1, UI_SIZE);
+        const char* menu_items[] = {"No pending appointments!"};
+        ui_print_menu("Pending Appointments", menu_items, 1, UI_SIZE);
     }
     ui_pause();
 }
@@ -100,13 +245,15 @@ void doctor_portal_complete_appointment(int doctor_id) {
     ui_print_banner();
     
     int count = 0;
+    ui_list_begin("Appointments to Complete");
     for (int i = 0; i < appointment_count; i++) {
         if (appointments[i].doctor_id == doctor_id && 
             (appointments[i].status == APPT_PENDING || 
              appointments[i].status == APPT_CONFIRMED)) {
-            ui_print_appointment(appointments[i], count++);
+            ui_list_appointment(appointments[i], count++);
         }
     }
+    ui_list_end();
     
     if (count == 0) {
         const char* menu_items[] = {"No appointments to complete!"};
@@ -137,7 +284,7 @@ void doctor_portal_complete_appointment(int doctor_id) {
         return;
     }
     
-    appointments[idx].status = APPT_COMPLETED;
+    appointment_set_status(idx, APPT_COMPLETED);
     appointment_save_to_file();
     ui_print_success("Appointment marked as completed!");
     ui_pause();
@@ -151,12 +298,14 @@ void doctor_portal_cancel_appointment(int doctor_id) {
     ui_print_banner();
     
     int count = 0;
+    ui_list_begin("Appointments to Cancel");
     for (int i = 0; i < appointment_count; i++) {
         if (appointments[i].doctor_id == doctor_id && 
             appointments[i].status == APPT_PENDING) {
-            ui_print_appointment(appointments[i], count++);
+            ui_list_appointment(appointments[i], count++);
         }
     }
+    ui_list_end();
     
     if (count == 0) {
         const char* menu_items[] = {"No appointments to cancel!"};
@@ -187,7 +336,7 @@ void doctor_portal_cancel_appointment(int doctor_id) {
         return;
     }
     
-    appointments[idx].status = APPT_CANCELLED;
+    appointment_set_status(idx, APPT_CANCELLED);
     appointment_save_to_file();
     ui_print_success("Appointment cancelled!");
     ui_pause();
@@ -220,12 +369,16 @@ void doctor_portal_update_availability(int doctor_id) {
     
     switch (choice) {
         case 1:
+            audit_record(AUDIT_DOCTOR, doctors[idx].id, AUDIT_UPDATE, "availability",
+                         doctors[idx].is_available ? "Available" : "Unavailable", "Available");
             doctors[idx].is_available = true;
             doctor_save_to_file();
             ui_print_success("Status set to Available!");
             ui_pause();
             break;
         case 2:
+            audit_record(AUDIT_DOCTOR, doctors[idx].id, AUDIT_UPDATE, "availability",
+                         doctors[idx].is_available ? "Available" : "Unavailable", "Unavailable");
             doctors[idx].is_available = false;
             doctor_save_to_file();
             ui_print_success("Status set to Unavailable!");
@@ -253,30 +406,46 @@ void doctor_portal_view_profile(int doctor_id) {
     ui_pause();
 }
 
+void doctor_portal_view_statistics(int doctor_id) {
+    ui_clear_screen();
+    ui_print_banner();
+    appointment_stats_print(doctor_id, "My Appointment Statistics");
+    ui_pause();
+}
+
 void doctor_portal_menu(int doctor_id, const char* doctor_name) {
     int choice;
+    char today[DATE_SIZE];
     
     // Build title with doctor's name
     char title[80];
     snprintf(title, sizeof(title), "Doctor Portal | Dr. %s", doctor_name);
+
+    doctor_portal_schedule_build(doctor_id);
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
+        reminder_poll(utils_now_minutes());
+        reminder_print_unseen(doctor_id);
         
         const char* menu_items[] = {
             "View All My Appointments",
+            "View Today's Appointments",
             "View Pending Appointments",
             "View Patient Details",
             "Complete Appointment",
             "Cancel Appointment",
             "Update My Availability",
             "View My Profile",
+            "View My Statistics",
+            "View Appointment History",
             "Logout",
             ">> "
         };
         
-        ui_print_menu(title, menu_items, 9, UI_SIZE);
+        ui_print_menu(title, menu_items, 12, UI_SIZE);
         choice = utils_get_int();
         
         switch (choice) {
@@ -284,24 +453,33 @@ void doctor_portal_menu(int doctor_id, const char* doctor_name) {
                 doctor_portal_view_appointments(doctor_id);
                 break;
             case 2:
-                doctor_portal_view_pending(doctor_id);
+                doctor_portal_view_today(doctor_id, utils_get_today(today, sizeof(today)));
                 break;
             case 3:
-                doctor_portal_view_patient();
+                doctor_portal_view_pending(doctor_id);
                 break;
             case 4:
-                doctor_portal_complete_appointment(doctor_id);
+                doctor_portal_view_patient();
                 break;
             case 5:
-                doctor_portal_cancel_appointment(doctor_id);
+                doctor_portal_complete_appointment(doctor_id);
                 break;
             case 6:
-                doctor_portal_update_availability(doctor_id);
+                doctor_portal_cancel_appointment(doctor_id);
                 break;
             case 7:
-                doctor_portal_view_profile(doctor_id);
+                doctor_portal_update_availability(doctor_id);
                 break;
             case 8:
+                doctor_portal_view_profile(doctor_id);
+                break;
+            case 9:
+                doctor_portal_view_statistics(doctor_id);
+                break;
+            case 10:
+                appointment_view_history(doctor_id);
+                break;
+            case 11:
                 ui_print_info("Logging out...");
                 ui_pause();
                 break;
@@ -309,5 +487,7 @@ void doctor_portal_menu(int doctor_id, const char* doctor_name) {
                 ui_print_error("Invalid choice!");
                 ui_pause();
         }
-    } while (choice != 8);
+    } while (choice != 11);
+
+    doctor_portal_schedule_invalidate();
 }
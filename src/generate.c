@@ -0,0 +1,570 @@
+/**
+ * @file generate.c
+ * @brief Synthetic dataset generator implementation for Healthcare Management System
+ *
+ * Every record is computed from its own index alone: a random stream is
+ * seeded from (seed, table, index), so threads can fill disjoint ranges
+ * of a table with no coordination and the result does not depend on how
+ * the ranges were split. The tables are then checked with the batch
+ * validators and saved through the background writer, which writes one
+ * table while the next is being encoded.
+ *
+ * Appointments are laid out in date order: appointment i belongs to doctor
+ * i % doctors, and each doctor's appointments fill working days (every day
+ * but Friday) up to GENERATE_FUTURE_DAYS past today, a fixed number per
+ * day in distinct slots. Past ones are mostly completed, later ones
+ * pending or confirmed, and a share of each is cancelled. Patients who
+ * registered early visit more often and are more often discharged.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/generate.h"
+#include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/appointment_stats.h"
+#include "../include/audit.h"
+#include "../include/auth.h"
+#include "../include/doctor.h"
+#include "../include/patient.h"
+#include "../include/receptionist.h"
+#include "../include/storage.h"
+#include "../include/utils.h"
+#include "../include/validate.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#define GENERATE_MAX_THREADS    64
+#define GENERATE_HISTORY_DAYS   250     /* Working days of history, when a doctor's day has room */
+#define GENERATE_STAFF_IDS      1000    /* IDs in the doctor and receptionist ranges */
+#define EARLIEST_YEAR           1900    /* utils_date_key refuses earlier dates */
+
+/* Salts of the random streams, one per table */
+enum {
+    STREAM_PATIENTS = 1,
+    STREAM_DOCTORS,
+    STREAM_RECEPTIONISTS,
+    STREAM_APPOINTMENTS
+};
+
+typedef struct {
+    uint64_t state;
+} Rng;
+
+typedef struct {
+    int per_day;            /* Appointments per doctor per working day */
+    int days;               /* Working days the appointments cover */
+    long last_day;          /* Day number of the last working day */
+    long today;             /* Day number of today */
+} Layout;
+
+static GenerateOptions config;
+static Layout layout;
+
+/*
+ *==========================================================================
+ *                              WORD LISTS
+ *==========================================================================
+ */
+
+static const char* male_names[] = {
+    "Rahim", "Karim", "Tanvir", "Imran", "Arif", "Jamal", "Habib", "Sohel", "Rafiq", "Kamal",
+    "Nasir", "Shakil", "Mahmud", "Fahim", "Rakib", "Sabbir", "Mizan", "Jahid", "Anwar", "Faruk",
+    "Shahin", "Riyad", "Tarek", "Masud"
+};
+
+static const char* female_names[] = {
+    "Nusrat", "Farhana", "Sadia", "Mitu", "Shirin", "Ruma", "Lima", "Tania", "Sumaiya", "Nasrin",
+    "Rokeya", "Sharmin", "Jannat", "Afroza", "Moushumi", "Tahmina", "Rehana", "Shapla", "Bithi",
+    "Fatema", "Salma", "Nargis", "Ayesha", "Laboni"
+};
+
+static const char* last_names[] = {
+    "Uddin", "Hossain", "Akter", "Rahman", "Islam", "Khatun", "Ahmed", "Chowdhury", "Sarkar",
+    "Miah", "Begum", "Alam", "Haque", "Karim", "Talukder", "Sultana", "Bhuiyan", "Mollah",
+    "Siddique", "Khan", "Das", "Roy", "Saha", "Barua"
+};
+
+static const char* areas[] = {
+    "Dhanmondi, Dhaka", "Mirpur, Dhaka", "Uttara, Dhaka", "Mohammadpur, Dhaka", "Gulshan, Dhaka",
+    "Banani, Dhaka", "Motijheel, Dhaka", "Badda, Dhaka", "Agrabad, Chattogram", "Halishahar, Chattogram",
+    "Zindabazar, Sylhet", "Shaheb Bazar, Rajshahi", "Sonadanga, Khulna", "Kandirpar, Cumilla",
+    "Gazipur Sadar, Gazipur", "Narayanganj Sadar, Narayanganj"
+};
+
+static const char* specializations[] = {
+    "Medicine", "Pediatrics", "Gynecology", "Cardiology", "Orthopedics", "Dermatology",
+    "ENT", "Ophthalmology", "Neurology", "Psychiatry", "General Surgery", "Oncology"
+};
+static const int specialization_weights[] = { 22, 14, 12, 10, 9, 7, 6, 5, 5, 4, 4, 2 };
+
+static const char* blood_groups[] = { "O+", "B+", "A+", "AB+", "O-", "B-", "A-", "AB-" };
+static const int blood_group_weights[] = { 30, 29, 25, 9, 2, 2, 2, 1 };
+
+/* Operator prefixes after "01" */
+static const char phone_operators[] = { '7', '9', '8', '6', '5', '3', '4' };
+static const int phone_operator_weights[] = { 45, 15, 15, 8, 7, 6, 4 };
+
+/* Ages in buckets: children, young adults, middle age, elderly */
+static const int age_floors[] = { 1, 15, 40, 65 };
+static const int age_spans[] = { 14, 25, 25, 31 };
+static const int age_weights[] = { 18, 35, 32, 15 };
+
+static const char* reasons[] = {
+    "Routine checkup", "Follow up visit", "Fever and cough", "Chest pain", "Back pain", "Headache",
+    "Abdominal pain", "Skin rash", "High blood pressure", "Diabetes review", "Vaccination",
+    "Joint pain", "Eye problem", "Ear pain", "Prenatal visit", "Test results"
+};
+static const int reason_weights[] = { 14, 16, 10, 5, 6, 6, 6, 4, 7, 7, 4, 5, 3, 2, 3, 2 };
+
+#define COUNT_OF(array) ((int)(sizeof(array) / sizeof((array)[0])))
+
+/*
+ *==========================================================================
+ *                              RANDOM STREAMS
+ *==========================================================================
+ */
+
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static Rng rng_for(int stream, int index) {
+    Rng rng = { mix(config.seed ^ mix((uint64_t)stream << 32 | (uint32_t)index)) };
+    return rng;
+}
+
+static uint32_t rng_next(Rng* rng) {
+    rng->state += 0x9E3779B97F4A7C15ULL;
+    return (uint32_t)(mix(rng->state) >> 32);
+}
+
+/* Uniform in [0, n) */
+static int rng_below(Rng* rng, int n) {
+    return (int)(((uint64_t)rng_next(rng) * (uint64_t)n) >> 32);
+}
+
+/* An index into weights, each picked in proportion to its weight */
+static int rng_weighted(Rng* rng, const int* weights, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) total += weights[i];
+    int r = rng_below(rng, total);
+    for (int i = 0; i < count; i++) {
+        if (r < weights[i]) return i;
+        r -= weights[i];
+    }
+    return count - 1;
+}
+
+/*
+ *==========================================================================
+ *                              CALENDAR
+ *==========================================================================
+ */
+
+/* Days since 01-01-1970 of a YYYYMMDD key, for the proleptic Gregorian calendar */
+static long day_number(int key) {
+    int year = key / 10000, month = key / 100 % 100, day = key % 100;
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long year_of_era = year - era * 400;
+    long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+static int day_key(long days) {
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    long day_of_era = days - era * 146097;
+    long year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    long day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    long mp = (5 * day_of_year + 2) / 153;
+    int day = (int)(day_of_year - (153 * mp + 2) / 5 + 1);
+    int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    int year = (int)(year_of_era + era * 400 + (month <= 2));
+    return year * 10000 + month * 100 + day;
+}
+
+static bool is_friday(long days) {
+    return (days + 4) % 7 == 5;     /* 01-01-1970 was a Thursday */
+}
+
+/* Day number of the working day `back` working days before layout.last_day */
+static long working_day(int back) {
+    // Any seven days in a row hold exactly one Friday
+    long days = layout.last_day - (long)(back / 6) * 7;
+    for (int step = back % 6; step > 0; step--) {
+        days--;
+        if (is_friday(days)) days--;
+    }
+    return days;
+}
+
+static void layout_plan(const GenerateOptions* options) {
+    int doctors = options->doctors > 0 ? options->doctors : 1;
+    long per_doctor = (options->appointments + doctors - 1) / doctors;
+    long per_day = (per_doctor + GENERATE_HISTORY_DAYS - 1) / GENERATE_HISTORY_DAYS;
+
+    layout.per_day = per_day < 1 ? 1 : per_day > GENERATE_DAILY_SLOTS ? GENERATE_DAILY_SLOTS : (int)per_day;
+    layout.days = (int)((per_doctor + layout.per_day - 1) / layout.per_day);
+    layout.today = day_number(options->today);
+    layout.last_day = layout.today + GENERATE_FUTURE_DAYS;
+    if (is_friday(layout.last_day)) layout.last_day--;
+}
+
+/*
+ *==========================================================================
+ *                              RECORDS
+ *==========================================================================
+ */
+
+static void person_name(Rng* rng, bool female, char* name) {
+    const char* first = female ? female_names[rng_below(rng, COUNT_OF(female_names))]
+                               : male_names[rng_below(rng, COUNT_OF(male_names))];
+    snprintf(name, NAME_SIZE, "%s %s", first, last_names[rng_below(rng, COUNT_OF(last_names))]);
+}
+
+/* Distinct for every index below 10^8: 48271 is prime to 10^8 */
+static void person_phone(Rng* rng, int index, int stream, char* phone) {
+    char operator = phone_operators[rng_weighted(rng, phone_operator_weights, COUNT_OF(phone_operators))];
+    long number = ((long)index * 48271L + (long)stream * 7919L + (long)(config.seed % 100000000ULL)) % 100000000L;
+    snprintf(phone, PHONE_SIZE, "01%c%08ld", operator, number);
+}
+
+/* first.last plus the ID, in lower case */
+static void staff_email(const char* name, int id, char* email) {
+    char local[NAME_SIZE];
+    int n = 0;
+    for (int i = 0; name[i] != '\0' && n < (int)sizeof(local) - 1; i++) {
+        char c = name[i];
+        local[n++] = c == ' ' ? '.' : (char)(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+    local[n] = '\0';
+    snprintf(email, EMAIL_SIZE, "%.30s%d@hms.local", local, id);
+}
+
+static void fill_patients(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        Rng rng = rng_for(STREAM_PATIENTS, i);
+        Patient* p = &patients[i];
+        memset(p, 0, sizeof(*p));
+
+        p->id = PATIENT_ID_START + i;
+        p->gender = rng_below(&rng, 100) < 51 ? MALE : FEMALE;
+        person_name(&rng, p->gender == FEMALE, p->name);
+        int bucket = rng_weighted(&rng, age_weights, COUNT_OF(age_weights));
+        p->age = age_floors[bucket] + rng_below(&rng, age_spans[bucket]);
+        person_phone(&rng, i, STREAM_PATIENTS, p->phone);
+        snprintf(p->address, ADDRESS_SIZE, "House %d, Road %d, %s", 1 + rng_below(&rng, 120),
+                 1 + rng_below(&rng, 40), areas[rng_below(&rng, COUNT_OF(areas))]);
+        snprintf(p->blood_group, BLOOD_SIZE, "%s",
+                 blood_groups[rng_weighted(&rng, blood_group_weights, COUNT_OF(blood_groups))]);
+        // Early registrations have had longer to be discharged
+        p->is_active = rng_below(&rng, 100) < 55 + (int)(40LL * i / config.patients);
+    }
+}
+
+static void fill_doctors(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        Rng rng = rng_for(STREAM_DOCTORS, i);
+        Doctor* d = &doctors[i];
+        memset(d, 0, sizeof(*d));
+
+        d->id = DOCTOR_ID_START + i;
+        person_name(&rng, rng_below(&rng, 100) < 45, d->name);
+        person_phone(&rng, i, STREAM_DOCTORS, d->phone);
+        staff_email(d->name, d->id, d->email);
+        snprintf(d->specialization, SPEC_SIZE, "%s",
+                 specializations[rng_weighted(&rng, specialization_weights, COUNT_OF(specializations))]);
+        d->room_number = 101 + i % 899;
+        d->is_available = rng_below(&rng, 100) < 90;
+        d->is_active = true;
+    }
+}
+
+static void fill_receptionists(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        Rng rng = rng_for(STREAM_RECEPTIONISTS, i);
+        Receptionist* r = &receptionists[i];
+        memset(r, 0, sizeof(*r));
+
+        r->id = RECEPTIONIST_ID_START + i;
+        person_name(&rng, rng_below(&rng, 100) < 70, r->name);
+        person_phone(&rng, i, STREAM_RECEPTIONISTS, r->phone);
+        staff_email(r->name, r->id, r->email);
+        r->is_available = rng_below(&rng, 100) < 85;
+        r->is_active = true;
+    }
+}
+
+static AppointmentStatus appointment_status(Rng* rng, long day) {
+    int r = rng_below(rng, 100);
+    if (day < layout.today) return r < 86 ? APPT_COMPLETED : APPT_CANCELLED;
+    if (day == layout.today) return r < 35 ? APPT_COMPLETED : r < 92 ? APPT_CONFIRMED : APPT_CANCELLED;
+    return r < 45 ? APPT_PENDING : r < 92 ? APPT_CONFIRMED : APPT_CANCELLED;
+}
+
+static void fill_appointments(int begin, int end) {
+    int stride = GENERATE_DAILY_SLOTS / layout.per_day;
+
+    for (int i = begin; i < end; i++) {
+        Rng rng = rng_for(STREAM_APPOINTMENTS, i);
+        Appointment* a = &appointments[i];
+        memset(a, 0, sizeof(*a));
+
+        int turn = i / config.doctors;      /* This doctor's appointments before it */
+        long day = working_day(layout.days - 1 - turn / layout.per_day);
+        int slot = turn % layout.per_day * stride + rng_below(&rng, stride);
+        unsigned minutes = 9 * 60 + (unsigned)slot * 15;
+        unsigned key = (unsigned)day_key(day);
+
+        a->id = APPOINTMENT_ID_START + i;
+        a->doctor_id = DOCTOR_ID_START + i % config.doctors;
+        a->status = appointment_status(&rng, day);
+        snprintf(a->date, DATE_SIZE, "%02u-%02u-%04u", key % 100, key / 100 % 100, key / 10000);
+        snprintf(a->time_slot, TIME_SIZE, "%u:%02u %s", (minutes / 60 + 11) % 12 + 1, minutes % 60,
+                 minutes < 12 * 60 ? "AM" : "PM");
+        snprintf(a->reason, REASON_SIZE, "%s", reasons[rng_weighted(&rng, reason_weights, COUNT_OF(reasons))]);
+
+        // Squaring favours the early patients; upcoming visits go to patients still in care
+        int patient = 0;
+        for (int attempt = 0; attempt < 4; attempt++) {
+            double u = rng_next(&rng) / 4294967296.0;
+            patient = (int)(u * u * config.patients);
+            if (day < layout.today || patients[patient].is_active) break;
+        }
+        a->patient_id = patients[patient].id;
+    }
+}
+
+/*
+ *==========================================================================
+ *                              THREADS
+ *==========================================================================
+ */
+
+typedef struct {
+    void (*fill)(int begin, int end);
+    int begin;
+    int end;
+} FillTask;
+
+#ifndef _WIN32
+static void* fill_thread(void* arg) {
+    FillTask* task = arg;
+    task->fill(task->begin, task->end);
+    return NULL;
+}
+#endif
+
+static int thread_count(void) {
+    int threads = config.threads;
+    #ifdef _WIN32
+        threads = 1;
+    #else
+        if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    #endif
+    return threads < 1 ? 1 : threads > GENERATE_MAX_THREADS ? GENERATE_MAX_THREADS : threads;
+}
+
+/* Splits [0, count) into one range per thread; the calling thread takes the first. */
+static void fill_parallel(void (*fill)(int begin, int end), int count) {
+    int threads = thread_count();
+    if (threads > count / 1024) threads = count / 1024 > 0 ? count / 1024 : 1;
+    FillTask tasks[GENERATE_MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        tasks[t].fill = fill;
+        tasks[t].begin = (int)((long long)count * t / threads);
+        tasks[t].end = (int)((long long)count * (t + 1) / threads);
+    }
+
+    #ifndef _WIN32
+        pthread_t ids[GENERATE_MAX_THREADS];
+        bool started[GENERATE_MAX_THREADS] = { false };
+        for (int t = 1; t < threads; t++) {
+            started[t] = pthread_create(&ids[t], NULL, fill_thread, &tasks[t]) == 0;
+        }
+        fill(tasks[0].begin, tasks[0].end);
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) pthread_join(ids[t], NULL);
+            else fill(tasks[t].begin, tasks[t].end);
+        }
+    #else
+        for (int t = 0; t < threads; t++) fill(tasks[t].begin, tasks[t].end);
+    #endif
+}
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+static int clamp(int value, int low, int high) {
+    return value < low ? low : value > high ? high : value;
+}
+
+void generate_defaults(GenerateOptions* options) {
+    if (options->patients < 0) options->patients = 1000;
+    int doctor_max = MAX_DOCTORS < GENERATE_STAFF_IDS ? MAX_DOCTORS : GENERATE_STAFF_IDS;
+    int receptionist_max = MAX_RECEPTIONISTS < GENERATE_STAFF_IDS ? MAX_RECEPTIONISTS : GENERATE_STAFF_IDS;
+    int accounts = MAX_USERS - user_count;
+
+    if (options->doctors < 0) {
+        int wanted = clamp(options->patients / 500, 2, doctor_max);
+        int room = accounts - (options->receptionists < 0 ? 1 : options->receptionists);
+        options->doctors = clamp(wanted, 0, room > 0 ? room : 0);
+    }
+    if (options->receptionists < 0) {
+        int room = accounts - options->doctors;
+        options->receptionists = clamp(options->doctors / 4, 1, receptionist_max);
+        if (options->receptionists > room) options->receptionists = room > 0 ? room : 0;
+    }
+    if (options->appointments < 0) {
+        long wanted = options->doctors > 0 ? (long)options->patients * 3 : 0;
+        options->appointments = wanted > MAX_APPOINTMENTS ? MAX_APPOINTMENTS : (int)wanted;
+    }
+}
+
+const char* generate_check(const GenerateOptions* options) {
+    if (patient_count > 0 || doctor_count > 0 || receptionist_count > 0 || appointment_count > 0 ||
+        appointment_archive_total() > 0) {
+        return "the data directory already holds records; generate into an empty one";
+    }
+    if (options->patients < 1 || options->patients > MAX_PATIENTS) return "patients must be 1 to MAX_PATIENTS";
+    if (options->doctors < 0 || options->doctors > MAX_DOCTORS || options->doctors > GENERATE_STAFF_IDS) {
+        return "doctors must be 0 to MAX_DOCTORS (and at most 1000)";
+    }
+    if (options->receptionists < 0 || options->receptionists > MAX_RECEPTIONISTS ||
+        options->receptionists > GENERATE_STAFF_IDS) {
+        return "receptionists must be 0 to MAX_RECEPTIONISTS (and at most 1000)";
+    }
+    if (user_count + options->doctors + options->receptionists > MAX_USERS) {
+        return "the doctors' and receptionists' accounts do not fit in MAX_USERS";
+    }
+    if (options->appointments < 0 || options->appointments > MAX_APPOINTMENTS) {
+        return "appointments must be 0 to MAX_APPOINTMENTS";
+    }
+    if (options->appointments > 0 && options->doctors == 0) return "appointments need at least one doctor";
+    if (options->today / 10000 < EARLIEST_YEAR || day_key(day_number(options->today)) != options->today) {
+        return "the date is not a valid DD-MM-YYYY date from 1900 on";
+    }
+
+    layout_plan(options);
+    if (working_day(layout.days - 1) < day_number(EARLIEST_YEAR * 10000 + 101)) {
+        return "too many appointments for the doctors: the history would start before 1900";
+    }
+    return NULL;
+}
+
+/* Checks the text fields of count records, stride bytes apart, with the batch validators. */
+static bool fields_valid(size_t (*check)(const char*, size_t, size_t, bool*), const char* first,
+                         size_t stride, int count) {
+    if (count == 0) return true;
+    bool* valid = malloc((size_t)count * sizeof(bool));
+    if (valid == NULL) return false;
+    size_t passed = check(first, stride, (size_t)count, valid);
+    free(valid);
+    return passed == (size_t)count;
+}
+
+static bool tables_valid(void) {
+    int p = patient_count, d = doctor_count, r = receptionist_count;
+    return fields_valid(validate_names, patients[0].name, sizeof(Patient), p) &&
+           fields_valid(validate_phones, patients[0].phone, sizeof(Patient), p) &&
+           fields_valid(validate_addresses, patients[0].address, sizeof(Patient), p) &&
+           fields_valid(validate_blood_groups, patients[0].blood_group, sizeof(Patient), p) &&
+           fields_valid(validate_names, doctors[0].name, sizeof(Doctor), d) &&
+           fields_valid(validate_phones, doctors[0].phone, sizeof(Doctor), d) &&
+           fields_valid(validate_emails, doctors[0].email, sizeof(Doctor), d) &&
+           fields_valid(validate_names, receptionists[0].name, sizeof(Receptionist), r) &&
+           fields_valid(validate_phones, receptionists[0].phone, sizeof(Receptionist), r) &&
+           fields_valid(validate_emails, receptionists[0].email, sizeof(Receptionist), r);
+}
+
+static void add_accounts(void) {
+    for (int i = 0; i < doctor_count; i++) {
+        User* u = &users[user_count++];
+        memset(u, 0, sizeof(*u));
+        u->id = doctors[i].id;
+        u->role = ROLE_DOCTOR;
+        u->is_active = true;
+        snprintf(u->username, USERNAME_SIZE, "dr%d", doctors[i].id);
+        snprintf(u->password, PASSWORD_SIZE, "%s", GENERATE_PASSWORD);
+        encrypt(u->password);
+    }
+    for (int i = 0; i < receptionist_count; i++) {
+        User* u = &users[user_count++];
+        memset(u, 0, sizeof(*u));
+        u->id = receptionists[i].id;
+        u->role = ROLE_RECEPTIONIST;
+        u->is_active = true;
+        snprintf(u->username, USERNAME_SIZE, "desk%d", receptionists[i].id);
+        snprintf(u->password, PASSWORD_SIZE, "%s", GENERATE_PASSWORD);
+        encrypt(u->password);
+    }
+}
+
+int generate_dataset(const GenerateOptions* options, GenerateStats* stats) {
+    config = *options;
+    layout_plan(options);
+    memset(stats, 0, sizeof(*stats));
+
+    fill_parallel(fill_patients, config.patients);
+    patient_count = config.patients;
+    patient_available = patient_unavailable = 0;
+    for (int i = 0; i < patient_count; i++) {
+        if (patients[i].is_active) patient_available++;
+        else patient_unavailable++;
+    }
+    stats->active = patient_available;
+
+    fill_doctors(0, config.doctors);
+    doctor_count = doctor_available = config.doctors;
+    doctor_unavailable = 0;
+    fill_receptionists(0, config.receptionists);
+    receptionist_count = receptionist_available = config.receptionists;
+    receptionist_unavailable = 0;
+    int existing_users = user_count;
+    add_accounts();
+    stats->users = user_count - existing_users;
+
+    fill_parallel(fill_appointments, config.appointments);
+    appointment_count = config.appointments;
+    appointment_rescan_ids();
+
+    if (!tables_valid()) return -1;
+
+    char summary[AUDIT_VALUE_SIZE];
+    snprintf(summary, sizeof(summary), "%d patients, %d appointments, seed %llu", config.patients,
+             config.appointments, (unsigned long long)config.seed);
+    audit_record(AUDIT_SYSTEM, 0, AUDIT_CREATE, "generate", NULL, summary);
+
+    // The writer saves one table while the next is encoded
+    storage_start_writer();
+    int result = 0;
+    if (patient_save_to_file() != 0 || doctor_save_to_file() != 0 ||
+        receptionist_save_to_file() != 0 || auth_save_to_file() != 0) {
+        result = -1;
+    }
+    // Closed months go to the history now rather than at the next start
+    if (!storage_is_remote()) {
+        stats->archived = appointment_archive_seal(options->today / 100);
+        if (stats->archived < 0) result = -1;
+    }
+    appointment_stats_rebuild();
+    if (appointment_save_to_file() != 0) result = -1;
+    if (storage_flush() != 0) result = -1;
+    return result;
+}
@@ -19,8 +19,15 @@
 #include "../include/patient.h"
 #include "../include/doctor.h"
 #include "../include/appointment.h"
+#include "../include/appointment_stats.h"
+#include "../include/appointment_archive.h"
+#include "../include/workload.h"
+#include "../include/reminder.h"
 #include "../include/receptionist.h"
 #include "../include/auth.h"
+#include "../include/storage.h"
+#include "../include/replica.h"
+#include "../include/cli.h"
 #include "../include/ui.h"
 #include "../include/utils.h"
 
@@ -47,7 +54,18 @@ User* current_user = NULL;
 void hospital_init(void) {
     patient_load_from_file();
     doctor_load_from_file();
+    receptionist_load_from_file();
     appointment_load_from_file();
+    appointment_archive_load_from_file();
+    // With a server running, sealing is left to the server that owns the files;
+    // a standby gets the primary's segments through the journal
+    if (!storage_is_remote() && !replica_is_standby() && appointment_archive_seal(utils_today_key() / 100) > 0) {
+        appointment_save_to_file();
+    }
+    appointment_stats_load_from_file();
+    workload_rebuild();
+    reminder_init(utils_now_minutes());
+    reminder_load_from_appointments();
     auth_load_from_file();
     auth_init_default_admin();
 }
@@ -79,8 +97,19 @@ void print_help(const char* program_name) {
     printf("  -v, --version   Show version information\n");
     printf("  -a, --about     Show about information\n");
     printf("  -l, --login     Go directly to login menu\n");
+    printf("  -s, --serve     Run as data server for other terminals\n");
+    printf("  --standby DIR   Replay the journal shipped to DIR as a hot standby\n");
+    printf("  --verify DIR    Compare the data files with the replica in DIR\n");
+    printf("  --replay FILE   Run the menus on the input in FILE and report timings\n");
+    printf("  --record FILE   Save everything typed in this session to FILE\n");
+    printf("  --stats ...     Time loads, saves, searches and logins; print them at exit\n");
     printf("\n");
-    printf("If no options are provided, the interactive menu will start.\n\n");
+    cli_print_usage(program_name);
+    printf("If no options are provided, the interactive menu will start.\n");
+    printf("Terminals started while a server is running share its data.\n");
+    printf("Set HMS_REPLICA=DIR to ship every save to a standby in DIR.\n");
+    printf("Set HMS_STATS=SECONDS to time operations and append them to logs/stats.log that often.\n");
+    printf("Set HMS_AUDIT_MB=N or HMS_AUDIT_DAYS=N to keep more or less of the rotated audit files.\n\n");
 }
 
 void print_version(void) {
@@ -92,7 +121,9 @@ void print_version(void) {
 void ensure_data_dir(void) {
     #ifdef _WIN32
         _mkdir("data");
+        _mkdir("logs");
     #else
         mkdir("data", 0755);
+        mkdir("logs", 0755);
     #endif
 }
@@ -0,0 +1,275 @@
+/**
+ * @file metrics.c
+ * @brief Operation timing implementation for Healthcare Management System
+ *
+ * A thread takes a counter set on its first recording and keeps a pointer
+ * to it in thread-local storage; sets are cache-line aligned, so threads
+ * only ever write lines of their own. Counters are relaxed atomics, which
+ * lets a report read them while they are being bumped and lets the threads
+ * past METRICS_THREADS share the last set. Latencies come from the
+ * monotonic clock (served from the vDSO on Linux) and land in bucket
+ * 64 - clz(ns), so one recording is two clock reads and a handful of adds.
+ *
+ * Snapshots are written by whichever thread first finishes an operation
+ * after the deadline, so no thread is started for them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/metrics.h"
+
+#ifdef _WIN32
+    #include <process.h>
+    #include <windows.h>
+#else
+    #include <stdatomic.h>
+    #include <unistd.h>
+#endif
+
+/* No threads on Windows record operations, so plain counters will do there */
+#ifdef _WIN32
+    typedef uint64_t Counter;
+    #define COUNTER_ADD(c, n)   (*(c) += (n))
+    #define COUNTER_GET(c)      (*(c))
+#else
+    typedef atomic_uint_fast64_t Counter;
+    #define COUNTER_ADD(c, n)   atomic_fetch_add_explicit((c), (n), memory_order_relaxed)
+    #define COUNTER_GET(c)      atomic_load_explicit((c), memory_order_relaxed)
+#endif
+
+typedef struct {
+    Counter calls;
+    Counter failures;
+    Counter total_ns;
+    Counter max_ns;
+    Counter buckets[METRICS_BUCKETS];
+} OpCounters;
+
+typedef struct {
+    _Alignas(64) OpCounters ops[METRIC_COUNT];
+} ThreadCounters;
+
+static const char* op_names[METRIC_COUNT] = {
+    "load.patients", "load.doctors", "load.receptionists", "load.users", "load.appointments",
+    "load.archive", "load.appt_stats",
+    "save.patients", "save.doctors", "save.receptionists", "save.users", "save.appointments",
+    "save.archive", "save.appt_stats",
+    "storage.write",
+    "search.patient_id", "search.patient_name", "search.patient_phone",
+    "search.doctor_id", "search.doctor_name", "search.doctor_phone",
+    "search.receptionist_id", "search.appointment_id",
+    "auth.login"
+};
+
+static ThreadCounters sets[METRICS_THREADS];
+static bool enabled = false;        /* Set before other threads start, read-only after */
+static bool report_at_exit = false;
+static uint64_t snapshot_interval = 0;     /* ns */
+static uint64_t started_at = 0;
+static Counter next_snapshot = 0;
+
+#ifdef _WIN32
+    static ThreadCounters* own = &sets[0];
+#else
+    static atomic_int sets_taken = 0;
+    static _Thread_local ThreadCounters* own = NULL;
+#endif
+
+static uint64_t now_ns(void) {
+    #ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    #endif
+}
+
+static ThreadCounters* own_set(void) {
+    #ifndef _WIN32
+        if (own == NULL) {
+            int index = atomic_fetch_add_explicit(&sets_taken, 1, memory_order_relaxed);
+            own = &sets[index < METRICS_THREADS ? index : METRICS_THREADS - 1];
+        }
+    #endif
+    return own;
+}
+
+static int bucket_of(uint64_t ns) {
+    int bucket = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+    return bucket < METRICS_BUCKETS ? bucket : METRICS_BUCKETS - 1;
+}
+
+static void max_update(Counter* max, uint64_t value) {
+    #ifdef _WIN32
+        if (value > *max) *max = value;
+    #else
+        uint64_t seen = COUNTER_GET(max);
+        while (value > seen &&
+               !atomic_compare_exchange_weak_explicit(max, &seen, value, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+        }
+    #endif
+}
+
+/* True for the one thread that moves the deadline past now */
+static bool snapshot_due(uint64_t now) {
+    if (snapshot_interval == 0) return false;
+    uint64_t deadline = COUNTER_GET(&next_snapshot);
+    if (now < deadline) return false;
+    #ifdef _WIN32
+        next_snapshot = now + snapshot_interval;
+        return true;
+    #else
+        return atomic_compare_exchange_strong_explicit(&next_snapshot, &deadline, now + snapshot_interval,
+                                                       memory_order_relaxed, memory_order_relaxed);
+    #endif
+}
+
+static void metrics_stop(void) {
+    metrics_snapshot();
+    if (report_at_exit) {
+        fprintf(stderr, "\nOperation statistics (latencies in microseconds):\n");
+        metrics_write(stderr);
+    }
+}
+
+/*
+ *==========================================================================
+ *                              RECORDING
+ *==========================================================================
+ */
+
+void metrics_start(bool report) {
+    report_at_exit = report_at_exit || report;
+    if (enabled) return;
+
+    const char* seconds = getenv("HMS_STATS");
+    long interval = seconds != NULL ? atol(seconds) : 0;
+    if (interval <= 0) interval = METRICS_SNAPSHOT_SECONDS;
+    snapshot_interval = (uint64_t)interval * 1000000000ULL;
+    started_at = now_ns();
+    next_snapshot = started_at + snapshot_interval;
+    enabled = true;
+    atexit(metrics_stop);
+}
+
+bool metrics_enabled(void) {
+    return enabled;
+}
+
+MetricsTimer metrics_begin(void) {
+    return enabled ? now_ns() : 0;
+}
+
+void metrics_end(MetricOp op, MetricsTimer timer, bool ok) {
+    if (timer == 0) return;
+    uint64_t now = now_ns();
+    uint64_t elapsed = now - timer;
+    OpCounters* counters = &own_set()->ops[op];
+
+    COUNTER_ADD(&counters->calls, 1);
+    if (!ok) COUNTER_ADD(&counters->failures, 1);
+    COUNTER_ADD(&counters->total_ns, elapsed);
+    COUNTER_ADD(&counters->buckets[bucket_of(elapsed)], 1);
+    max_update(&counters->max_ns, elapsed);
+
+    if (snapshot_due(now)) metrics_snapshot();
+}
+
+/*
+ *==========================================================================
+ *                              REPORTS
+ *==========================================================================
+ */
+
+void metrics_summary(MetricOp op, MetricsSummary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    for (int t = 0; t < METRICS_THREADS; t++) {
+        const OpCounters* counters = &sets[t].ops[op];
+        uint64_t calls = COUNTER_GET(&counters->calls);
+        if (calls == 0) continue;
+
+        summary->threads++;
+        summary->calls += calls;
+        summary->failures += COUNTER_GET(&counters->failures);
+        summary->total_ns += COUNTER_GET(&counters->total_ns);
+        uint64_t max = COUNTER_GET(&counters->max_ns);
+        if (max > summary->max_ns) summary->max_ns = max;
+        for (int b = 0; b < METRICS_BUCKETS; b++) {
+            summary->buckets[b] += COUNTER_GET(&counters->buckets[b]);
+        }
+    }
+}
+
+uint64_t metrics_percentile(const MetricsSummary* summary, int percent) {
+    uint64_t recorded = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) recorded += summary->buckets[b];
+    if (recorded == 0) return 0;
+
+    // The bucket holding the recording at rank ceil(recorded * percent / 100)
+    uint64_t rank = (recorded * (uint64_t)percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        seen += summary->buckets[b];
+        if (seen >= rank && seen > 0) {
+            uint64_t bound = b == 0 ? 0 : 1ULL << b;
+            return bound < summary->max_ns ? bound : summary->max_ns;
+        }
+    }
+    return summary->max_ns;
+}
+
+const char* metrics_name(MetricOp op) {
+    return (int)op >= 0 && op < METRIC_COUNT ? op_names[op] : "unknown";
+}
+
+int metrics_write(FILE* out) {
+    fprintf(out, "operation\tthreads\tcalls\tfailures\ttotal_ms\tavg_us\tp50_us\tp90_us\tp99_us\tmax_us\n");
+    for (int op = 0; op < METRIC_COUNT; op++) {
+        MetricsSummary s;
+        metrics_summary((MetricOp)op, &s);
+        if (s.calls == 0) continue;
+        fprintf(out, "%s\t%d\t%llu\t%llu\t%.3f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n", op_names[op], s.threads,
+                (unsigned long long)s.calls, (unsigned long long)s.failures, s.total_ns / 1e6,
+                s.total_ns / 1e3 / (double)s.calls, metrics_percentile(&s, 50) / 1e3,
+                metrics_percentile(&s, 90) / 1e3, metrics_percentile(&s, 99) / 1e3, s.max_ns / 1e3);
+    }
+    return ferror(out) ? -1 : 0;
+}
+
+int metrics_snapshot(void) {
+    if (!enabled) return -1;
+
+    FILE* file = fopen(STATS_FILE, "a");
+    if (file == NULL) return -1;
+    if (fseek(file, 0L, SEEK_END) == 0 && ftell(file) > METRICS_FILE_MAX) {
+        fclose(file);
+        remove(STATS_ROTATED_FILE);
+        rename(STATS_FILE, STATS_ROTATED_FILE);
+        file = fopen(STATS_FILE, "a");
+        if (file == NULL) return -1;
+    }
+
+    char stamp[32];
+    time_t now = time(NULL);
+    struct tm local;
+    #ifdef _WIN32
+        localtime_s(&local, &now);
+        int pid = _getpid();
+    #else
+        localtime_r(&now, &local);     /* Any thread may write the snapshot */
+        int pid = (int)getpid();
+    #endif
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    fprintf(file, "# %s pid %d uptime %.0f s\n", stamp, pid, (now_ns() - started_at) / 1e9);
+
+    int result = metrics_write(file);
+    if (fclose(file) != 0) result = -1;
+    return result;
+}
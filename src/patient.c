@@ -10,49 +10,100 @@
 #include "../include/patient.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
+#include "../include/shard.h"
 #include "../include/hospital.h"
 
 int patient_save_to_file(void) {
-    FILE* file = fopen(PATIENTS_FILE, "wb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fwrite(&patient_count, sizeof(int), 1, file) != 1 ||
-        fwrite(&patient_available, sizeof(int), 1, file) != 1 ||
-        fwrite(patients, sizeof(Patient), patient_count, file) != (size_t)patient_count) {
-        fclose(file);
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    // Shards whose records did not change are skipped by the storage layer
+    MetricsTimer timer = metrics_begin();
+    int result = 0;
+    for (int shard = 0; shard < PATIENT_SHARDS; shard++) {
+        if (storage_save(TABLE_PATIENTS + shard) != 0) result = -1;
+    }
+    metrics_end(METRIC_SAVE_PATIENTS, timer, result == 0);
+    return result;
 }
 
 int patient_load_from_file(void) {
-    FILE* file = fopen(PATIENTS_FILE, "rb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fread(&patient_count, sizeof(int), 1, file) != 1 ||
-        fread(&patient_available, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (patient_count < 0 || patient_count > MAX_PATIENTS) {
-        fclose(file);
-        patient_count = 0;
-        return -1;
+    MetricsTimer timer = metrics_begin();
+    int result = -1;
+    for (int shard = 0; shard < PATIENT_SHARDS; shard++) {
+        if (storage_load(TABLE_PATIENTS + shard) == 0) result = 0;
     }
-    if (fread(patients, sizeof(Patient), patient_count, file) != (size_t)patient_count) {
-        fclose(file);
-        patient_count = 0;
-        return -1;
+    metrics_end(METRIC_LOAD_PATIENTS, timer, result == 0);
+    return result;
+}
+
+static int found[MAX_PATIENTS];     /* Scan results, indices in ID order */
+
+static bool patient_is_active(const Patient* patient, const void* arg) {
+    (void)arg;
+    return patient->is_active;
+}
+
+static bool patient_is_discharged(const Patient* patient, const void* arg) {
+    (void)arg;
+    return !patient->is_active;
+}
+
+static bool patient_has_name(const Patient* patient, const void* name) {
+    return strcmp(patient->name, name) == 0;
+}
+
+static bool patient_has_phone(const Patient* patient, const void* phone) {
+    return strcmp(patient->phone, phone) == 0;
+}
+
+/* First patient with the name in ID order, asking the server when connected */
+static bool patient_find_name(const char* name, Patient* patient) {
+    if (storage_is_remote()) {
+        int matches = 0;
+        for (int shard = 0; shard < PATIENT_SHARDS && matches == 0; shard++) {
+            matches = storage_search(TABLE_PATIENTS + shard, name, patient, 1);
+        }
+        if (matches >= 0) return matches == 1;     /* Else unreachable: search what we have */
     }
-    fclose(file);
-    return 0;
+    if (shard_scan_patients(patient_has_name, name, found, 1) != 1) return false;
+    *patient = patients[found[0]];
+    return true;
 }
 
 int patient_generate_id(void) {
-    return PATIENT_ID_START + patient_count;
+    // Past the highest ID, so the table stays in ID order after deletions
+    return patient_count == 0 ? PATIENT_ID_START : patients[patient_count - 1].id + 1;
+}
+
+int patient_insert(Patient* patient) {
+    if (patient_count >= MAX_PATIENTS) return -1;
+
+    // A new ID is past every other, so appending keeps the array in ID order
+    patient->id = patient_generate_id();
+    patient->is_active = true;
+    patients[patient_count] = *patient;
+    patient_count++;
+    patient_available++;
+    audit_record(AUDIT_PATIENT, patient->id, AUDIT_CREATE, "name", NULL, patient->name);
+    return patient_count - 1;
+}
+
+void patient_set_discharged(int index) {
+    patients[index].is_active = false;
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_DEACTIVATE, "status", "Active", "Discharged");
+    patient_available--;
+    patient_unavailable++;
+}
+
+void patient_remove(int index) {
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_DELETE, "name", patients[index].name, NULL);
+    if (patients[index].is_active) patient_available--;
+    else patient_unavailable--;
+
+    // The patients after it move down one place, still in ID order
+    memmove(&patients[index], &patients[index + 1], (size_t)(patient_count - index - 1) * sizeof(Patient));
+    patient_count--;
 }
 
 void patient_add(void) {
@@ -186,10 +237,7 @@ void patient_add(void) {
         return;
     }
     
-    // Add to array
-    patients[patient_count] = new_patient;
-    patient_count++;
-    patient_available++;
+    patient_insert(&new_patient);
     
     ui_clear_screen();
     ui_print_banner();
@@ -221,11 +269,12 @@ void patient_view_all() {
         return;
     }
 
-    for (int i = 0; i < patient_count; i++) {
-        if (patients[i].is_active) {
-            ui_print_patient(patients[i], count++);
-        }
+    int matches = shard_scan_patients(patient_is_active, NULL, found, MAX_PATIENTS);
+    ui_list_begin("All Patients");
+    for (int i = 0; i < matches; i++) {
+        ui_list_patient(patients[found[i]], count++);
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -242,13 +291,12 @@ void patient_view_one() {
         return;
     }
     
-    for (int i = 0; i < patient_count; i++) {
+    int matches = shard_scan_patients(patient_is_active, NULL, found, MAX_PATIENTS);
+    for (int i = 0; i < matches; i++) {
         ui_clear_screen();
         ui_print_banner();
-        if (patients[i].is_active) {
-            ui_print_patient(patients[i], count++);
-            ui_pause();
-        }
+        ui_print_patient(patients[found[i]], count++);
+        ui_pause();
     }
 }
 
@@ -308,15 +356,14 @@ void patient_search_by_id(void) {
             ui_pause();
             continue;
         }
-        for (int i = 0; i < patient_count; i++) {
-            if (patients[i].id == id) {
-                ui_clear_screen();
-                ui_print_banner();
-                
-                ui_print_patient(patients[i], (patients[i].id - 1001));
-                ui_pause();
-                return;
-            }
+        int i = patient_search_id(id);
+        if (i != -1) {
+            ui_clear_screen();
+            ui_print_banner();
+
+            ui_print_patient(patients[i], (patients[i].id - 1001));
+            ui_pause();
+            return;
         }
         ui_print_error("Patient not found!");
         ui_pause();
@@ -347,15 +394,17 @@ void patient_search_by_name(void) {
         }
 
         utils_fix_name(name);
-        for (int i = 0; i < patient_count; i++) {
-            if (strcmp(patients[i].name, name) == 0) {
-                ui_clear_screen();
-                ui_print_banner();
-                
-                ui_print_patient(patients[i], (patients[i].id - 1001));
-                ui_pause();
-                return;
-            }
+        MetricsTimer timer = metrics_begin();
+        Patient patient;
+        bool match = patient_find_name(name, &patient);
+        metrics_end(METRIC_SEARCH_PATIENT_NAME, timer, match);
+        if (match) {
+            ui_clear_screen();
+            ui_print_banner();
+
+            ui_print_patient(patient, (patient.id - 1001));
+            ui_pause();
+            return;
         }
         ui_print_error("Patient not found!");
         ui_pause();
@@ -383,15 +432,16 @@ void patient_search_by_phone(void) {
             ui_pause();
             continue;
         }
-        for (int i = 0; i < patient_count; i++) {
-            if (strcmp(patients[i].phone, phone) == 0) {
-                ui_clear_screen();
-                ui_print_banner();
-
-                ui_print_patient(patients[i], (patients[i].id - 1001));
-                ui_pause();
-                return;
-            }
+        MetricsTimer timer = metrics_begin();
+        bool match = shard_scan_patients(patient_has_phone, phone, found, 1) == 1;
+        metrics_end(METRIC_SEARCH_PATIENT_PHONE, timer, match);
+        if (match) {
+            ui_clear_screen();
+            ui_print_banner();
+
+            ui_print_patient(patients[found[0]], (patients[found[0]].id - 1001));
+            ui_pause();
+            return;
         }
         ui_print_error("Patient not found!");
         ui_pause();
@@ -439,12 +489,10 @@ void patient_search_by(void) {
 }
 
 int patient_search_id (int id) {
-    for (int i = 0; i < patient_count; i++) {
-        if (patients[i].id == id) {
-            return i;
-        }
-    }
-    return -1;
+    MetricsTimer timer = metrics_begin();
+    int index = shard_find_patient(id);
+    metrics_end(METRIC_SEARCH_PATIENT_ID, timer, index != -1);
+    return index;
 }
 
 void patient_update_name(const char* menu_items[], int index) {
@@ -467,6 +515,7 @@ void patient_update_name(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "name", patients[index].name, name);
     patients[index].name[0] = '\0';
     strncpy(patients[index].name, name, NAME_SIZE);
 }
@@ -490,6 +539,7 @@ void patient_update_phone(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "phone", patients[index].phone, phone);
     patients[index].phone[0] = '\0';
     strncpy(patients[index].phone, phone, PHONE_SIZE);
 }
@@ -513,6 +563,7 @@ void patient_update_address(const char* menu_items[], int index) {
         ui_pause();
         return;
     }
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "address", patients[index].address, address);
     patients[index].address[0] = '\0';
     strncpy(patients[index].address, address, ADDRESS_SIZE);
 }
@@ -537,6 +588,7 @@ void patient_update_blood_group(const char* menu_items[], int index) {
         return;
     }
     utils_str_to_upper(blood_group);
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "blood_group", patients[index].blood_group, blood_group);
     patients[index].blood_group[0] = '\0';
     strncpy(patients[index].blood_group, blood_group, BLOOD_SIZE);
 }
@@ -561,11 +613,10 @@ void patient_update_gender(const char* menu_items[], int index) {
         ui_print_error("Invalid gender!");
         ui_pause();
     }
-    if (gender_input == 'M' || gender_input == 'm') {
-        patients[index].gender = MALE;
-    } else if (gender_input == 'F' || gender_input == 'f') {
-        patients[index].gender = FEMALE;
-    }
+    Gender gender = (gender_input == 'M' || gender_input == 'm') ? MALE : FEMALE;
+    audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "gender",
+                 patients[index].gender == MALE ? "Male" : "Female", gender == MALE ? "Male" : "Female");
+    patients[index].gender = gender;
 }
 
 void patient_update_status(const char* menu_items[], int index) {
@@ -578,17 +629,19 @@ void patient_update_status(const char* menu_items[], int index) {
         ">> "
     };
     
-    bool status;
     int input;
     ui_print_menu("Update Patient", menu, 3, UI_SIZE);
     input = utils_get_int();
 
-    if (input == 1) {
-        status = true;
-    } else if (input == 2) {
-        status = false;
+    if (input == 1 || input == 2) {
+        bool status = input == 1;
+        audit_record(AUDIT_PATIENT, patients[index].id, AUDIT_UPDATE, "status",
+                     patients[index].is_active ? "Active" : "Discharged", status ? "Active" : "Discharged");
+        patients[index].is_active = status;
+    } else {
+        ui_print_error("Invalid input! Could not update.");
+        ui_pause();
     }
-    patients[index].is_active = status;
 }
 
 void patient_update_using_id() {
@@ -621,6 +674,8 @@ void patient_update_using_id() {
         }
     } while (1);
 
+    // Edit the record as it is now, not as this terminal last saw it
+    storage_refresh_record(TABLE_PATIENTS + shard_of_patient(id), id);
     int index = patient_search_id(id);
     if (index == -1) return;
 
@@ -739,10 +794,8 @@ void patient_discharge() {
     int input = utils_get_int();
 
     if (input == 1) {
-        patients[index].is_active = false;
+        patient_set_discharged(index);
         ui_print_success("Patient discharged successfully!");
-        patient_available--;
-        patient_unavailable++;
         ui_pause();
     } else {
         ui_print_info("Discharge cancelled.");
@@ -762,10 +815,11 @@ void patient_view_discharged(void) {
         return;
     }
 
-    for (int i = 0; i < patient_count; i++) {
-        if (!patients[i].is_active) {
-            ui_print_patient(patients[i], count++);
-        }
+    int matches = shard_scan_patients(patient_is_discharged, NULL, found, MAX_PATIENTS);
+    ui_list_begin("Discharged Patients");
+    for (int i = 0; i < matches; i++) {
+        ui_list_patient(patients[found[i]], count++);
     }
+    ui_list_end();
     ui_pause();
 }
\ No newline at end of file
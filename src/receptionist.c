@@ -9,14 +9,20 @@
 #include "../include/patient.h"
 #include "../include/doctor.h"
 #include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/reminder.h"
 #include "../include/utils.h"
 #include "../include/ui.h"
+#include "../include/audit.h"
+#include "../include/storage.h"
+#include "../include/metrics.h"
 #include "../include/hospital.h"
 
 void receptionist_patient_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
@@ -71,17 +77,19 @@ void receptionist_appointment_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
         
         const char* menu_items[] = {
             "Create Appointment",
             "View All Appointments",
+            "View Appointment History",
             "Back",
             ">> "
         };
         
-        ui_print_menu("Appointment Management", menu_items, 4, UI_SIZE);
+        ui_print_menu("Appointment Management", menu_items, 5, UI_SIZE);
         choice = utils_get_int();
         
         switch (choice) {
@@ -91,9 +99,11 @@ void receptionist_appointment_menu(void) {
             case 2:
                 ui_clear_screen();
                 ui_print_banner();
+                ui_list_begin("All Appointments");
                 for (int i = 0; i < appointment_count; i++) {
-                    ui_print_appointment(appointments[i], i);
+                    ui_list_appointment(appointments[i], i);
                 }
+                ui_list_end();
                 if (appointment_count == 0) {
                     const char* no_appt[] = {"No appointments found!"};
                     ui_print_menu("All Appointments", no_appt, 1, UI_SIZE);
@@ -101,6 +111,9 @@ void receptionist_appointment_menu(void) {
                 ui_pause();
                 break;
             case 3:
+                appointment_view_history(0);
+                break;
+            case 4:
                 ui_print_info("Returning to receptionist menu...");
                 ui_pause();
                 break;
@@ -108,15 +121,18 @@ void receptionist_appointment_menu(void) {
                 ui_print_error("Invalid choice!");
                 ui_pause();
         }
-    } while (choice != 3);
+    } while (choice != 4);
 }
 
 void receptionist_menu(void) {
     int choice;
     
     do {
+        storage_sync();
         ui_clear_screen();
         ui_print_banner();
+        reminder_poll(utils_now_minutes());
+        reminder_print_unseen(0);
         
         const char* menu_items[] = {
             "Patient Management",
@@ -153,51 +169,30 @@ void receptionist_menu(void) {
  */
 
 int receptionist_save_to_file(void) {
-    FILE* file = fopen(RECEPTIONISTS_FILE, "wb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fwrite(&receptionist_count, sizeof(int), 1, file) != 1 ||
-        fwrite(&receptionist_available, sizeof(int), 1, file) != 1 ||
-        fwrite(receptionists, sizeof(Receptionist), receptionist_count, file) != (size_t)receptionist_count) {
-        fclose(file);
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_save(TABLE_RECEPTIONISTS);
+    metrics_end(METRIC_SAVE_RECEPTIONISTS, timer, result == 0);
+    return result;
 }
 
 int receptionist_load_from_file(void) {
-    FILE* file = fopen(RECEPTIONISTS_FILE, "rb");
-    if (file == NULL) {
-        return -1;
-    }
-    if (fread(&receptionist_count, sizeof(int), 1, file) != 1 ||
-        fread(&receptionist_available, sizeof(int), 1, file) != 1) {
-        fclose(file);
-        return -1;
-    }
-    if (receptionist_count < 0 || receptionist_count > MAX_RECEPTIONISTS) {
-        fclose(file);
-        receptionist_count = 0;
-        return -1;
-    }
-    if (fread(receptionists, sizeof(Receptionist), receptionist_count, file) != (size_t)receptionist_count) {
-        fclose(file);
-        receptionist_count = 0;
-        return -1;
-    }
-    fclose(file);
-    return 0;
+    MetricsTimer timer = metrics_begin();
+    int result = storage_load(TABLE_RECEPTIONISTS);
+    metrics_end(METRIC_LOAD_RECEPTIONISTS, timer, result == 0);
+    return result;
 }
 
 int receptionist_search_id(int id) {
+    MetricsTimer timer = metrics_begin();
+    int index = -1;
     for (int i = 0; i < receptionist_count; i++) {
         if (receptionists[i].id == id) {
-            return i;
+            index = i;
+            break;
         }
     }
-    return -1;
+    metrics_end(METRIC_SEARCH_RECEPTIONIST_ID, timer, index != -1);
+    return index;
 }
 
 void receptionist_view_all(void) {
@@ -212,11 +207,13 @@ void receptionist_view_all(void) {
         return;
     }
 
+    ui_list_begin("All Receptionists");
     for (int i = 0; i < receptionist_count; i++) {
         if (receptionists[i].is_active) {
-            ui_print_receptionist(receptionists[i], count++);
+            ui_list_receptionist(receptionists[i], count++);
         }
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -232,11 +229,13 @@ void receptionist_view_discharged(void) {
         return;
     }
 
+    ui_list_begin("Inactive Receptionists");
     for (int i = 0; i < receptionist_count; i++) {
         if (!receptionists[i].is_active) {
-            ui_print_receptionist(receptionists[i], count++);
+            ui_list_receptionist(receptionists[i], count++);
         }
     }
+    ui_list_end();
     ui_pause();
 }
 
@@ -290,6 +289,7 @@ void receptionist_discharge(void) {
 
     if (input == 1) {
         receptionists[index].is_active = false;
+        audit_record(AUDIT_RECEPTIONIST, receptionists[index].id, AUDIT_DEACTIVATE, "status", "Active", "Inactive");
         ui_print_success("Receptionist deactivated successfully!");
         receptionist_available--;
         receptionist_unavailable++;
@@ -0,0 +1,396 @@
+/**
+ * @file reminder.c
+ * @brief Appointment reminder engine implementation for Healthcare Management System
+ *
+ * The wheel has four levels of 64 slots. Level 0 holds reminders due in the
+ * next 64 minutes, level 1 the next 64 * 64 minutes and so on; a slot of a
+ * higher level is cascaded down when the lower level wraps. Every slot is a
+ * circular doubly linked list with a sentinel node, and reminder nodes come
+ * from a fixed pool, so insert and cancel never allocate or search a list.
+ * An appointment-ID hash table maps each appointment to its (at most two)
+ * reminder nodes for O(1) cancellation. Loading the appointments skips
+ * every reminder expiring at or before the fired-up-to minute, which the
+ * process that writes the outbox saves whenever it fires any.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../include/reminder.h"
+#include "../include/appointment.h"
+#include "../include/utils.h"
+#include "../include/ui.h"
+#include "../include/storage.h"
+#include "../include/hospital.h"
+
+#define WHEEL_BITS      6
+#define WHEEL_SIZE      (1 << WHEEL_BITS)
+#define WHEEL_MASK      (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS    4
+#define WHEEL_HEADS     (WHEEL_LEVELS * WHEEL_SIZE)
+#define WHEEL_SPAN      (1 << (WHEEL_BITS * WHEEL_LEVELS))
+
+#define LINK_SLOTS      REMINDER_CAPACITY   /* At most two nodes per appointment */
+
+typedef struct {
+    int expires;        /* Minute the reminder fires */
+    int appt_id;
+    int prev;
+    int next;
+    ReminderKind kind;
+} ReminderNode;
+
+typedef struct {
+    int appt_id;        /* 0 when the slot is empty */
+    int node[2];        /* Indexed by ReminderKind, 0 if none */
+} ReminderLink;
+
+/* Nodes 0..WHEEL_HEADS-1 are the slot sentinels */
+static ReminderNode nodes[WHEEL_HEADS + REMINDER_CAPACITY];
+static ReminderLink links[LINK_SLOTS];
+static int free_head = 0;
+static int scheduled = 0;
+static int wheel_now = 0;       /* Last minute processed */
+static int fired_through = -1;  /* Reminders up to this minute were fired, here or before a restart; -1 until read */
+
+static Reminder recent[REMINDER_RECENT];
+static int recent_next = 0;
+static int recent_count = 0;
+
+/*
+ *==========================================================================
+ *                              NODE LISTS
+ *==========================================================================
+ */
+
+static void list_unlink(int n) {
+    nodes[nodes[n].prev].next = nodes[n].next;
+    nodes[nodes[n].next].prev = nodes[n].prev;
+}
+
+static void list_append(int head, int n) {
+    nodes[n].prev = nodes[head].prev;
+    nodes[n].next = head;
+    nodes[nodes[head].prev].next = n;
+    nodes[head].prev = n;
+}
+
+/* Picks the slot for a reminder; base is the first minute not yet processed. */
+static int wheel_slot_for(int expires, int base) {
+    if (expires < base) expires = base;
+
+    int delta = expires - base;
+    if (delta >= WHEEL_SPAN) {
+        // Park far-future reminders in the furthest level-3 slot; they cascade back here
+        expires = base + WHEEL_SPAN - (1 << (WHEEL_BITS * 3));
+        delta = expires - base;
+    }
+
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        if (delta < (1 << (WHEEL_BITS * (level + 1)))) {
+            return level * WHEEL_SIZE + ((expires >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        }
+    }
+    return WHEEL_HEADS - 1;
+}
+
+static void wheel_insert(int n, int base) {
+    list_append(wheel_slot_for(nodes[n].expires, base), n);
+}
+
+/*
+ *==========================================================================
+ *                          APPOINTMENT ID MAP
+ *==========================================================================
+ */
+
+static unsigned int link_hash(int appt_id) {
+    return ((unsigned int)appt_id * 2654435761u) & (LINK_SLOTS - 1);
+}
+
+static ReminderLink* link_find(int appt_id, bool create) {
+    unsigned int slot = link_hash(appt_id);
+    for (int probe = 0; probe < LINK_SLOTS; probe++) {
+        if (links[slot].appt_id == appt_id) return &links[slot];
+        if (links[slot].appt_id == 0) {
+            if (!create) return NULL;
+            links[slot].appt_id = appt_id;
+            links[slot].node[0] = links[slot].node[1] = 0;
+            return &links[slot];
+        }
+        slot = (slot + 1) & (LINK_SLOTS - 1);
+    }
+    return NULL;
+}
+
+/* Linear-probing delete with backward shift, so no tombstones pile up. */
+static void link_remove(ReminderLink* link) {
+    unsigned int hole = (unsigned int)(link - links);
+    unsigned int slot = hole;
+
+    while (1) {
+        slot = (slot + 1) & (LINK_SLOTS - 1);
+        if (links[slot].appt_id == 0) break;
+
+        unsigned int home = link_hash(links[slot].appt_id);
+        bool movable = (hole <= slot) ? (home <= hole || home > slot)
+                                      : (home <= hole && home > slot);
+        if (movable) {
+            links[hole] = links[slot];
+            hole = slot;
+        }
+    }
+    links[hole].appt_id = 0;
+}
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+static int mark_load(void) {
+    FILE* file = fopen(REMINDERS_MARK_FILE, "r");
+    int minute = 0;
+    if (file != NULL) {
+        if (fscanf(file, "%d", &minute) != 1) minute = 0;
+        fclose(file);
+    }
+    return minute;
+}
+
+static void mark_save(void) {
+    FILE* file = fopen(REMINDERS_MARK_FILE, "w");
+    if (file != NULL) {
+        fprintf(file, "%d\n", fired_through);
+        fclose(file);
+    }
+}
+
+void reminder_init(int now_minute) {
+    if (fired_through < 0) {
+        fired_through = mark_load();
+        recent_next = recent_count = 0;
+    }
+
+    for (int h = 0; h < WHEEL_HEADS; h++) {
+        nodes[h].prev = nodes[h].next = h;
+    }
+    // Free list threaded through next
+    for (int n = WHEEL_HEADS; n < WHEEL_HEADS + REMINDER_CAPACITY - 1; n++) {
+        nodes[n].next = n + 1;
+    }
+    nodes[WHEEL_HEADS + REMINDER_CAPACITY - 1].next = 0;
+    free_head = WHEEL_HEADS;
+
+    memset(links, 0, sizeof(links));
+    scheduled = 0;
+    wheel_now = now_minute - 1;
+}
+
+static int schedule_after(const Appointment* appt, int after);
+
+void reminder_load_from_appointments(void) {
+    for (int i = 0; i < appointment_count; i++) {
+        schedule_after(&appointments[i], fired_through);
+    }
+}
+
+static int node_alloc(void) {
+    int n = free_head;
+    if (n != 0) {
+        free_head = nodes[n].next;
+        scheduled++;
+    }
+    return n;
+}
+
+static void node_free(int n) {
+    nodes[n].next = free_head;
+    free_head = n;
+    scheduled--;
+}
+
+void reminder_cancel(int appt_id) {
+    ReminderLink* link = link_find(appt_id, false);
+    if (link == NULL) return;
+
+    for (int k = 0; k < 2; k++) {
+        if (link->node[k] != 0) {
+            list_unlink(link->node[k]);
+            node_free(link->node[k]);
+        }
+    }
+    link_remove(link);
+}
+
+static int schedule_one(ReminderLink* link, const Appointment* appt, ReminderKind kind, int expires, int after) {
+    if (expires <= after) return 0;     /* Fired already */
+
+    int n = node_alloc();
+    if (n == 0) return -1;
+
+    nodes[n].expires = expires;
+    nodes[n].appt_id = appt->id;
+    nodes[n].kind = kind;
+    wheel_insert(n, wheel_now + 1);
+    link->node[kind] = n;
+    return 0;
+}
+
+/* Schedules an appointment's reminders that expire after minute `after`. */
+static int schedule_after(const Appointment* appt, int after) {
+    reminder_cancel(appt->id);
+    if (appt->status != APPT_PENDING && appt->status != APPT_CONFIRMED) return 0;
+
+    int at = utils_epoch_minutes(utils_date_key(appt->date), utils_time_minutes(appt->time_slot));
+    if (at < 0) return -1;
+
+    ReminderLink* link = link_find(appt->id, true);
+    if (link == NULL) return -1;
+
+    int result = 0;
+    if (at > wheel_now) {
+        result |= schedule_one(link, appt, REMINDER_DUE_SOON, at - REMINDER_LEAD_MINUTES, after);
+    }
+    result |= schedule_one(link, appt, REMINDER_OVERDUE, at + REMINDER_GRACE_MINUTES, after);
+
+    if (link->node[0] == 0 && link->node[1] == 0) link_remove(link);
+    return result == 0 ? 0 : -1;
+}
+
+int reminder_schedule(const Appointment* appt) {
+    // A booking or change is new, so even its past reminders fire once
+    return schedule_after(appt, INT_MIN);
+}
+
+int reminder_reschedule(const Appointment* appt) {
+    return schedule_after(appt, fired_through);
+}
+
+int reminder_scheduled_count(void) {
+    return scheduled;
+}
+
+/* Moves every node of a higher-level slot down to where it now belongs. */
+static void cascade(int head) {
+    int n = nodes[head].next;
+    nodes[head].prev = nodes[head].next = head;
+
+    while (n != head) {
+        int next = nodes[n].next;
+        wheel_insert(n, wheel_now);
+        n = next;
+    }
+}
+
+static void fire(int n, FILE** outbox) {
+    ReminderLink* link = link_find(nodes[n].appt_id, false);
+    if (link != NULL) {
+        link->node[nodes[n].kind] = 0;
+        if (link->node[0] == 0 && link->node[1] == 0) link_remove(link);
+    }
+
+    int idx = appointment_search_id(nodes[n].appt_id);
+    if (idx == -1 || (appointments[idx].status != APPT_PENDING &&
+                      appointments[idx].status != APPT_CONFIRMED)) {
+        return;
+    }
+
+    Reminder* r = &recent[recent_next];
+    recent_next = (recent_next + 1) % REMINDER_RECENT;
+    if (recent_count < REMINDER_RECENT) recent_count++;
+
+    r->kind = nodes[n].kind;
+    r->appt_id = appointments[idx].id;
+    r->patient_id = appointments[idx].patient_id;
+    r->doctor_id = appointments[idx].doctor_id;
+    strncpy(r->date, appointments[idx].date, DATE_SIZE);
+    strncpy(r->time_slot, appointments[idx].time_slot, TIME_SIZE);
+    r->seen_by_doctor = r->seen_by_desk = false;
+
+    // The server (or a standalone terminal) writes the outbox, not every client
+    if (storage_is_remote()) return;
+
+    if (*outbox == NULL) {
+        *outbox = fopen(REMINDERS_FILE, "a");
+    }
+    if (*outbox != NULL) {
+        time_t fired_at = (time_t)nodes[n].expires * 60;
+        char stamp[20];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", localtime(&fired_at));
+        fprintf(*outbox, "%s %s appointment=%d patient=%d doctor=%d at=%s %s\n",
+                stamp, r->kind == REMINDER_DUE_SOON ? "DUE_SOON" : "OVERDUE",
+                r->appt_id, r->patient_id, r->doctor_id, r->date, r->time_slot);
+    }
+}
+
+int reminder_poll(int now_minute) {
+    FILE* outbox = NULL;
+    int fired = 0;
+
+    // An idle wheel can jump straight to now
+    if (scheduled == 0 && now_minute > wheel_now) {
+        wheel_now = now_minute;
+    }
+
+    while (wheel_now < now_minute) {
+        wheel_now++;
+
+        // Lower level wrapped: pull the next slot of each higher level down
+        for (int level = 1; level < WHEEL_LEVELS; level++) {
+            if ((wheel_now & ((1 << (WHEEL_BITS * level)) - 1)) != 0) break;
+            cascade(level * WHEEL_SIZE + ((wheel_now >> (WHEEL_BITS * level)) & WHEEL_MASK));
+        }
+
+        int head = wheel_now & WHEEL_MASK;
+        int n = nodes[head].next;
+        nodes[head].prev = nodes[head].next = head;
+
+        while (n != head) {
+            int next = nodes[n].next;
+            if (nodes[n].expires > wheel_now) {
+                wheel_insert(n, wheel_now + 1);    /* Parked far-future reminder */
+            } else {
+                fire(n, &outbox);
+                node_free(n);
+                fired++;
+            }
+            n = next;
+        }
+    }
+
+    if (wheel_now > fired_through) fired_through = wheel_now;
+    if (outbox != NULL) {
+        fclose(outbox);
+        mark_save();
+    }
+    return fired;
+}
+
+int reminder_print_unseen(int doctor_id) {
+    char lines[REMINDER_RECENT][90];
+    const char* items[REMINDER_RECENT + 1];
+    int count = 0;
+
+    // Newest first
+    for (int k = 1; k <= recent_count; k++) {
+        Reminder* r = &recent[(recent_next - k + REMINDER_RECENT) % REMINDER_RECENT];
+        bool* seen = doctor_id == 0 ? &r->seen_by_desk : &r->seen_by_doctor;
+        if (*seen || (doctor_id != 0 && r->doctor_id != doctor_id)) continue;
+
+        snprintf(lines[count], sizeof(lines[count]), "%s: Appointment %d, patient %d, %s %s",
+                 r->kind == REMINDER_DUE_SOON ? "Due soon" : "Overdue",
+                 r->appt_id, r->patient_id, r->date, r->time_slot);
+        items[count] = lines[count];
+        count++;
+        *seen = true;
+    }
+
+    if (count > 0) {
+        items[count] = "";
+        ui_print_menu("Reminders", items, count + 1, UI_SIZE);
+    }
+    return count;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file replay.c
+ * @brief Scripted session replay implementation for Healthcare Management System
+ *
+ * The script is the input source of the utils_get_* functions, so the
+ * menus run exactly as they do for a user. An operation's time is taken
+ * when the menus ask for the first line after its "@" line and again when
+ * they ask for the first line after the next one: it covers everything
+ * the program did in between, rendering and saving included. Saves the
+ * background writer still has queued at the end are timed as "(flush)".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/replay.h"
+#include "../include/storage.h"
+#include "../include/ui.h"
+#include "../include/utils.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define NULL_DEVICE "NUL"
+#else
+    #define NULL_DEVICE "/dev/null"
+#endif
+
+typedef struct {
+    char name[REPLAY_NAME_SIZE];
+    double* samples;        /* Microseconds */
+    int count;
+    int capacity;
+} Operation;
+
+static Operation operations[REPLAY_MAX_OPERATIONS];
+static int operation_count;
+static int running = -1;            /* Operation being timed */
+static double running_since;
+
+static FILE* script;
+static char script_path[256];
+static long lines_read;
+static double replay_started;
+static bool reported;
+
+static FILE* record;
+
+static double now_us(void) {
+    #ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double)counter.QuadPart * 1e6 / (double)frequency.QuadPart;
+    #else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+    #endif
+}
+
+/*
+ *==========================================================================
+ *                              OPERATIONS
+ *==========================================================================
+ */
+
+static int operation_find(const char* name) {
+    for (int i = 0; i < operation_count; i++) {
+        if (strcmp(operations[i].name, name) == 0) return i;
+    }
+    if (operation_count == REPLAY_MAX_OPERATIONS) return -1;
+
+    Operation* op = &operations[operation_count];
+    snprintf(op->name, sizeof(op->name), "%s", name);
+    return operation_count++;
+}
+
+static void operation_end(double now) {
+    if (running < 0) return;
+    Operation* op = &operations[running];
+    running = -1;
+
+    if (op->count == op->capacity) {
+        int capacity = op->capacity == 0 ? 256 : op->capacity * 2;
+        double* grown = realloc(op->samples, (size_t)capacity * sizeof(double));
+        if (grown == NULL) return;
+        op->samples = grown;
+        op->capacity = capacity;
+    }
+    op->samples[op->count++] = now - running_since;
+}
+
+static void operation_start(const char* name, double now) {
+    operation_end(now);
+    running = operation_find(name);
+    running_since = now;
+}
+
+static int compare_samples(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const Operation* op, int p) {
+    int rank = (op->count * p + 99) / 100;
+    return op->samples[rank > 0 ? rank - 1 : 0];
+}
+
+static void report(double elapsed) {
+    fprintf(stderr, "Replayed %s: %ld input lines in %.1f ms\n", script_path, lines_read, elapsed / 1e3);
+    fprintf(stderr, "%-22s %7s %11s %10s %10s %10s %10s\n",
+            "operation", "count", "total ms", "p50 us", "p90 us", "p99 us", "max us");
+
+    for (int i = 0; i < operation_count; i++) {
+        Operation* op = &operations[i];
+        if (op->count == 0) continue;
+        qsort(op->samples, (size_t)op->count, sizeof(double), compare_samples);
+        double total = 0;
+        for (int s = 0; s < op->count; s++) total += op->samples[s];
+        fprintf(stderr, "%-22s %7d %11.1f %10.0f %10.0f %10.0f %10.0f\n", op->name, op->count,
+                total / 1e3, percentile(op, 50), percentile(op, 90), percentile(op, 99),
+                op->samples[op->count - 1]);
+    }
+}
+
+/*
+ *==========================================================================
+ *                              INPUT SOURCES
+ *==========================================================================
+ */
+
+/* Reads the next script line, cut to size; false at the end. */
+static bool script_line(char* line, size_t size) {
+    if (fgets(line, (int)size, script) == NULL) return false;
+    size_t length = strcspn(line, "\r\n");
+    if (line[length] == '\0' && length + 1 == size) {
+        int c;
+        while ((c = getc(script)) != '\n' && c != EOF);
+    }
+    line[length] = '\0';
+    return true;
+}
+
+static int script_read_line(void* context, char* buffer, size_t size) {
+    (void)context;
+    char line[UTILS_LINE_SIZE];
+
+    while (!reported && script_line(line, sizeof(line))) {
+        if (line[0] == '#') continue;
+        if (line[0] == '@') {
+            const char* name = line + 1;
+            while (*name == ' ' || *name == '\t') name++;
+            operation_start(name, now_us());
+            continue;
+        }
+        lines_read++;
+        snprintf(buffer, size, "%s", line[0] == '\\' ? line + 1 : line);
+        return (int)strlen(buffer);
+    }
+    replay_finish();
+    return -1;
+}
+
+static const InputSource script_source = { script_read_line, NULL };
+
+static int record_read_line(void* context, char* buffer, size_t size) {
+    int length = utils_stdin_read_line(context, buffer, size);
+    if (length < 0) return -1;
+    if (buffer[0] == '#' || buffer[0] == '@' || buffer[0] == '\\') fputc('\\', record);
+    fprintf(record, "%s\n", buffer);
+    fflush(record);     // A session that crashes is still recorded up to the crash
+    return length;
+}
+
+static const InputSource record_source = { record_read_line, NULL };
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+int replay_open(const char* path) {
+    script = fopen(path, "r");
+    if (script == NULL) return -1;
+    snprintf(script_path, sizeof(script_path), "%s", path);
+
+    utils_set_input(&script_source);
+    ui_sink_select(UI_SINK_NULL);
+    fflush(stdout);
+    if (freopen(NULL_DEVICE, "w", stdout) == NULL) {
+        fprintf(stderr, "hms: the menus' own output could not be discarded\n");
+    }
+    replay_started = now_us();
+    return 0;
+}
+
+void replay_finish(void) {
+    if (script == NULL || reported) return;
+    reported = true;
+
+    double now = now_us();
+    operation_end(now);
+    operation_start("(flush)", now);
+    storage_flush();
+    operation_end(now_us());
+
+    long unread = 0;
+    char line[UTILS_LINE_SIZE];
+    while (script_line(line, sizeof(line))) {
+        if (line[0] != '#' && line[0] != '@') unread++;
+    }
+    fclose(script);
+    script = NULL;
+
+    report(now_us() - replay_started);
+    if (unread > 0) {
+        fprintf(stderr, "The session ended with %ld script lines unread.\n", unread);
+    }
+}
+
+int replay_record(const char* path) {
+    record = fopen(path, "w");
+    if (record == NULL) return -1;
+
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&now));
+    fprintf(record, "# Recorded %s. Add \"@ NAME\" lines to time operations separately.\n", date);
+    fprintf(record, "@ session\n");
+    fflush(record);
+
+    utils_set_input(&record_source);
+    return 0;
+}
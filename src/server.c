@@ -0,0 +1,454 @@
+/**
+ * @file server.c
+ * @brief Multi-terminal data server implementation for Healthcare Management System
+ *
+ * Every connected terminal is served by its own thread. Fetches, gets
+ * and searches are answered from a pinned snapshot of the table, so a slow
+ * reader never holds up a change and never sees one half applied. Record
+ * changes are serialised by the writer lock: each is applied to its one
+ * record in memory (and to what is derived from it), written through to
+ * the data files by the owning module's save function, and only then
+ * published as the next version, a copy of the current image with that
+ * record changed. A change that cannot be saved is taken back instead.
+ * A ring per table remembers which record each of the last
+ * SERVER_CHANGE_LOG generations changed, which is all an update or delete
+ * needs to tell whether it was based on an outdated record.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <poll.h>
+    #include <pthread.h>
+    #include <signal.h>
+    #include <stdlib.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
+    #include <sys/un.h>
+#endif
+
+#include "../include/server.h"
+#include "../include/storage.h"
+#include "../include/snapshot.h"
+#include "../include/patient.h"
+#include "../include/doctor.h"
+#include "../include/receptionist.h"
+#include "../include/appointment.h"
+#include "../include/reminder.h"
+#include "../include/auth.h"
+#include "../include/utils.h"
+#include "../include/ui.h"
+#include "../include/hospital.h"
+
+#ifdef _WIN32
+
+int server_run(const char* socket_path) {
+    (void)socket_path;
+    ui_print_error("Server mode is not supported on Windows.");
+    return 1;
+}
+
+int server_send_message(int fd, int op, int table, uint32_t generation,
+                        const void* payload, uint32_t length) {
+    (void)fd; (void)op; (void)table; (void)generation; (void)payload; (void)length;
+    return -1;
+}
+
+int server_receive_message(int fd, MessageHeader* header, void* payload, uint32_t capacity) {
+    (void)fd; (void)header; (void)payload; (void)capacity;
+    return -1;
+}
+
+#else
+
+/* Writes a table through to its data file */
+static int table_save(TableId table) {
+    switch (table) {
+        case TABLE_DOCTORS:         return doctor_save_to_file();
+        case TABLE_RECEPTIONISTS:   return receptionist_save_to_file();
+        case TABLE_USERS:           return auth_save_to_file();
+        case TABLE_APPOINTMENTS:    return appointment_save_to_file();
+        default:                    return storage_save(table);    /* A patient shard */
+    }
+}
+
+/* Size of the name a table is searched by, right after the ID; 0 if it has none */
+static size_t name_size(TableId table) {
+    switch (table) {
+        case TABLE_APPOINTMENTS:    return 0;
+        case TABLE_USERS:           return USERNAME_SIZE;
+        default:                    return NAME_SIZE;
+    }
+}
+
+typedef struct {
+    int fd;
+    int slot;                   /* Snapshot reader slot */
+    unsigned char* buffer;      /* STORAGE_IMAGE_MAX bytes */
+} ClientSession;
+
+typedef struct {
+    uint32_t generation;
+    int id;                     /* Record the generation changed */
+} RecordStamp;
+
+typedef struct {
+    int id;
+    int index;                  /* In the table's image; its record count for an add */
+    const unsigned char* record;    /* NULL for a delete */
+    int available;              /* Change to the available count */
+} StagedChange;
+
+static volatile sig_atomic_t stopping = 0;
+static RecordStamp change_log[TABLE_COUNT][SERVER_CHANGE_LOG];  /* Slot generation % SERVER_CHANGE_LOG */
+
+/*
+ *==========================================================================
+ *                              MESSAGES
+ *==========================================================================
+ */
+
+static int read_full(int fd, void* buffer, size_t length) {
+    unsigned char* p = buffer;
+    while (length > 0) {
+        ssize_t n = read(fd, p, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+int server_send_message(int fd, int op, int table, uint32_t generation,
+                        const void* payload, uint32_t length) {
+    MessageHeader header = { (uint8_t)op, (uint8_t)table, 0, generation, length };
+    struct iovec parts[2] = {
+        { &header, sizeof(header) },
+        { (void*)payload, length }
+    };
+    size_t left = sizeof(header) + length;
+    int first = 0;
+
+    // Header and payload go out in one writev; loop only on short writes
+    while (left > 0) {
+        ssize_t n = writev(fd, parts + first, 2 - first);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        left -= (size_t)n;
+        while (first < 2 && (size_t)n >= parts[first].iov_len) {
+            n -= (ssize_t)parts[first].iov_len;
+            first++;
+        }
+        if (first < 2) {
+            parts[first].iov_base = (unsigned char*)parts[first].iov_base + n;
+            parts[first].iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+int server_receive_message(int fd, MessageHeader* header, void* payload, uint32_t capacity) {
+    if (read_full(fd, header, sizeof(*header)) != 0 || header->length > capacity) {
+        return -1;
+    }
+    return read_full(fd, payload, header->length);
+}
+
+/*
+ *==========================================================================
+ *                              REQUESTS
+ *==========================================================================
+ */
+
+/* Sends the current version of a table without blocking the writer. */
+static int reply_snapshot(ClientSession* session, int table, uint32_t known) {
+    const TableVersion* version = snapshot_pin(session->slot, table);
+    int result;
+    if (version->generation == known) {
+        result = server_send_message(session->fd, MSG_NOT_MODIFIED, table, known, NULL, 0);
+    } else {
+        result = server_send_message(session->fd, MSG_OK, table, version->generation,
+                                     version->image, version->length);
+    }
+    snapshot_unpin(session->slot);
+    return result;
+}
+
+static int serve_get(ClientSession* session, int table, uint32_t length) {
+    int id;
+    if (length != sizeof(id)) return -1;
+    memcpy(&id, session->buffer, sizeof(id));
+
+    const TableVersion* version = snapshot_pin(session->slot, table);
+    size_t record_size = storage_record_size(table);
+    int index = storage_find_record(table, version->image, version->length, id);
+    int result;
+    if (index == -1) {
+        result = server_send_message(session->fd, MSG_NOT_FOUND, table, version->generation, NULL, 0);
+    } else {
+        result = server_send_message(session->fd, MSG_OK, table, version->generation,
+                                     version->image + storage_counts_size(table) + (size_t)index * record_size,
+                                     (uint32_t)record_size);
+    }
+    snapshot_unpin(session->slot);
+    return result;
+}
+
+static int serve_search(ClientSession* session, int table, uint32_t length) {
+    size_t size = name_size(table);
+    if (size == 0 || length == 0 || length > size) {
+        return server_send_message(session->fd, MSG_ERROR, table, 0, NULL, 0);
+    }
+    char name[NAME_SIZE > USERNAME_SIZE ? NAME_SIZE : USERNAME_SIZE];
+    memcpy(name, session->buffer, length);
+    name[length - 1] = '\0';
+
+    // Matches are gathered in the session buffer, which the request no longer needs
+    const TableVersion* version = snapshot_pin(session->slot, table);
+    size_t head = storage_counts_size(table);
+    size_t record_size = storage_record_size(table);
+    int count;
+    memcpy(&count, version->image, sizeof(int));
+    uint32_t found = 0;
+    for (int i = 0; i < count; i++) {
+        const unsigned char* record = version->image + head + (size_t)i * record_size;
+        if (strncmp((const char*)record + sizeof(int), name, size) == 0) {
+            memcpy(session->buffer + found, record, record_size);
+            found += (uint32_t)record_size;
+        }
+    }
+    int result = server_send_message(session->fd, MSG_OK, table, version->generation, session->buffer, found);
+    snapshot_unpin(session->slot);
+    return result;
+}
+
+/* Whether a record may have changed after generation `base`; the log only reaches back so far. */
+static bool changed_since(TableId table, int id, uint32_t base, uint32_t generation) {
+    if (base > generation || generation - base > SERVER_CHANGE_LOG) return true;
+    for (uint32_t g = base + 1; g <= generation; g++) {
+        const RecordStamp* stamp = &change_log[table][g % SERVER_CHANGE_LOG];
+        if (stamp->generation != g || stamp->id == id) return true;
+    }
+    return false;
+}
+
+/* Checks one record change against the next version of a table; returns a MessageStatus. */
+static int change_stage(int op, TableId table, uint32_t base, TableVersion* next,
+                        const unsigned char* payload, uint32_t length, StagedChange* staged) {
+    size_t record_size = storage_record_size(table);
+    RecordChange change;
+    if (length != sizeof(change) + (op == MSG_DELETE ? sizeof(int) : record_size)) return MSG_ERROR;
+    memcpy(&change, payload, sizeof(change));
+    staged->record = op == MSG_DELETE ? NULL : payload + sizeof(change);
+    staged->available = change.available;
+    memcpy(&staged->id, payload + sizeof(change), sizeof(int));
+
+    int count;
+    memcpy(&count, next->image, sizeof(int));
+    staged->index = storage_find_record(table, next->image, next->length, staged->id);
+
+    if (op == MSG_ADD) {
+        if (staged->index != -1) return MSG_STALE;
+        if (next->length + record_size > STORAGE_IMAGE_MAX) return MSG_ERROR;
+        staged->index = count;      /* Appended, as every module adds records */
+    } else if (staged->index == -1 || changed_since(table, staged->id, base, next->generation - 1)) {
+        return MSG_STALE;
+    }
+    return MSG_OK;
+}
+
+/* Makes the staged change to the next version's image, moving the available count as in memory. */
+static void change_patch(TableId table, TableVersion* next, const StagedChange* staged) {
+    size_t head = storage_counts_size(table);
+    size_t record_size = storage_record_size(table);
+    int count;
+    memcpy(&count, next->image, sizeof(int));
+    unsigned char* at = next->image + head + (size_t)staged->index * record_size;
+
+    if (staged->record == NULL) {
+        memmove(at, at + record_size, (size_t)(count - staged->index - 1) * record_size);
+        count--;
+    } else {
+        memcpy(at, staged->record, record_size);
+        if (staged->index == count) count++;
+    }
+    memcpy(next->image, &count, sizeof(int));
+    if (head > sizeof(int)) {
+        int available;
+        memcpy(&available, next->image + sizeof(int), sizeof(int));
+        available += staged->available;
+        memcpy(next->image + sizeof(int), &available, sizeof(int));
+    }
+    next->length = (uint32_t)(head + (size_t)count * record_size);
+}
+
+static int serve_change(ClientSession* session, int op, int table, uint32_t base, uint32_t length) {
+    snapshot_write_lock();
+    TableVersion* next = snapshot_prepare(table, (uint32_t)storage_record_size(table));
+    uint32_t generation = next != NULL ? next->generation - 1 : snapshot_generation(table);
+
+    // The tables in memory belong to the writer; readers only see versions
+    StagedChange staged;
+    int status = next == NULL ? MSG_ERROR : change_stage(op, table, base, next, session->buffer, length, &staged);
+    if (status == MSG_OK) {
+        status = MSG_ERROR;
+        if (storage_apply_record(table, staged.index, staged.record, &staged.available) == 0) {
+            if (table_save(table) == 0) {
+                change_patch(table, next, &staged);
+                generation = snapshot_commit(table, next);
+                next = NULL;
+                change_log[table][generation % SERVER_CHANGE_LOG] = (RecordStamp){ generation, staged.id };
+                status = MSG_OK;
+            } else {
+                // Not published: put the table back as readers still see it
+                const TableVersion* current = snapshot_pin(session->slot, table);
+                storage_apply(table, current->image, current->length);
+                snapshot_unpin(session->slot);
+            }
+        }
+    }
+    if (next != NULL) snapshot_discard(next);
+    snapshot_write_unlock();
+
+    return server_send_message(session->fd, status, table, generation, NULL, 0);
+}
+
+/* Serves one request; returns -1 if the client should be dropped. */
+static int serve_request(ClientSession* session) {
+    MessageHeader request;
+    if (server_receive_message(session->fd, &request, session->buffer, STORAGE_IMAGE_MAX) != 0 ||
+        request.table >= TABLE_COUNT) {
+        return -1;
+    }
+
+    switch (request.op) {
+        case MSG_FETCH:
+            return reply_snapshot(session, request.table, request.generation);
+        case MSG_GET:
+            return serve_get(session, request.table, request.length);
+        case MSG_SEARCH:
+            return serve_search(session, request.table, request.length);
+        case MSG_ADD:
+        case MSG_UPDATE:
+        case MSG_DELETE:
+            return serve_change(session, request.op, request.table, request.generation, request.length);
+        default:
+            return -1;
+    }
+}
+
+static void* client_thread(void* arg) {
+    ClientSession* session = arg;
+    while (serve_request(session) == 0) {
+    }
+    close(session->fd);
+    snapshot_unregister(session->slot);
+    free(session->buffer);
+    free(session);
+    return NULL;
+}
+
+/* Starts a thread for a new connection, or turns it away when full. */
+static void client_start(int fd) {
+    ClientSession* session = malloc(sizeof(ClientSession));
+    unsigned char* buffer = malloc(STORAGE_IMAGE_MAX);
+    int slot = snapshot_register();
+    pthread_t thread;
+
+    if (session != NULL && buffer != NULL && slot >= 0) {
+        session->fd = fd;
+        session->slot = slot;
+        session->buffer = buffer;
+        if (pthread_create(&thread, NULL, client_thread, session) == 0) {
+            pthread_detach(thread);
+            return;
+        }
+    }
+    if (slot >= 0) snapshot_unregister(slot);
+    free(buffer);
+    free(session);
+    close(fd);
+}
+
+/*
+ *==========================================================================
+ *                              EVENT LOOP
+ *==========================================================================
+ */
+
+static void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+static int open_listener(const char* socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    // A socket file nobody answers on is left over from a crash
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        close(fd);
+        ui_print_error("An HMS server is already running.");
+        return -1;
+    }
+    unlink(socket_path);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        ui_print_error("Could not open the server socket.");
+        return -1;
+    }
+    return fd;
+}
+
+int server_run(const char* socket_path) {
+    if (snapshot_init() != 0) {
+        ui_print_error("Out of memory.");
+        return 1;
+    }
+    int listener = open_listener(socket_path);
+    if (listener < 0) return 1;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;      /* No SA_RESTART: poll() must return */
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    struct pollfd accept_fd = { listener, POLLIN, 0 };
+
+    printf("HMS server listening on %s (Ctrl+C to stop)\n", socket_path);
+    fflush(stdout);
+
+    while (!stopping) {
+        int ready = poll(&accept_fd, 1, SERVER_TICK_MS);
+
+        // Reminders read the writer's tables
+        snapshot_write_lock();
+        reminder_poll(utils_now_minutes());
+        snapshot_write_unlock();
+
+        if (ready > 0 && (accept_fd.revents & POLLIN)) {
+            int client = accept(listener, NULL, NULL);
+            if (client >= 0) client_start(client);
+        }
+    }
+
+    // Client threads end with the process; every accepted change is already on disk
+    close(listener);
+    unlink(socket_path);
+    printf("\nHMS server stopped.\n");
+    return 0;
+}
+
+#endif
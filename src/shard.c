@@ -0,0 +1,250 @@
+/**
+ * @file shard.c
+ * @brief Patient table shards implementation for Healthcare Management System
+ *
+ * Scans use a fixed pool of PATIENT_SHARDS - 1 worker threads, started on
+ * the first scan big enough to need them; the calling thread scans the
+ * first part itself. The parts are equal slices of the sorted array, not
+ * the shards: IDs are handed out in order, so the shards fill one after
+ * another and a scan by shard would leave most threads idle. Each part
+ * collects its matches into its own list, so the workers share nothing
+ * but the (read-only) patients array, and the lists are concatenated in
+ * part order, which is ID order.
+ */
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/shard.h"
+#include "../include/hospital.h"
+
+#ifndef _WIN32
+    #include <pthread.h>
+#endif
+
+typedef struct {
+    PatientFilter filter;
+    const void* arg;
+    int max;
+    int begin[PATIENT_SHARDS];
+    int end[PATIENT_SHARDS];
+} ScanTask;
+
+static ScanTask task;
+static int matches[PATIENT_SHARDS][PATIENT_SHARD_SPAN];   /* A part is at most ceil(MAX_PATIENTS / PATIENT_SHARDS) */
+static int found[PATIENT_SHARDS];
+
+#ifndef _WIN32
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+static unsigned int pool_round = 0;     /* Bumped for every parallel scan */
+static int pool_remaining = 0;          /* Workers still scanning this round */
+static int pool_workers = 0;             /* Worker threads started so far */
+#endif
+
+/*
+ *==========================================================================
+ *                              SHARD RANGES
+ *==========================================================================
+ */
+
+int shard_of_patient(int id) {
+    if (id < PATIENT_ID_START) return 0;
+    int shard = (id - PATIENT_ID_START) / PATIENT_SHARD_SPAN;
+    return shard < PATIENT_SHARDS ? shard : PATIENT_SHARDS - 1;
+}
+
+/* Index of the first patient whose ID is at least id. */
+static int lower_bound(int id) {
+    int low = 0, high = patient_count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (patients[mid].id < id) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+void shard_patient_slice(int shard, int* begin, int* end) {
+    *begin = shard == 0 ? 0 : lower_bound(PATIENT_ID_START + shard * PATIENT_SHARD_SPAN);
+    *end = shard == PATIENT_SHARDS - 1 ? patient_count
+                                       : lower_bound(PATIENT_ID_START + (shard + 1) * PATIENT_SHARD_SPAN);
+}
+
+int shard_find_patient(int id) {
+    int index = lower_bound(id);
+    return index < patient_count && patients[index].id == id ? index : -1;
+}
+
+static int count_active(const Patient* records, int count) {
+    int active = 0;
+    for (int i = 0; i < count; i++) {
+        if (records[i].is_active) active++;
+    }
+    return active;
+}
+
+int shard_replace_patients(int shard, const Patient* records, int count) {
+    for (int i = 0; i < count; i++) {
+        if (shard_of_patient(records[i].id) != shard || (i > 0 && records[i].id < records[i - 1].id)) {
+            return -1;
+        }
+    }
+
+    int begin, end;
+    shard_patient_slice(shard, &begin, &end);
+    int old_count = end - begin;
+    if (patient_count - old_count + count > MAX_PATIENTS) return -1;
+
+    int old_active = count_active(&patients[begin], old_count);
+    int new_active = count_active(records, count);
+
+    memmove(&patients[begin + count], &patients[end], (size_t)(patient_count - end) * sizeof(Patient));
+    memcpy(&patients[begin], records, (size_t)count * sizeof(Patient));
+    patient_count += count - old_count;
+    patient_available += new_active - old_active;
+    patient_unavailable += (count - new_active) - (old_count - old_active);
+    return 0;
+}
+
+int shard_change_patient(int shard, int index, const Patient* record) {
+    int begin, end;
+    shard_patient_slice(shard, &begin, &end);
+    int at = begin + index;
+    bool add = at == end;
+    if (index < 0 || at > end || (add && (record == NULL || patient_count == MAX_PATIENTS))) return INT_MIN;
+
+    // The record must fall between its neighbours in ID order
+    int next = add ? at : at + 1;
+    if (record != NULL && (shard_of_patient(record->id) != shard ||
+                           (at > 0 && patients[at - 1].id >= record->id) ||
+                           (next < patient_count && patients[next].id <= record->id))) {
+        return INT_MIN;
+    }
+
+    int active = (record != NULL && record->is_active) - (!add && patients[at].is_active);
+    int present = (record != NULL) - !add;
+    if (record == NULL) {
+        memmove(&patients[at], &patients[at + 1], (size_t)(patient_count - at - 1) * sizeof(Patient));
+    } else {
+        if (add) memmove(&patients[at + 1], &patients[at], (size_t)(patient_count - at) * sizeof(Patient));
+        patients[at] = *record;
+    }
+    patient_count += present;
+    patient_available += active;
+    patient_unavailable += present - active;
+    return active;
+}
+
+static int compare_id(const void* a, const void* b) {
+    int x = ((const Patient*)a)->id, y = ((const Patient*)b)->id;
+    return (x > y) - (x < y);
+}
+
+int shard_adopt_patients(const Patient* records, int count) {
+    if (count < 0 || count > MAX_PATIENTS) return -1;
+    memmove(patients, records, (size_t)count * sizeof(Patient));
+    qsort(patients, (size_t)count, sizeof(Patient), compare_id);
+    patient_count = count;
+    patient_available = count_active(patients, count);
+    patient_unavailable = count - patient_available;
+    return 0;
+}
+
+/*
+ *==========================================================================
+ *                              PARALLEL SCANS
+ *==========================================================================
+ */
+
+static void scan_part(int part) {
+    int n = 0;
+    for (int i = task.begin[part]; i < task.end[part] && n < task.max; i++) {
+        if (task.filter(&patients[i], task.arg)) {
+            matches[part][n++] = i;
+        }
+    }
+    found[part] = n;
+}
+
+#ifndef _WIN32
+
+static void* worker_thread(void* arg) {
+    int part = (int)(intptr_t)arg;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&pool_lock);
+    while (1) {
+        while (pool_round == seen) {
+            pthread_cond_wait(&pool_start, &pool_lock);
+        }
+        seen = pool_round;
+        pthread_mutex_unlock(&pool_lock);
+
+        scan_part(part);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--pool_remaining == 0) pthread_cond_signal(&pool_done);
+    }
+    return NULL;
+}
+
+/* Starts the workers not yet running; scans stay serial until all are. */
+static bool pool_start_workers(void) {
+    while (pool_workers < PATIENT_SHARDS - 1) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, worker_thread, (void*)(intptr_t)(pool_workers + 1)) != 0) {
+            return false;
+        }
+        pthread_detach(thread);
+        pool_workers++;
+    }
+    return true;
+}
+
+#endif
+
+int shard_scan_patients(PatientFilter filter, const void* arg, int* out, int max) {
+    task.filter = filter;
+    task.arg = arg;
+    task.max = max < MAX_PATIENTS ? max : MAX_PATIENTS;
+    for (int part = 0; part < PATIENT_SHARDS; part++) {
+        task.begin[part] = (int)((long long)patient_count * part / PATIENT_SHARDS);
+        task.end[part] = (int)((long long)patient_count * (part + 1) / PATIENT_SHARDS);
+    }
+
+    bool parallel = false;
+    #ifndef _WIN32
+        parallel = PATIENT_SHARDS > 1 && patient_count >= SHARD_PARALLEL_MIN && pool_start_workers();
+        if (parallel) {
+            pthread_mutex_lock(&pool_lock);
+            pool_remaining = PATIENT_SHARDS - 1;
+            pool_round++;
+            pthread_cond_broadcast(&pool_start);
+            pthread_mutex_unlock(&pool_lock);
+
+            scan_part(0);
+
+            pthread_mutex_lock(&pool_lock);
+            while (pool_remaining > 0) {
+                pthread_cond_wait(&pool_done, &pool_lock);
+            }
+            pthread_mutex_unlock(&pool_lock);
+        }
+    #endif
+    if (!parallel) {
+        for (int part = 0; part < PATIENT_SHARDS; part++) {
+            scan_part(part);
+        }
+    }
+
+    int n = 0;
+    for (int part = 0; part < PATIENT_SHARDS && n < max; part++) {
+        for (int i = 0; i < found[part] && n < max; i++) {
+            out[n++] = matches[part][i];
+        }
+    }
+    return n;
+}
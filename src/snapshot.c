@@ -0,0 +1,155 @@
+/**
+ * @file snapshot.c
+ * @brief Versioned table snapshots implementation for Healthcare Management System
+ *
+ * Reclamation uses three epochs. A reader announces the global epoch it
+ * entered in before loading a version pointer. A version retired while
+ * the global epoch was e is freed once the epoch reaches e + 2, which can
+ * only happen after every active reader has been seen in epoch e + 1, so
+ * none of them can still hold it. Only the writer retires, advances and
+ * frees, so the limbo lists need no synchronisation of their own.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "../include/snapshot.h"
+
+#ifndef _WIN32
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define EPOCHS  3
+
+typedef struct Retired {
+    struct Retired* next;
+    TableVersion* version;
+} Retired;
+
+typedef struct {
+    atomic_bool in_use;
+    atomic_bool active;
+    atomic_uint epoch;
+} ReaderSlot;
+
+static _Atomic(TableVersion*) current[TABLE_COUNT];
+static ReaderSlot readers[SNAPSHOT_READERS];
+static atomic_uint global_epoch;
+static Retired* limbo[EPOCHS];
+static pthread_mutex_t writer = PTHREAD_MUTEX_INITIALIZER;
+
+static TableVersion* version_new(uint32_t generation, const unsigned char* image, uint32_t length) {
+    TableVersion* version = malloc(sizeof(TableVersion) + length);
+    if (version == NULL) return NULL;
+    version->generation = generation;
+    version->length = length;
+    memcpy(version->image, image, length);
+    return version;
+}
+
+static void limbo_free(int e) {
+    Retired* r = limbo[e];
+    limbo[e] = NULL;
+    while (r != NULL) {
+        Retired* next = r->next;
+        free(r->version);
+        free(r);
+        r = next;
+    }
+}
+
+/* Moves to the next epoch if every active reader has caught up. */
+static void epoch_try_advance(void) {
+    unsigned int e = atomic_load(&global_epoch);
+    for (int s = 0; s < SNAPSHOT_READERS; s++) {
+        if (atomic_load(&readers[s].active) && atomic_load(&readers[s].epoch) != e) {
+            return;
+        }
+    }
+    atomic_store(&global_epoch, e + 1);
+    limbo_free((e + 2) % EPOCHS);      /* Retired in epoch e - 1 */
+}
+
+static void retire(TableVersion* version) {
+    Retired* r = malloc(sizeof(Retired));
+    if (r == NULL) return;              /* Leak rather than free under a reader */
+    unsigned int e = atomic_load(&global_epoch) % EPOCHS;
+    r->version = version;
+    r->next = limbo[e];
+    limbo[e] = r;
+    epoch_try_advance();
+}
+
+int snapshot_init(void) {
+    static unsigned char image[STORAGE_IMAGE_MAX];
+
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        int length = storage_encode(t, image, sizeof(image));
+        TableVersion* version = length < 0 ? NULL : version_new(1, image, (uint32_t)length);
+        if (version == NULL) return -1;
+        atomic_store(&current[t], version);
+    }
+    return 0;
+}
+
+int snapshot_register(void) {
+    for (int s = 0; s < SNAPSHOT_READERS; s++) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&readers[s].in_use, &expected, true)) {
+            atomic_store(&readers[s].active, false);
+            return s;
+        }
+    }
+    return -1;
+}
+
+void snapshot_unregister(int slot) {
+    atomic_store(&readers[slot].active, false);
+    atomic_store(&readers[slot].in_use, false);
+}
+
+const TableVersion* snapshot_pin(int slot, TableId table) {
+    // Announce the epoch before touching the pointer (all sequentially consistent)
+    atomic_store(&readers[slot].active, true);
+    atomic_store(&readers[slot].epoch, atomic_load(&global_epoch));
+    return atomic_load(&current[table]);
+}
+
+void snapshot_unpin(int slot) {
+    atomic_store(&readers[slot].active, false);
+}
+
+void snapshot_write_lock(void) {
+    pthread_mutex_lock(&writer);
+}
+
+void snapshot_write_unlock(void) {
+    pthread_mutex_unlock(&writer);
+}
+
+uint32_t snapshot_generation(TableId table) {
+    return atomic_load_explicit(&current[table], memory_order_relaxed)->generation;
+}
+
+TableVersion* snapshot_prepare(TableId table, uint32_t extra) {
+    const TableVersion* old = atomic_load_explicit(&current[table], memory_order_relaxed);
+    TableVersion* version = malloc(sizeof(TableVersion) + old->length + extra);
+    if (version == NULL) return NULL;
+    version->generation = old->generation + 1;
+    version->length = old->length;
+    memcpy(version->image, old->image, old->length);
+    return version;
+}
+
+uint32_t snapshot_commit(TableId table, TableVersion* version) {
+    TableVersion* old = atomic_load_explicit(&current[table], memory_order_relaxed);
+    atomic_store(&current[table], version);
+    retire(old);
+    return version->generation;
+}
+
+void snapshot_discard(TableVersion* version) {
+    free(version);
+}
+
+#endif
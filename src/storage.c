@@ -0,0 +1,1356 @@
+/**
+ * @file storage.c
+ * @brief Table storage implementation for Healthcare Management System
+ *
+ * Without a server every table lives in its .dat file behind a small
+ * header: a generation counter and the record ranges written by the last
+ * few saves. Saves and loads hold a flock on the file, a save writes only
+ * the records that changed, and a running process catches up with another
+ * one's saves by reading just the records named in the header. In the
+ * interactive program saves are handed to a writer thread through a
+ * lock-free ring, so the menus never wait for the disk. The writer takes
+ * every save queued at once and syncs their files together at the end;
+ * outcomes come back through a second ring and are reported on the next
+ * menu.
+ * When connected, loads become fetches and the shadow holds the image as
+ * the server last sent it. A save is diffed against it by record ID and
+ * sent as one add, update or delete per record, a window of them in flight
+ * at a time; the server refuses only a change to a record another terminal
+ * changed since, so edits to different records never cancel each other.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <pthread.h>
+    #include <semaphore.h>
+    #include <signal.h>
+    #include <stdatomic.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include <sys/file.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+#endif
+
+#include "../include/storage.h"
+#include "../include/storage_io.h"
+#include "../include/metrics.h"
+#include "../include/replica.h"
+#include "../include/server.h"
+#include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/appointment_stats.h"
+#include "../include/doctor_portal.h"
+#include "../include/workload.h"
+#include "../include/reminder.h"
+#include "../include/utils.h"
+#include "../include/ui.h"
+#include "../include/hospital.h"
+
+#define LARGER(a, b)    ((a) > (b) ? (a) : (b))
+#define RECORD_SIZE_MAX LARGER(LARGER(LARGER(sizeof(Patient), sizeof(Doctor)), LARGER(sizeof(Receptionist), sizeof(User))), sizeof(Appointment))
+#define CHANGES_IN_FLIGHT   64      /* Record changes sent before their replies are read */
+
+typedef struct {
+    const char* path;
+    int* count;
+    int* available;         /* NULL if the table has no available count */
+    void* records;
+    size_t record_size;
+    int max;
+} TableInfo;
+
+/* Patient shards share the first entry; their records are slices of patients[] */
+static const TableInfo tables[TABLE_COUNT] = {
+    [TABLE_PATIENTS] = { PATIENT_SHARD_FMT, &patient_count, &patient_available, patients, sizeof(Patient), MAX_PATIENTS },
+    [TABLE_DOCTORS] = { DOCTORS_FILE, &doctor_count, &doctor_available, doctors, sizeof(Doctor), MAX_DOCTORS },
+    [TABLE_RECEPTIONISTS] = { RECEPTIONISTS_FILE, &receptionist_count, &receptionist_available, receptionists, sizeof(Receptionist), MAX_RECEPTIONISTS },
+    [TABLE_USERS] = { USERS_FILE, &user_count, NULL, users, sizeof(User), MAX_USERS },
+    [TABLE_APPOINTMENTS] = { APPOINTMENTS_FILE, &appointment_count, NULL, appointments, sizeof(Appointment), MAX_APPOINTMENTS }
+};
+
+typedef struct {
+    uint32_t generation;
+    uint32_t first;         /* Records [first, last) were written, or removed by a shrink */
+    uint32_t last;
+} FileChange;
+
+/* Precedes the table image in every data file */
+typedef struct {
+    uint32_t magic;
+    uint32_t generation;    /* Bumped by every save */
+    FileChange changes[STORAGE_CHANGE_LOG];     /* Slot generation % STORAGE_CHANGE_LOG */
+} FileHeader;
+
+/* The image as last read from or written to the data file */
+typedef struct {
+    uint32_t generation;
+    bool stale;             /* A save did not land, so the file may lack records the image has */
+    size_t length;
+    size_t capacity;
+    unsigned char* image;   /* Grown to the longest image the table has had */
+} TableShadow;
+
+typedef enum {
+    SAVE_OK,
+    SAVE_CONFLICT,
+    SAVE_FAILED
+} SaveStatus;
+
+/* A table image waiting to be written, and what it was based on */
+typedef struct {
+    TableId table;
+    uint32_t base_generation;
+    int base_count;
+    int base_available;
+    uint32_t first;         /* Changed records [first, last) */
+    uint32_t last;
+    size_t length;
+    size_t capacity;
+    unsigned char* image;   /* Grown to the largest table the slot has carried */
+} SaveJob;
+
+typedef struct {
+    TableId table;
+    SaveStatus status;
+    uint32_t base_generation;
+    uint32_t generation;    /* Written generation, if SAVE_OK */
+    bool clean;             /* No other process wrote in between */
+} SaveResult;
+
+static unsigned char* image;                                        /* Scratch, grown like a job's */
+static size_t image_capacity;
+static TableShadow shadows[TABLE_COUNT];
+static uint32_t own_generations[TABLE_COUNT][STORAGE_OWN_LOG];     /* Written by this process */
+static uint32_t* foreign_generations[TABLE_COUNT];                  /* Per record, by anyone else */
+static uint32_t seen_generations[TABLE_COUNT];                      /* Newest header the writer read */
+static SaveJob sync_job;
+
+#ifndef _WIN32
+/* Single-producer rings: jobs from the UI thread, results from the writer */
+static SaveJob jobs[STORAGE_QUEUE_SIZE];
+static SaveResult results[STORAGE_QUEUE_SIZE];
+static atomic_uint job_head, job_tail;
+static atomic_uint result_head, result_tail;
+static atomic_int pending[TABLE_COUNT];
+static sem_t jobs_ready;
+static bool writer_running = false;
+#endif
+
+static bool remote = false;
+static int server_fd = -1;              /* -1 once the connection is lost */
+
+/*
+ *==========================================================================
+ *                              TABLE IMAGES
+ *==========================================================================
+ */
+
+static bool is_patient_shard(TableId table) {
+    return table < TABLE_PATIENTS + PATIENT_SHARDS;
+}
+
+static const TableInfo* table_info(TableId table) {
+    return &tables[is_patient_shard(table) ? TABLE_PATIENTS : table];
+}
+
+static const char* table_path(TableId table, char* buffer, size_t size) {
+    if (!is_patient_shard(table)) return tables[table].path;
+    snprintf(buffer, size, PATIENT_SHARD_FMT, (int)(table - TABLE_PATIENTS));
+    return buffer;
+}
+
+const char* storage_table_path(TableId table, char* buffer, size_t size) {
+    return table_path(table, buffer, size);
+}
+
+size_t storage_counts_size(TableId table) {
+    return table_info(table)->available != NULL ? 2 * sizeof(int) : sizeof(int);
+}
+
+size_t storage_record_size(TableId table) {
+    return table_info(table)->record_size;
+}
+
+/* A shard's image: its slice of patients[] and how many of them are active. */
+static int shard_encode(TableId table, unsigned char* buffer, size_t capacity) {
+    int begin, end;
+    shard_patient_slice((int)(table - TABLE_PATIENTS), &begin, &end);
+    int count = end - begin, available = 0;
+    size_t header = 2 * sizeof(int);
+    size_t body = (size_t)count * sizeof(Patient);
+
+    if (header + body > capacity) return -1;
+    for (int i = begin; i < end; i++) {
+        if (patients[i].is_active) available++;
+    }
+    memcpy(buffer, &count, sizeof(int));
+    memcpy(buffer + sizeof(int), &available, sizeof(int));
+    memcpy(buffer + header, &patients[begin], body);
+    return (int)(header + body);
+}
+
+int storage_encode(TableId table, unsigned char* buffer, size_t capacity) {
+    if (is_patient_shard(table)) return shard_encode(table, buffer, capacity);
+
+    const TableInfo* info = &tables[table];
+    size_t header = info->available != NULL ? 2 * sizeof(int) : sizeof(int);
+    size_t body = (size_t)*info->count * info->record_size;
+
+    if (header + body > capacity) return -1;
+
+    memcpy(buffer, info->count, sizeof(int));
+    if (info->available != NULL) {
+        memcpy(buffer + sizeof(int), info->available, sizeof(int));
+    }
+    memcpy(buffer + header, info->records, body);
+    return (int)(header + body);
+}
+
+static int record_id(const unsigned char* record) {
+    int id;
+    memcpy(&id, record, sizeof(int));
+    return id;
+}
+
+int storage_find_record(TableId table, const unsigned char* data, size_t length, int id) {
+    size_t header = storage_counts_size(table);
+    size_t record_size = table_info(table)->record_size;
+    int count;
+
+    if (length < header) return -1;
+    memcpy(&count, data, sizeof(int));
+    if (count < 0 || length < header + (size_t)count * record_size) return -1;
+    const unsigned char* records = data + header;
+
+    // Most tables are in ID order, where a binary search finds it; the rest are scanned
+    int low = 0, high = count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int mid_id = record_id(records + (size_t)mid * record_size);
+        if (mid_id == id) return mid;
+        if (mid_id < id) low = mid + 1;
+        else high = mid - 1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (record_id(records + (size_t)i * record_size) == id) return i;
+    }
+    return -1;
+}
+
+/* Record count of a well-formed image; -1 if it is malformed. */
+static int image_count(TableId table, const unsigned char* data, size_t length) {
+    const TableInfo* info = table_info(table);
+    size_t header = storage_counts_size(table);
+    int count;
+
+    if (length < header) return -1;
+    memcpy(&count, data, sizeof(int));
+    if (count < 0 || count > info->max || length != header + (size_t)count * info->record_size) {
+        return -1;
+    }
+    return count;
+}
+
+int storage_decode(TableId table, const unsigned char* data, size_t length) {
+    const TableInfo* info = table_info(table);
+    size_t header = storage_counts_size(table);
+    int count = image_count(table, data, length);
+
+    if (count < 0) return -1;
+    if (is_patient_shard(table)) {
+        // The available counts follow from the records
+        return shard_replace_patients((int)(table - TABLE_PATIENTS), (const Patient*)(data + header), count);
+    }
+
+    *info->count = count;
+    if (info->available != NULL) {
+        memcpy(info->available, data + sizeof(int), sizeof(int));
+    }
+    memcpy(info->records, data + header, (size_t)count * info->record_size);
+    return 0;
+}
+
+int storage_apply(TableId table, const unsigned char* data, size_t length) {
+    int old_count = appointment_count;
+    if (storage_decode(table, data, length) != 0) return -1;
+
+    switch (table) {
+        case TABLE_APPOINTMENTS:
+            // Appointments leave the table when another process seals them into new segments
+            if (appointment_count < old_count) appointment_archive_load_from_file();
+            appointment_rescan_ids();
+            appointment_stats_rebuild();
+            workload_rebuild();
+            reminder_init(utils_now_minutes());
+            reminder_load_from_appointments();
+            doctor_portal_schedule_invalidate();
+            break;
+        case TABLE_DOCTORS:
+            workload_rebuild();
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+/* Takes an appointment out of, or puts it into, everything derived from the table. */
+static void appointment_derive(const Appointment* appt, bool add) {
+    if (add) appointment_stats_add(appt);
+    else appointment_stats_remove(appt);
+    workload_update(appt->doctor_id, utils_date_key(appt->date));
+    if (add) reminder_reschedule(appt);
+    else reminder_cancel(appt->id);
+}
+
+/*
+ * Applies an appointments image whose records before `first` are those in
+ * memory. Only the records that differ from there on are taken out of and
+ * put back into the counters, workload and reminders, so the wheel keeps
+ * running. A table that lost records was sealed (or had records removed),
+ * which only a full rebuild accounts for.
+ */
+static int appointments_refresh(const unsigned char* data, size_t length, int first) {
+    int count = image_count(TABLE_APPOINTMENTS, data, length);
+    if (count < 0) return -1;
+    if (count < appointment_count || first > appointment_count) {
+        return storage_apply(TABLE_APPOINTMENTS, data, length);
+    }
+
+    const unsigned char* records = data + storage_counts_size(TABLE_APPOINTMENTS);
+    Appointment appt;
+    for (int i = first; i < appointment_count; i++) {
+        if (memcmp(&appointments[i], records + (size_t)i * sizeof(Appointment), sizeof(Appointment)) != 0) {
+            appointment_derive(&appointments[i], false);
+        }
+    }
+    for (int i = first; i < count; i++) {
+        memcpy(&appt, records + (size_t)i * sizeof(Appointment), sizeof(Appointment));
+        if (i >= appointment_count || memcmp(&appointments[i], &appt, sizeof(Appointment)) != 0) {
+            appointment_derive(&appt, true);
+            appointment_note_id(appt.id);
+        }
+    }
+    storage_decode(TABLE_APPOINTMENTS, data, length);
+    doctor_portal_schedule_invalidate();
+    return 0;
+}
+
+int storage_apply_record(TableId table, int index, const unsigned char* record, int* available) {
+    if (is_patient_shard(table)) {
+        Patient patient;
+        if (record != NULL) memcpy(&patient, record, sizeof(patient));
+        int active = shard_change_patient((int)(table - TABLE_PATIENTS), index, record != NULL ? &patient : NULL);
+        if (active == INT_MIN) return -1;
+        *available = active;
+        return 0;
+    }
+
+    const TableInfo* info = table_info(table);
+    int count = *info->count;
+    bool add = index == count;
+    if (index < 0 || index > count || (add && (record == NULL || count == info->max))) return -1;
+    unsigned char* at = (unsigned char*)info->records + (size_t)index * info->record_size;
+
+    if (table == TABLE_APPOINTMENTS) {
+        if (!add) appointment_derive(&appointments[index], false);
+        if (record != NULL) {
+            Appointment appt;
+            memcpy(&appt, record, sizeof(appt));
+            appointment_derive(&appt, true);
+            appointment_note_id(appt.id);
+        }
+        doctor_portal_schedule_invalidate();
+    }
+
+    if (record == NULL) {
+        memmove(at, at + info->record_size, (size_t)(count - index - 1) * info->record_size);
+        (*info->count)--;
+    } else {
+        memcpy(at, record, info->record_size);
+        if (add) (*info->count)++;
+    }
+    if (info->available != NULL) *info->available += *available;
+    else *available = 0;
+
+    if (table == TABLE_DOCTORS) workload_rebuild();
+    return 0;
+}
+
+/*
+ *==========================================================================
+ *                              DATA FILES
+ *==========================================================================
+ */
+
+static size_t image_header_size(TableId table) {
+    return storage_counts_size(table);
+}
+
+static int image_int(const unsigned char* data, size_t length, int index) {
+    int value = 0;
+    if (length >= (size_t)(index + 1) * sizeof(int)) memcpy(&value, data + index * sizeof(int), sizeof(int));
+    return value;
+}
+
+/* Largest image the table can have */
+static size_t image_max(TableId table) {
+    return image_header_size(table) + (size_t)table_info(table)->max * table_info(table)->record_size;
+}
+
+/* Length of the table's image as it is in memory */
+static size_t image_length(TableId table) {
+    int rows = 0;
+    if (is_patient_shard(table)) {
+        int begin, end;
+        shard_patient_slice((int)(table - TABLE_PATIENTS), &begin, &end);
+        rows = end - begin;
+    } else {
+        rows = *table_info(table)->count;
+    }
+    return image_header_size(table) + (size_t)rows * table_info(table)->record_size;
+}
+
+/*
+ * Grows a buffer to hold an image of the given length; NULL if out of
+ * memory. Buffers follow the tables' actual rows, so a patient shard only
+ * takes the memory of the patients it holds.
+ */
+static unsigned char* image_reserve(unsigned char** buffer, size_t* capacity, size_t needed) {
+    if (needed < 2 * sizeof(int)) needed = 2 * sizeof(int);
+    if (*capacity < needed) {
+        unsigned char* grown = realloc(*buffer, needed);
+        if (grown == NULL) return NULL;
+        *buffer = grown;
+        *capacity = needed;
+    }
+    return *buffer;
+}
+
+static unsigned char* scratch_for(size_t length) {
+    return image_reserve(&image, &image_capacity, length);
+}
+
+/* The table's shadow, with room for an image of the given length */
+static TableShadow* shadow_for(TableId table, size_t length) {
+    TableShadow* shadow = &shadows[table];
+    return image_reserve(&shadow->image, &shadow->capacity, length) != NULL ? shadow : NULL;
+}
+
+/* Blocks until this file description holds a shared or exclusive lock. */
+static void file_lock(FILE* file, bool exclusive) {
+    #ifdef _WIN32
+        (void)file;
+        (void)exclusive;
+    #else
+        // flock, not fcntl: the UI and the writer thread must exclude each other too
+        while (flock(fileno(file), exclusive ? LOCK_EX : LOCK_SH) == -1 && errno == EINTR) {
+        }
+    #endif
+}
+
+/* Drops the lock before closing: a grouped commit keeps the description open until it syncs. */
+static void file_unlock(FILE* file) {
+    #ifdef _WIN32
+        (void)file;
+    #else
+        flock(fileno(file), LOCK_UN);
+    #endif
+}
+
+/* Reads the header; false for a missing, empty or pre-header file. */
+static bool header_read(FILE* file, FileHeader* header) {
+    rewind(file);
+    return fread(header, sizeof(*header), 1, file) == 1 && header->magic == STORAGE_MAGIC;
+}
+
+/* Union of the records changed after generation `since`, if the log reaches back that far. */
+static bool header_changes_since(const FileHeader* header, uint32_t since, uint32_t* first, uint32_t* last) {
+    if (since == 0 || header->generation - since > STORAGE_CHANGE_LOG) return false;
+
+    *first = UINT32_MAX;
+    *last = 0;
+    for (uint32_t g = since + 1; g <= header->generation; g++) {
+        const FileChange* change = &header->changes[g % STORAGE_CHANGE_LOG];
+        if (change->generation != g) return false;
+        if (change->first < *first) *first = change->first;
+        if (change->last > *last) *last = change->last;
+    }
+    return true;
+}
+
+/* Length of the image in a data file, going by its size, up to the largest the table can have. */
+static size_t file_image_length(FILE* file, bool has_header, TableId table) {
+    long start = has_header ? (long)sizeof(FileHeader) : 0L;
+    long size = fseek(file, 0L, SEEK_END) == 0 ? ftell(file) : -1;
+    size_t length = size > start ? (size_t)(size - start) : 0;
+    return length < image_max(table) ? length : image_max(table);
+}
+
+static long file_read_image(FILE* file, bool has_header, unsigned char* buffer, size_t capacity) {
+    if (fseek(file, has_header ? (long)sizeof(FileHeader) : 0L, SEEK_SET) != 0) return -1;
+    return (long)fread(buffer, 1, capacity, file);
+}
+
+/* Patches the shadow image with the counts and the given records from the file. */
+static int file_read_changes(FILE* file, TableId table, uint32_t first, uint32_t last) {
+    TableShadow* shadow = &shadows[table];
+    size_t head = image_header_size(table);
+    size_t record_size = table_info(table)->record_size;
+    unsigned char counts[2 * sizeof(int)];
+
+    if (fseek(file, (long)sizeof(FileHeader), SEEK_SET) != 0 || fread(counts, 1, head, file) != head) {
+        return -1;
+    }
+    int count = image_int(counts, head, 0);
+    if (count < 0 || count > table_info(table)->max ||
+        shadow_for(table, head + (size_t)count * record_size) == NULL) {
+        return -1;
+    }
+
+    if (last > (uint32_t)count) last = (uint32_t)count;
+    if (first < last) {
+        size_t offset = head + first * record_size;
+        if (fseek(file, (long)(sizeof(FileHeader) + offset), SEEK_SET) != 0 ||
+            fread(shadow->image + offset, record_size, last - first, file) != last - first) {
+            return -1;
+        }
+    }
+    memcpy(shadow->image, counts, head);
+    shadow->length = head + (size_t)count * record_size;
+    return 0;
+}
+
+/* Range of records that differ from the shadow image. */
+static void shadow_diff(TableId table, const unsigned char* data, size_t length, uint32_t* first, uint32_t* last) {
+    const TableShadow* shadow = &shadows[table];
+    size_t head = image_header_size(table);
+    size_t record_size = table_info(table)->record_size;
+    int new_count = image_int(data, length, 0);
+    int old_count = image_int(shadow->image, shadow->length, 0);
+    int span = new_count > old_count ? new_count : old_count;
+
+    *first = (uint32_t)new_count;
+    *last = 0;
+    for (int i = 0; i < span; i++) {
+        size_t offset = head + (size_t)i * record_size;
+        if (i >= new_count || i >= old_count || memcmp(data + offset, shadow->image + offset, record_size) != 0) {
+            if (*last == 0) *first = (uint32_t)i;
+            *last = (uint32_t)i + 1;
+        }
+    }
+    if (*last > (uint32_t)new_count) *last = (uint32_t)new_count;
+    if (*first > *last) *first = *last;
+}
+
+static bool own_generation(TableId table, uint32_t generation) {
+    for (int i = 0; i < STORAGE_OWN_LOG; i++) {
+        if (own_generations[table][i] == generation) return true;
+    }
+    return false;
+}
+
+/* Records, for each record, the latest generation another process wrote it in. */
+static void note_foreign_changes(TableId table, const FileHeader* header, uint32_t base) {
+    uint32_t* written = foreign_generations[table];
+    uint32_t max = (uint32_t)table_info(table)->max;
+    uint32_t from = seen_generations[table] > base ? seen_generations[table] : base;
+    uint32_t unlogged = header->generation > STORAGE_CHANGE_LOG ? header->generation - STORAGE_CHANGE_LOG : 0;
+
+    // Saves that fell out of the log may have touched anything; the newest of them stands for all
+    uint32_t lost = 0;
+    for (uint32_t g = unlogged; g > from && lost == 0; g--) {
+        if (!own_generation(table, g)) lost = g;
+    }
+    for (uint32_t g = LARGER(unlogged, from) + 1; g <= header->generation; g++) {
+        const FileChange* change = &header->changes[g % STORAGE_CHANGE_LOG];
+        if (!own_generation(table, g) && (change->generation != g || change->last > max)) lost = g;
+    }
+    if (lost != 0) {
+        for (uint32_t r = 0; r < max; r++) written[r] = lost;
+    }
+
+    for (uint32_t g = LARGER(lost, from) + 1; g <= header->generation; g++) {
+        if (own_generation(table, g)) continue;
+        const FileChange* change = &header->changes[g % STORAGE_CHANGE_LOG];
+        for (uint32_t r = change->first; r < change->last; r++) {
+            written[r] = g;
+        }
+    }
+    if (header->generation > seen_generations[table]) {
+        seen_generations[table] = header->generation;
+    }
+}
+
+/*
+ * Writes a save to disk under an exclusive lock. Only the changed records,
+ * the counts and the header are written. Saves by other processes since
+ * the job's base generation are kept; if one touched the same records the
+ * job is refused.
+ */
+static SaveStatus file_write(const SaveJob* job, uint32_t* generation, bool* clean) {
+    TableId table = job->table;
+    size_t head = image_header_size(table);
+    size_t record_size = table_info(table)->record_size;
+    uint32_t first = job->first, last = job->last;
+
+    char buffer[64];
+    const char* path = table_path(table, buffer, sizeof(buffer));
+    FILE* file = fopen(path, "r+b");
+    if (file == NULL) {
+        file = fopen(path, "w+b");
+    }
+    if (file == NULL) {
+        return SAVE_FAILED;
+    }
+    file_lock(file, true);
+
+    FileHeader header;
+    bool has_header = header_read(file, &header);
+    if (foreign_generations[table] == NULL) {
+        foreign_generations[table] = calloc((size_t)table_info(table)->max, sizeof(uint32_t));
+        if (foreign_generations[table] == NULL) {
+            fclose(file);
+            return SAVE_FAILED;
+        }
+    }
+    unsigned char counts[2 * sizeof(int)] = { 0 };
+    int count = image_int(job->image, job->length, 0);
+    int available = image_int(job->image, job->length, 1);
+    int disk_count = has_header ? job->base_count : 0;
+    *clean = true;
+
+    if (has_header && header.generation != job->base_generation) {
+        if (fseek(file, (long)sizeof(FileHeader), SEEK_SET) != 0 || fread(counts, 1, head, file) != head) {
+            fclose(file);
+            return SAVE_FAILED;
+        }
+        disk_count = image_int(counts, head, 0);
+
+        // Records written since the job's base by anyone but us must not be overwritten;
+        // a shrink moves or drops every record up to the old end too
+        uint32_t reach = last;
+        if (count < job->base_count && (uint32_t)job->base_count > reach) reach = (uint32_t)job->base_count;
+        note_foreign_changes(table, &header, job->base_generation);
+        for (uint32_t r = first; r < reach; r++) {
+            if (foreign_generations[table][r] > job->base_generation) {
+                fclose(file);
+                return SAVE_CONFLICT;
+            }
+        }
+        for (uint32_t g = job->base_generation + 1; g <= header.generation; g++) {
+            if (!own_generation(table, g)) *clean = false;
+        }
+
+        // Only one side may add or remove records: ours would overwrite or cut off theirs
+        if (count == job->base_count) {
+            count = disk_count;
+        } else if (disk_count != job->base_count) {
+            fclose(file);
+            return SAVE_CONFLICT;
+        }
+        available = image_int(counts, head, 1) + available - job->base_available;
+    }
+
+    if (!has_header) {
+        // New file, or one written before headers: rewrite it whole
+        memset(&header, 0, sizeof(header));
+        header.magic = STORAGE_MAGIC;
+        header.generation = job->base_generation;
+        first = 0;
+        last = (uint32_t)count;
+    }
+    header.generation++;
+    // A shrink logs the records it removed, so the others see them as changed
+    uint32_t logged = count < disk_count ? (uint32_t)disk_count : last;
+    header.changes[header.generation % STORAGE_CHANGE_LOG] = (FileChange){ header.generation, first, logged };
+
+    memcpy(counts, &count, sizeof(int));
+    memcpy(counts + sizeof(int), &available, sizeof(int));
+
+    // Records first, header last
+    StorageWrite writes[3];
+    int n = 0;
+    writes[n++] = (StorageWrite){ (long)sizeof(FileHeader), counts, head };
+    if (first < last) {
+        writes[n++] = (StorageWrite){ (long)(sizeof(FileHeader) + head + first * record_size),
+                                      job->image + head + first * record_size,
+                                      (last - first) * record_size };
+    }
+    writes[n++] = (StorageWrite){ 0L, &header, sizeof(header) };
+    bool ok = storage_io_commit(file, writes, n,
+                                (long)(sizeof(FileHeader) + head + (size_t)count * record_size)) == 0;
+
+    if (ok) {
+        replica_record(table, header.generation, counts, head, first, last,
+                       job->image + head + first * record_size);
+    }
+    file_unlock(file);
+    if (fclose(file) != 0 || !ok) {
+        return SAVE_FAILED;
+    }
+    own_generations[table][header.generation % STORAGE_OWN_LOG] = header.generation;
+    *generation = header.generation;
+    return SAVE_OK;
+}
+
+/*
+ * Loads a patient table saved before sharding into every shard. The old
+ * file is left in place but no longer read once shard 0 has been saved.
+ */
+static int file_load_unsharded(void) {
+    FILE* file = fopen(PATIENTS_FILE, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    file_lock(file, false);
+
+    FileHeader header;
+    bool has_header = header_read(file, &header);
+    size_t size = file_image_length(file, has_header, TABLE_PATIENTS);
+    long length = scratch_for(size) != NULL ? file_read_image(file, has_header, image, size) : -1;
+    fclose(file);
+
+    size_t head = 2 * sizeof(int);
+    int count = image_int(image, length < 0 ? 0 : (size_t)length, 0);
+    if (length < (long)head || count < 0 || (size_t)length != head + (size_t)count * sizeof(Patient) ||
+        shard_adopt_patients((const Patient*)(image + head), count) != 0) {
+        return -1;
+    }
+
+    // Nothing on disk yet for any shard: the next save writes them all
+    for (int shard = 0; shard < PATIENT_SHARDS; shard++) {
+        shadows[TABLE_PATIENTS + shard].generation = 0;
+        shadows[TABLE_PATIENTS + shard].length = 0;
+    }
+    return 0;
+}
+
+static int file_load(TableId table) {
+    char buffer[64];
+    FILE* file = fopen(table_path(table, buffer, sizeof(buffer)), "rb");
+    if (file == NULL) {
+        return table == TABLE_PATIENTS ? file_load_unsharded() : -1;
+    }
+    file_lock(file, false);
+
+    FileHeader header;
+    bool has_header = header_read(file, &header);
+    size_t size = file_image_length(file, has_header, table);
+    TableShadow* shadow = shadow_for(table, size);
+    long length = shadow != NULL && scratch_for(size) != NULL ? file_read_image(file, has_header, image, size) : -1;
+    fclose(file);
+
+    if (length < 0 || storage_decode(table, image, (size_t)length) != 0) return -1;
+    memcpy(shadow->image, image, (size_t)length);
+    shadow->length = (size_t)length;
+    shadow->generation = has_header ? header.generation : 0;
+    shadow->stale = false;
+    return 0;
+}
+
+int storage_read_image(TableId table, const char* dir, unsigned char* buffer, size_t capacity,
+                       uint32_t* generation) {
+    char name[64], path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, table_path(table, name, sizeof(name)));
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    file_lock(file, false);
+
+    FileHeader header;
+    bool has_header = header_read(file, &header);
+    size_t length = 0;
+    if (fseek(file, has_header ? (long)sizeof(FileHeader) : 0L, SEEK_SET) == 0) {
+        length = fread(buffer, 1, capacity, file);
+    }
+    fclose(file);
+
+    size_t head = image_header_size(table);
+    int count = image_int(buffer, length, 0);
+    if (length < head || count < 0 || count > table_info(table)->max ||
+        length != head + (size_t)count * table_info(table)->record_size) {
+        return -1;
+    }
+    if (generation != NULL) *generation = has_header ? header.generation : 0;
+    return (int)length;
+}
+
+/* Picks up other processes' saves, reading only the records they changed. */
+static int file_refresh(TableId table) {
+    TableShadow* shadow = shadow_for(table, 0);
+    char buffer[64];
+    FILE* file = shadow != NULL ? fopen(table_path(table, buffer, sizeof(buffer)), "rb") : NULL;
+    if (file == NULL) {
+        return shadow != NULL ? 0 : -1;
+    }
+    file_lock(file, false);
+
+    FileHeader header;
+    uint32_t first, last;
+    int result = 0;
+    int from = -1;      /* Records before it are unchanged, -1 after a whole read */
+    if (header_read(file, &header) && (shadow->stale || header.generation != shadow->generation)) {
+        // After a lost save only a whole read brings the image back in line with the file
+        result = 1;
+        if (shadow->stale || !header_changes_since(&header, shadow->generation, &first, &last) ||
+            file_read_changes(file, table, first, last) != 0) {
+            size_t size = file_image_length(file, true, table);
+            long length = shadow_for(table, size) != NULL ? file_read_image(file, true, shadow->image, size) : -1;
+            if (length < 0) result = -1;
+            else shadow->length = (size_t)length;
+        } else {
+            from = (int)first;
+        }
+        shadow->generation = header.generation;
+        shadow->stale = false;
+    }
+    fclose(file);
+
+    if (result == 1 && (table == TABLE_APPOINTMENTS && from >= 0
+                            ? appointments_refresh(shadow->image, shadow->length, from)
+                            : storage_apply(table, shadow->image, shadow->length)) != 0) {
+        // Unreadable: keep what we have and read the whole file next time
+        int length = shadow_for(table, image_length(table)) != NULL
+                         ? storage_encode(table, shadow->image, shadow->capacity) : -1;
+        shadow->length = length < 0 ? 0 : (size_t)length;
+        shadow->generation = 0;
+        result = -1;
+    }
+    return result;
+}
+
+/* Applies the outcome of a save on the UI side. */
+static void save_finish(const SaveResult* result) {
+    TableShadow* shadow = &shadows[result->table];
+    switch (result->status) {
+        case SAVE_OK:
+            // Nothing else landed in between, so the file now matches our copy
+            if (result->clean && result->base_generation == shadow->generation) {
+                shadow->generation = result->generation;
+            }
+            break;
+        case SAVE_CONFLICT:
+            // The other terminal's records come in with the next refresh
+            shadow->stale = true;
+            ui_print_error("Another terminal changed the same records first. Your change was not saved; please try again.");
+            break;
+        default:
+            // The next refresh reads the file back whole, dropping what was not written
+            shadow->stale = true;
+            ui_print_error("Could not write to the data files. Recent changes may not be saved.");
+            break;
+    }
+}
+
+/*
+ *==========================================================================
+ *                            BACKGROUND WRITER
+ *==========================================================================
+ */
+
+#ifndef _WIN32
+
+static void ring_wait(void) {
+    struct timespec pause = { 0, 1000000 };    /* 1 ms */
+    nanosleep(&pause, NULL);
+}
+
+/* Takes every finished save off the result ring; returns how many failed. */
+static int writer_drain(void) {
+    int failed = 0;
+    unsigned int tail = atomic_load_explicit(&result_tail, memory_order_relaxed);
+    while (tail != atomic_load_explicit(&result_head, memory_order_acquire)) {
+        SaveResult* result = &results[tail & (STORAGE_QUEUE_SIZE - 1)];
+        save_finish(result);
+        if (result->status != SAVE_OK) failed++;
+        tail++;
+        atomic_store_explicit(&result_tail, tail, memory_order_release);
+    }
+    return failed;
+}
+
+static void* writer_thread(void* arg) {
+    (void)arg;
+    unsigned int tail = 0;
+    SaveResult done[STORAGE_QUEUE_SIZE];
+
+    while (1) {
+        while (sem_wait(&jobs_ready) == -1 && errno == EINTR) {
+        }
+        unsigned int head = atomic_load_explicit(&job_head, memory_order_acquire);
+        if (tail == head) continue;
+
+        // Everything queued by now is written, then synced together: one fsync per file, journal included
+        int n = 0;
+        storage_io_group_begin();
+        for (unsigned int next = tail; next != head; next++) {
+            const SaveJob* job = &jobs[next & (STORAGE_QUEUE_SIZE - 1)];
+            SaveResult* result = &done[n++];
+            *result = (SaveResult){ job->table, SAVE_FAILED, job->base_generation, 0, false };
+            MetricsTimer timer = metrics_begin();
+            result->status = file_write(job, &result->generation, &result->clean);
+            metrics_end(METRIC_STORAGE_WRITE, timer, result->status == SAVE_OK);
+        }
+        bool synced = storage_io_group_end() == 0;
+
+        for (int i = 0; i < n; i++) {
+            if (!synced && done[i].status == SAVE_OK) done[i].status = SAVE_FAILED;
+
+            // Results are few and drained on every menu; wait rather than drop one
+            unsigned int result_at = atomic_load_explicit(&result_head, memory_order_relaxed);
+            while (result_at - atomic_load_explicit(&result_tail, memory_order_acquire) == STORAGE_QUEUE_SIZE) {
+                ring_wait();
+            }
+            results[result_at & (STORAGE_QUEUE_SIZE - 1)] = done[i];
+            atomic_store_explicit(&result_head, result_at + 1, memory_order_release);
+
+            // The slot is reused once job_tail moves past it
+            tail++;
+            atomic_store_explicit(&job_tail, tail, memory_order_release);
+            atomic_fetch_sub(&pending[done[i].table], 1);
+        }
+    }
+    return NULL;
+}
+
+#endif
+
+/* Hands a save to the writer thread, or writes it now if there is none. */
+static int file_save(TableId table) {
+    TableShadow* shadow = shadow_for(table, image_length(table));
+    SaveJob* job = &sync_job;
+    if (shadow == NULL) return -1;
+
+    #ifndef _WIN32
+        unsigned int head = 0;
+        if (writer_running) {
+            head = atomic_load_explicit(&job_head, memory_order_relaxed);
+            while (head - atomic_load_explicit(&job_tail, memory_order_acquire) == STORAGE_QUEUE_SIZE) {
+                writer_drain();
+                ring_wait();
+            }
+            job = &jobs[head & (STORAGE_QUEUE_SIZE - 1)];
+        }
+    #endif
+
+    // The writer is done with this slot, so it may grow
+    if (image_reserve(&job->image, &job->capacity, image_length(table)) == NULL) return -1;
+    int length = storage_encode(table, job->image, job->capacity);
+    if (length < 0) return -1;
+    if (shadow->generation != 0 && !shadow->stale && (size_t)length == shadow->length &&
+        memcmp(job->image, shadow->image, shadow->length) == 0) {
+        return 0;   /* Nothing changed */
+    }
+
+    job->table = table;
+    job->length = (size_t)length;
+    job->base_generation = shadow->generation;
+    job->base_count = image_int(shadow->image, shadow->length, 0);
+    job->base_available = image_int(shadow->image, shadow->length, 1);
+    shadow_diff(table, job->image, job->length, &job->first, &job->last);
+    if (shadow->stale) {
+        // Saved before the refresh: records lost with the last save look unchanged, so write them all
+        job->first = 0;
+        job->last = (uint32_t)image_int(job->image, job->length, 0);
+        shadow->stale = false;
+    }
+
+    // From here on the shadow is our copy as it will be once written
+    memcpy(shadow->image, job->image, job->length);
+    shadow->length = job->length;
+
+    #ifndef _WIN32
+        if (writer_running) {
+            atomic_fetch_add(&pending[table], 1);
+            atomic_store_explicit(&job_head, head + 1, memory_order_release);
+            sem_post(&jobs_ready);
+            return 0;
+        }
+    #endif
+
+    SaveResult result = { table, SAVE_FAILED, job->base_generation, 0, false };
+    MetricsTimer timer = metrics_begin();
+    result.status = file_write(job, &result.generation, &result.clean);
+    metrics_end(METRIC_STORAGE_WRITE, timer, result.status == SAVE_OK);
+    save_finish(&result);
+    if (result.status != SAVE_OK) {
+        file_refresh(table);
+    }
+    return result.status == SAVE_OK ? 0 : -1;
+}
+
+int storage_start_writer(void) {
+    #ifdef _WIN32
+        return -1;
+    #else
+        if (remote || writer_running) return -1;
+
+        pthread_t thread;
+        if (sem_init(&jobs_ready, 0, 0) != 0) return -1;
+        if (pthread_create(&thread, NULL, writer_thread, NULL) != 0) {
+            sem_destroy(&jobs_ready);
+            return -1;
+        }
+        pthread_detach(thread);
+        writer_running = true;
+        return 0;
+    #endif
+}
+
+int storage_flush(void) {
+    int failed = 0;
+    #ifndef _WIN32
+        if (!writer_running) return 0;
+
+        while (atomic_load_explicit(&job_tail, memory_order_acquire) !=
+               atomic_load_explicit(&job_head, memory_order_relaxed)) {
+            failed += writer_drain();
+            ring_wait();
+        }
+        failed += writer_drain();
+        if (failed > 0) ui_pause();
+    #endif
+    return failed > 0 ? -1 : 0;
+}
+
+/*
+ *==========================================================================
+ *                              SERVER CLIENT
+ *==========================================================================
+ */
+
+static void connection_lost(void) {
+    #ifndef _WIN32
+        close(server_fd);
+    #endif
+    server_fd = -1;
+    ui_print_error("Lost connection to the HMS server. Changes can no longer be saved.");
+}
+
+/* Handles one reply to a fetch of the table; returns 1 if the table changed. */
+static int fetch_reply(TableId table) {
+    TableShadow* shadow = shadow_for(table, 0);
+    MessageHeader reply;
+    if (shadow == NULL || scratch_for(image_max(table)) == NULL ||
+        server_receive_message(server_fd, &reply, image, image_capacity) != 0 || reply.table != table) {
+        return -1;
+    }
+    if (reply.op == MSG_NOT_MODIFIED) return 0;
+    if (reply.op != MSG_OK || storage_apply(table, image, reply.length) != 0 ||
+        shadow_for(table, reply.length) == NULL) {
+        return -1;
+    }
+
+    // Our next changes are diffed against what the server has
+    memcpy(shadow->image, image, reply.length);
+    shadow->length = reply.length;
+    shadow->generation = reply.generation;
+    return 1;
+}
+
+int storage_connect(const char* socket_path) {
+    #ifdef _WIN32
+        (void)socket_path;
+        return -1;
+    #else
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        signal(SIGPIPE, SIG_IGN);   /* A dead server shows up as a failed write */
+        remote = true;
+        server_fd = fd;
+        for (int t = 0; t < TABLE_COUNT; t++) {
+            shadows[t].generation = 0;
+            shadows[t].length = 0;
+        }
+        return 0;
+    #endif
+}
+
+bool storage_is_remote(void) {
+    return remote;
+}
+
+int storage_sync(void) {
+    if (!remote) {
+        int changed = 0;
+        #ifndef _WIN32
+            if (writer_running && writer_drain() > 0) ui_pause();
+        #endif
+        for (int t = 0; t < TABLE_COUNT; t++) {
+            #ifndef _WIN32
+                // Our own save is still queued; catch up once it is written
+                if (atomic_load(&pending[t]) > 0) continue;
+            #endif
+            if (file_refresh(t) > 0) changed++;
+        }
+        return changed;
+    }
+    if (server_fd < 0) return -1;
+
+    // Ask for every table at once, then read the replies: one round trip
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        if (server_send_message(server_fd, MSG_FETCH, t, shadows[t].generation, NULL, 0) != 0) {
+            connection_lost();
+            return -1;
+        }
+    }
+
+    int changed = 0;
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        int result = fetch_reply(t);
+        if (result < 0) {
+            connection_lost();
+            return -1;
+        }
+        changed += result;
+    }
+    return changed;
+}
+
+static int remote_load(TableId table) {
+    if (server_send_message(server_fd, MSG_FETCH, table, 0, NULL, 0) != 0 || fetch_reply(table) < 0) {
+        connection_lost();
+        return -1;
+    }
+    return 0;
+}
+
+/* Open-addressed positions of a table's records by ID; slots hold position + 1 */
+static int* id_index_build(const unsigned char* records, int count, size_t record_size, size_t* mask) {
+    size_t capacity = 16;
+    while (capacity < 2 * (size_t)count) capacity *= 2;
+    int* slots = calloc(capacity, sizeof(int));
+    if (slots == NULL) return NULL;
+
+    *mask = capacity - 1;
+    for (int i = 0; i < count; i++) {
+        size_t slot = ((uint32_t)record_id(records + (size_t)i * record_size) * 2654435761u) & *mask;
+        while (slots[slot] != 0) slot = (slot + 1) & *mask;
+        slots[slot] = i + 1;
+    }
+    return slots;
+}
+
+static int id_index_find(const int* slots, size_t mask, const unsigned char* records, size_t record_size, int id) {
+    size_t slot = ((uint32_t)id * 2654435761u) & mask;
+    while (slots[slot] != 0) {
+        int index = slots[slot] - 1;
+        if (record_id(records + (size_t)index * record_size) == id) return index;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+typedef struct {
+    int in_flight;
+    uint32_t generation;    /* Ours after the replies so far, if nobody else changed the table */
+    bool in_step;           /* Every change so far got the next generation */
+    int stale;
+    int failed;
+} ChangeBatch;
+
+static int change_reply(ChangeBatch* batch) {
+    // Replies to changes carry no payload, and the table being sent is in image
+    MessageHeader reply;
+    if (server_receive_message(server_fd, &reply, NULL, 0) != 0) return -1;
+
+    batch->in_flight--;
+    if (reply.op == MSG_STALE) batch->stale++;
+    else if (reply.op != MSG_OK) batch->failed++;
+    if (reply.op == MSG_OK && reply.generation == batch->generation + 1) {
+        batch->generation++;
+    } else {
+        batch->in_step = false;
+    }
+    return 0;
+}
+
+/* Sends one record change, first reading a reply if the window is full. */
+static int change_send(ChangeBatch* batch, int op, TableId table, int available,
+                       const unsigned char* record, size_t size) {
+    unsigned char payload[sizeof(RecordChange) + RECORD_SIZE_MAX];
+    RecordChange change = { available };
+    memcpy(payload, &change, sizeof(change));
+    memcpy(payload + sizeof(change), record, size);
+
+    if (batch->in_flight == CHANGES_IN_FLIGHT && change_reply(batch) != 0) return -1;
+    if (server_send_message(server_fd, op, table, shadows[table].generation, payload,
+                            (uint32_t)(sizeof(change) + size)) != 0) {
+        return -1;
+    }
+    batch->in_flight++;
+    return 0;
+}
+
+/* Sends a change for every record added, changed or removed since the shadow. */
+static int changes_send(ChangeBatch* batch, TableId table, const unsigned char* data, size_t length) {
+    const TableShadow* shadow = &shadows[table];
+    size_t head = image_header_size(table);
+    size_t record_size = table_info(table)->record_size;
+    int count = image_int(data, length, 0);
+    int base_count = image_int(shadow->image, shadow->length, 0);
+    const unsigned char* records = data + head;
+    const unsigned char* base = shadow->image + head;
+
+    // The move of the available count rides on the first change
+    int available = head > sizeof(int) ? image_int(data, length, 1) - image_int(shadow->image, shadow->length, 1) : 0;
+
+    size_t mask;
+    int* slots = id_index_build(base, base_count, record_size, &mask);
+    bool* kept = calloc((size_t)base_count + 1, sizeof(bool));
+    int result = slots != NULL && kept != NULL ? 0 : -1;
+
+    for (int i = 0; i < count && result == 0; i++) {
+        const unsigned char* record = records + (size_t)i * record_size;
+        int index = id_index_find(slots, mask, base, record_size, record_id(record));
+        if (index != -1) kept[index] = true;
+        if (index != -1 && memcmp(record, base + (size_t)index * record_size, record_size) == 0) continue;
+
+        result = change_send(batch, index == -1 ? MSG_ADD : MSG_UPDATE, table, available, record, record_size);
+        available = 0;
+    }
+    for (int i = 0; i < base_count && result == 0; i++) {
+        if (kept[i]) continue;
+        result = change_send(batch, MSG_DELETE, table, available, base + (size_t)i * record_size, sizeof(int));
+        available = 0;
+    }
+    free(kept);
+    free(slots);
+    return result;
+}
+
+static int remote_save(TableId table) {
+    TableShadow* shadow = shadow_for(table, image_length(table));
+    if (shadow == NULL || scratch_for(image_length(table)) == NULL) return -1;
+    int length = storage_encode(table, image, image_capacity);
+    if (length < 0) return -1;
+    if ((size_t)length == shadow->length && memcmp(image, shadow->image, shadow->length) == 0) {
+        return 0;   /* Nothing changed */
+    }
+
+    ChangeBatch batch = { 0, shadow->generation, true, 0, 0 };
+    if (changes_send(&batch, table, image, (size_t)length) != 0) {
+        connection_lost();
+        return -1;
+    }
+    while (batch.in_flight > 0) {
+        if (change_reply(&batch) != 0) {
+            connection_lost();
+            return -1;
+        }
+    }
+
+    if (batch.in_step && batch.stale == 0 && batch.failed == 0) {
+        // The server applied exactly our changes, so it now has our image
+        memcpy(shadow->image, image, (size_t)length);
+        shadow->length = (size_t)length;
+        shadow->generation = batch.generation;
+        return 0;
+    }
+
+    // Someone else changed the table too, or a change was refused: take the server's copy
+    if (batch.stale > 0) {
+        ui_print_error("Another terminal changed the same records first. Your change was not saved; please try again.");
+    }
+    if (batch.failed > 0) {
+        ui_print_error("The HMS server could not write its data files.");
+    }
+    if (remote_load(table) != 0) return -1;
+    return batch.stale == 0 && batch.failed == 0 ? 0 : -1;
+}
+
+int storage_refresh_record(TableId table, int id) {
+    if (!remote) {
+        #ifndef _WIN32
+            // Our own save is still queued; the next sync catches up
+            if (atomic_load(&pending[table]) > 0) return 0;
+        #endif
+        return file_refresh(table) < 0 ? -1 : 0;
+    }
+    if (server_fd < 0) return -1;
+
+    if (scratch_for(table_info(table)->record_size) == NULL) return -1;
+
+    MessageHeader reply;
+    if (server_send_message(server_fd, MSG_GET, table, 0, &id, sizeof(id)) != 0 ||
+        server_receive_message(server_fd, &reply, image, image_capacity) != 0) {
+        connection_lost();
+        return -1;
+    }
+
+    // Compared with the server's copy as we last had it, not with unsaved edits
+    const TableShadow* shadow = &shadows[table];
+    size_t record_size = table_info(table)->record_size;
+    int index = storage_find_record(table, shadow->image, shadow->length, id);
+    bool current = reply.generation == shadow->generation ||
+                   (reply.op == MSG_NOT_FOUND && index == -1) ||
+                   (reply.op == MSG_OK && index != -1 && reply.length == record_size &&
+                    memcmp(image, shadow->image + image_header_size(table) + (size_t)index * record_size,
+                           record_size) == 0);
+    if (current) return 0;
+
+    // Fetching the table also brings its counts and everything derived from it up to date
+    if (server_send_message(server_fd, MSG_FETCH, table, shadow->generation, NULL, 0) != 0 || fetch_reply(table) < 0) {
+        connection_lost();
+        return -1;
+    }
+    return 0;
+}
+
+int storage_search(TableId table, const char* name, void* records, int max) {
+    if (!remote || server_fd < 0 || table == TABLE_APPOINTMENTS || scratch_for(image_max(table)) == NULL) return -1;
+
+    MessageHeader reply;
+    if (server_send_message(server_fd, MSG_SEARCH, table, 0, name, (uint32_t)strlen(name) + 1) != 0 ||
+        server_receive_message(server_fd, &reply, image, image_capacity) != 0) {
+        connection_lost();
+        return -1;
+    }
+    if (reply.op != MSG_OK) return -1;
+
+    size_t record_size = table_info(table)->record_size;
+    int found = (int)(reply.length / record_size);
+    if (found > max) found = max;
+    memcpy(records, image, (size_t)found * record_size);
+    return found;
+}
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+int storage_save(TableId table) {
+    if (!remote) return file_save(table);
+    if (server_fd < 0) {
+        // Never fall back to the files: the server may still be running
+        ui_print_error("Not connected to the HMS server. Changes can no longer be saved.");
+        return -1;
+    }
+    return remote_save(table);
+}
+
+int storage_load(TableId table) {
+    if (!remote) return file_load(table);
+    return server_fd < 0 ? -1 : remote_load(table);
+}
@@ -0,0 +1,374 @@
+/**
+ * @file storage_io.c
+ * @brief Data file write backends implementation for Healthcare Management System
+ *
+ * The io_uring backend talks to the kernel through the raw system calls,
+ * so no liburing is needed. The ring is created on first use; if setup
+ * fails (old kernel, seccomp) or the kernel rejects an opcode, the backend
+ * quietly drops to pwrite for the rest of the run.
+ *
+ * Inside a group a durable commit keeps a duplicate of its descriptor
+ * instead of syncing, one per file, and the end of the group syncs them
+ * all: under io_uring as one submission of fsyncs.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../include/storage_io.h"
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <errno.h>
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+#endif
+
+static StorageIoBackend backend = STORAGE_IO_STDIO;
+static bool durable = true;
+
+#ifndef _WIN32
+/* A file waiting for the fsync at the end of the group */
+typedef struct {
+    int fd;                 /* Our own duplicate, closed once synced */
+    dev_t dev;
+    ino_t ino;
+} GroupFile;
+
+static _Thread_local bool grouping = false;
+static _Thread_local GroupFile group[STORAGE_IO_GROUP];
+static _Thread_local int group_count = 0;
+#endif
+
+/*
+ *==========================================================================
+ *                              STDIO AND PWRITE
+ *==========================================================================
+ */
+
+static int stdio_commit(FILE* file, const StorageWrite* writes, int count, long size, bool sync) {
+    if (fflush(file) != 0) return -1;
+    #ifdef _WIN32
+        if (_chsize(_fileno(file), size) != 0) return -1;
+    #else
+        if (ftruncate(fileno(file), size) != 0) return -1;
+    #endif
+
+    for (int i = 0; i < count; i++) {
+        if (i == count - 1 && fflush(file) != 0) return -1;    /* Header after the rest */
+        if (fseek(file, writes[i].offset, SEEK_SET) != 0 ||
+            fwrite(writes[i].data, 1, writes[i].length, file) != writes[i].length) {
+            return -1;
+        }
+    }
+    if (fflush(file) != 0) return -1;
+
+    #ifdef _WIN32
+        return sync ? _commit(_fileno(file)) : 0;
+    #else
+        return sync ? fsync(fileno(file)) : 0;
+    #endif
+}
+
+#ifndef _WIN32
+
+static int pwrite_full(int fd, const StorageWrite* write) {
+    const unsigned char* p = write->data;
+    size_t left = write->length;
+    off_t offset = write->offset;
+
+    while (left > 0) {
+        ssize_t n = pwrite(fd, p, left, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        offset += n;
+        left -= (size_t)n;
+    }
+    return 0;
+}
+
+static int pwrite_commit(int fd, const StorageWrite* writes, int count, long size, bool sync) {
+    if (ftruncate(fd, size) != 0) return -1;
+    for (int i = 0; i < count; i++) {
+        if (pwrite_full(fd, &writes[i]) != 0) return -1;
+    }
+    return sync ? fsync(fd) : 0;
+}
+
+/* Leaves a committed file to be synced at the end of the group. */
+static int group_add(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    for (int i = 0; i < group_count; i++) {
+        if (group[i].dev == st.st_dev && group[i].ino == st.st_ino) return 0;
+    }
+    int copy = group_count < STORAGE_IO_GROUP ? dup(fd) : -1;
+    if (copy < 0) return fsync(fd);     /* No room: sync it now */
+    group[group_count++] = (GroupFile){ copy, st.st_dev, st.st_ino };
+    return 0;
+}
+
+#endif
+
+/*
+ *==========================================================================
+ *                                  IO_URING
+ *==========================================================================
+ */
+
+#ifdef __linux__
+
+typedef struct {
+    int fd;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+} Ring;
+
+static Ring ring = { -1, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+static bool ring_failed = false;
+
+static int ring_setup(void) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = (int)syscall(__NR_io_uring_setup, STORAGE_IO_GROUP, &params);
+    if (fd < 0) return -1;
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && cq_size > sq_size) sq_size = cq_size;
+
+    unsigned char* sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             fd, IORING_OFF_SQ_RING);
+    unsigned char* cq = single ? sq : mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           fd, IORING_OFF_CQ_RING);
+    void* sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    ring.fd = fd;
+    ring.sq_head = (unsigned*)(sq + params.sq_off.head);
+    ring.sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring.sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring.sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring.cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring.cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring.cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring.sqes = sqes;
+    ring.cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+static void ring_push(int op, int fd, const StorageWrite* write, unsigned flags, unsigned long long tag) {
+    unsigned tail = *ring.sq_tail;
+    unsigned index = tail & *ring.sq_mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (unsigned char)op;
+    sqe->fd = fd;
+    sqe->flags = (unsigned char)flags;
+    sqe->user_data = tag;
+    if (write != NULL) {
+        sqe->addr = (unsigned long long)(uintptr_t)write->data;
+        sqe->len = (unsigned)write->length;
+        sqe->off = (unsigned long long)write->offset;
+    }
+    ring.sq_array[index] = index;
+    __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Waits for the submitted entries and reaps exactly those, even after a
+ * failure, to keep the ring clean. Entries tagged below count are the
+ * writes. Returns 1 if the kernel does not support an opcode.
+ */
+static int ring_run(int submitted, const StorageWrite* writes, int count) {
+    int entered;
+    do {
+        entered = (int)syscall(__NR_io_uring_enter, ring.fd, submitted, submitted,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+    } while (entered < 0 && errno == EINTR);
+    if (entered < 0) return -1;
+
+    int result = 0;
+    for (int reaped = 0; reaped < submitted; reaped++) {
+        unsigned head = *ring.cq_head;
+        while (head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            if (syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 &&
+                errno != EINTR) {
+                return -1;
+            }
+        }
+        const struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cq_mask];
+        int tag = (int)cqe->user_data;
+        if (cqe->res == -EINVAL || cqe->res == -EOPNOTSUPP) {
+            result = 1;
+        } else if (result == 0 && (cqe->res < 0 ||
+                   (tag < count && (size_t)cqe->res != writes[tag].length))) {
+            result = -1;
+        }
+        __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+    }
+    if (result == 1) ring_failed = true;
+    return result;
+}
+
+/*
+ * One submission: every data write, then the header once they are all
+ * done (IOSQE_IO_DRAIN), then an fsync linked to the header. Returns 1 if
+ * the kernel does not support the opcodes, so the caller can fall back.
+ */
+static int uring_commit(int fd, const StorageWrite* writes, int count, long size, bool sync) {
+    if (ring.fd < 0 && (ring_failed || ring_setup() != 0)) {
+        ring_failed = true;
+        return 1;
+    }
+    if (ftruncate(fd, size) != 0) return -1;
+
+    for (int i = 0; i < count; i++) {
+        unsigned flags = 0;
+        if (i == count - 1) flags = IOSQE_IO_DRAIN | (sync ? IOSQE_IO_LINK : 0);
+        ring_push(IORING_OP_WRITE, fd, &writes[i], flags, (unsigned long long)i);
+    }
+    int submitted = count;
+    if (sync) {
+        ring_push(IORING_OP_FSYNC, fd, NULL, 0, (unsigned long long)count);
+        submitted++;
+    }
+    return ring_run(submitted, writes, count);
+}
+
+/* Syncs the group's files with one submission; returns 1 to fall back as above. */
+static int uring_sync(void) {
+    if (ring.fd < 0) return 1;
+    for (int i = 0; i < group_count; i++) {
+        ring_push(IORING_OP_FSYNC, group[i].fd, NULL, 0, (unsigned long long)i);
+    }
+    return ring_run(group_count, NULL, 0);
+}
+
+#endif
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+StorageIoBackend storage_io_select(StorageIoBackend wanted) {
+    #ifdef _WIN32
+        (void)wanted;
+        backend = STORAGE_IO_STDIO;
+    #elif defined(__linux__)
+        backend = wanted;
+        if (backend == STORAGE_IO_URING && ring.fd < 0 && (ring_failed || ring_setup() != 0)) {
+            ring_failed = true;
+            backend = STORAGE_IO_PWRITE;
+        }
+    #else
+        backend = wanted == STORAGE_IO_URING ? STORAGE_IO_PWRITE : wanted;
+    #endif
+    return backend;
+}
+
+int storage_io_select_name(const char* name) {
+    for (int b = STORAGE_IO_STDIO; b <= STORAGE_IO_URING; b++) {
+        if (strcmp(name, storage_io_name(b)) == 0) {
+            storage_io_select(b);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+StorageIoBackend storage_io_backend(void) {
+    return backend;
+}
+
+const char* storage_io_name(StorageIoBackend b) {
+    switch (b) {
+        case STORAGE_IO_PWRITE: return "pwrite";
+        case STORAGE_IO_URING:  return "uring";
+        default:                return "stdio";
+    }
+}
+
+void storage_io_set_durable(bool on) {
+    durable = on;
+}
+
+int storage_io_commit(FILE* file, const StorageWrite* writes, int count, long size) {
+    if (count > STORAGE_IO_BATCH) return -1;
+
+    #ifdef _WIN32
+        return stdio_commit(file, writes, count, size, durable);
+    #else
+        int fd = fileno(file);
+        bool sync = durable && !grouping;
+        int result;
+        if (backend == STORAGE_IO_STDIO) {
+            result = stdio_commit(file, writes, count, size, sync);
+        } else {
+            if (fflush(file) != 0) return -1;
+            result = 1;
+            #ifdef __linux__
+                if (backend == STORAGE_IO_URING) {
+                    result = uring_commit(fd, writes, count, size, sync);
+                    if (result == 1) backend = STORAGE_IO_PWRITE;     /* Not supported after all */
+                }
+            #endif
+            if (result == 1) result = pwrite_commit(fd, writes, count, size, sync);
+        }
+        if (result == 0 && durable && grouping) result = group_add(fd);
+        return result;
+    #endif
+}
+
+void storage_io_group_begin(void) {
+    #ifndef _WIN32
+        grouping = true;
+    #endif
+}
+
+int storage_io_group_end(void) {
+    #ifdef _WIN32
+        return 0;
+    #else
+        grouping = false;
+        int result = 0;
+        bool one_by_one = true;
+        #ifdef __linux__
+            if (backend == STORAGE_IO_URING && group_count > 0) {
+                int synced = uring_sync();
+                if (synced == 1) backend = STORAGE_IO_PWRITE;
+                else if (synced < 0) result = -1;
+                one_by_one = synced == 1;
+            }
+        #endif
+        for (int i = 0; i < group_count; i++) {
+            if (one_by_one && fsync(group[i].fd) != 0) result = -1;
+            close(group[i].fd);
+        }
+        group_count = 0;
+        return result;
+    #endif
+}
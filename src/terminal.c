@@ -0,0 +1,367 @@
+/**
+ * @file terminal.c
+ * @brief Terminal output backend implementation for Healthcare Management System
+ *
+ * On Linux, stdout is swapped for a fopencookie() stream, so everything
+ * printed reaches screen_write() a line at a time. While the rows are
+ * tracked, each finished line is compared with the line the previous
+ * screen drew on the same row. A line can be stepped over only if it
+ * sends no escape sequence other than colours and leaves no colour set.
+ * Otherwise a skipped line could change how the next line looks.
+ */
+
+#ifdef __linux__
+    #define _GNU_SOURCE     /* fopencookie() */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/terminal.h"
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <signal.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+#endif
+
+#define ENTER_ALTERNATE     "\033[?1049h\033[H\033[2J"
+#define LEAVE_ALTERNATE     "\033[0m\033[?1049l"
+#define CLEAR_SCREEN        "\033[H\033[2J"
+#define ERASE_BELOW         "\033[J"
+#define ERASE_LINE_END      "\033[K"
+
+static bool opened;
+
+#ifdef __linux__
+
+typedef struct {
+    size_t offset;          /* In the screen's text */
+    size_t length;
+    int row;                /* Row the line starts on */
+} ScreenLine;
+
+typedef struct {
+    char text[TERMINAL_SCREEN_SIZE];
+    size_t used;
+    ScreenLine lines[TERMINAL_ROWS_MAX];
+    int count;
+} Screen;
+
+static Screen screens[2];
+static Screen* previous = &screens[0];
+static Screen* current = &screens[1];
+static int known;                   /* Lines of the previous screen still where they were drawn */
+static bool tracking;               /* The rows of the current screen are known */
+static bool scrolled;               /* The current screen may have moved up */
+static bool styled;                 /* A colour is still set at the cursor */
+static int row;                     /* Row of the cursor, estimated once not tracking */
+
+static char line[TERMINAL_LINE_MAX];
+static size_t line_length;
+static char out[2 * TERMINAL_LINE_MAX];
+static size_t out_length;
+
+static int height = 24;
+static int width = 80;
+static volatile sig_atomic_t resized = 1;
+
+static FILE* real_stdout;           /* stdout while the backend stands in for it */
+static FILE* stream;
+
+/*
+ *==========================================================================
+ *                              OUTPUT
+ *==========================================================================
+ */
+
+static void out_flush(void) {
+    size_t done = 0;
+    while (done < out_length) {
+        ssize_t n = write(STDOUT_FILENO, out + done, out_length - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += (size_t)n;
+    }
+    out_length = 0;
+}
+
+static void out_put(const char* data, size_t size) {
+    while (size > 0) {
+        if (out_length == sizeof(out)) out_flush();
+        size_t copy = sizeof(out) - out_length < size ? sizeof(out) - out_length : size;
+        memcpy(out + out_length, data, copy);
+        out_length += copy;
+        data += copy;
+        size -= copy;
+    }
+}
+
+static void size_query(void) {
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        height = size.ws_row;
+        width = size.ws_col;
+    }
+    resized = 0;
+}
+
+/*
+ *==========================================================================
+ *                              SCREEN MODEL
+ *==========================================================================
+ */
+
+/*
+ * Rows the line takes on screen, or -1 if it moves the cursor in a way
+ * not followed here. Updates styled to the colour state after the line
+ * and clears *reusable if the line cannot be stepped over.
+ */
+static int line_rows(const char* text, size_t length, bool* reusable) {
+    int columns = 0;
+    if (styled) *reusable = false;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        if (c == '\033') {
+            size_t start = i;
+            if (i + 1 >= length || text[i + 1] != '[') return -1;
+            for (i += 2; i < length && (text[i] < 0x40 || text[i] > 0x7E); i++);
+            if (i == length) return -1;
+            if (text[i] != 'm') *reusable = false;
+            else styled = !(i - start == 2 || (i - start == 3 && text[start + 2] == '0'));
+        } else if (c == '\t') {
+            columns = (columns / 8 + 1) * 8;
+        } else if (c < 0x20 || c == 0x7F) {
+            return -1;
+        } else if ((c & 0xC0) != 0x80) {
+            columns++;      // One column per UTF-8 character
+        }
+    }
+    if (styled) *reusable = false;
+    return columns == 0 ? 1 : (columns - 1) / width + 1;
+}
+
+/* Stops tracking: the rest of the old screen is erased and the pending text sent. */
+static void untrack(void) {
+    tracking = false;
+    out_put(ERASE_BELOW, sizeof(ERASE_BELOW) - 1);
+    out_put(line, line_length);
+    row += (int)(line_length / (size_t)width);
+    line_length = 0;
+}
+
+static void line_finish(void) {
+    bool reusable = true;
+    int rows = line_rows(line, line_length, &reusable);
+
+    if (rows < 0 || row + rows >= height || current->count == TERMINAL_ROWS_MAX ||
+        current->used + line_length > sizeof(current->text)) {
+        tracking = false;
+        out_put(ERASE_BELOW, sizeof(ERASE_BELOW) - 1);
+        out_put(line, line_length);
+        out_put("\n", 1);
+        row += rows < 0 ? 1 : rows;
+        line_length = 0;
+        return;
+    }
+
+    int index = current->count;
+    const ScreenLine* old = &previous->lines[index];
+    if (reusable && index < known && old->row == row && old->length == line_length &&
+        memcmp(previous->text + old->offset, line, line_length) == 0) {
+        for (int r = 0; r < rows; r++) out_put("\n", 1);
+    } else {
+        out_put(line, line_length);
+        out_put(ERASE_LINE_END "\n", sizeof(ERASE_LINE_END));
+    }
+
+    ScreenLine* entry = &current->lines[index];
+    entry->offset = current->used;
+    entry->length = line_length;
+    entry->row = row;
+    memcpy(current->text + current->used, line, line_length);
+    current->used += line_length;
+    current->count++;
+
+    row += rows;
+    line_length = 0;
+}
+
+/* Everything written to stdout comes through here, under the stream's lock. */
+static void screen_write(const char* data, size_t size) {
+    size_t i = 0;
+    for (; i < size && tracking; i++) {
+        if (data[i] == '\n') {
+            line_finish();
+        } else if (line_length == sizeof(line)) {
+            untrack();
+            break;
+        } else {
+            line[line_length++] = data[i];
+        }
+    }
+    // Text left on an unfinished line is usually a prompt: the program is about to read
+    if (tracking && line_length > 0) {
+        untrack();
+        row++;          // For the Enter the terminal will echo
+    } else if (!tracking && i < size) {
+        out_put(data + i, size - i);
+        for (; i < size; i++) {
+            if (data[i] == '\n') row++;
+        }
+        if (data[size - 1] != '\n') row++;
+    }
+    if (row >= height) scrolled = true;
+    out_flush();
+}
+
+static ssize_t stream_write(void* cookie, const char* data, size_t size) {
+    (void)cookie;
+    if (size > 0) screen_write(data, size);
+    return (ssize_t)size;
+}
+
+static void on_resize(int sig) {
+    (void)sig;
+    resized = 1;
+}
+
+#endif
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+#ifndef _WIN32
+static void on_fatal_signal(int sig) {
+    ssize_t ignored = write(STDOUT_FILENO, LEAVE_ALTERNATE, sizeof(LEAVE_ALTERNATE) - 1);
+    (void)ignored;
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+#endif
+
+void terminal_open(void) {
+    if (opened) return;
+    #ifdef _WIN32
+        DWORD mode;
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        if (!GetConsoleMode(console, &mode)) return;
+        SetConsoleMode(console, mode | 0x0004);     /* ENABLE_VIRTUAL_TERMINAL_PROCESSING */
+    #else
+        const char* term = getenv("TERM");
+        if (!isatty(STDOUT_FILENO) || term == NULL || strcmp(term, "dumb") == 0) return;
+    #endif
+
+    fputs(ENTER_ALTERNATE, stdout);
+    fflush(stdout);
+    opened = true;
+    atexit(terminal_close);
+
+    #ifndef _WIN32
+        signal(SIGINT, on_fatal_signal);
+        signal(SIGTERM, on_fatal_signal);
+        signal(SIGHUP, on_fatal_signal);
+    #endif
+
+    #ifdef __linux__
+        cookie_io_functions_t functions = { NULL, stream_write, NULL, NULL };
+        stream = fopencookie(NULL, "w", functions);
+        if (stream == NULL) return;
+        setvbuf(stream, NULL, _IOLBF, BUFSIZ);      // Reading stdin flushes it, as it did stdout
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = on_resize;
+        action.sa_flags = SA_RESTART;               /* A resize must not fail a pending read */
+        sigaction(SIGWINCH, &action, NULL);
+
+        real_stdout = stdout;
+        stdout = stream;
+        scrolled = true;        // Nothing is known about the screen before the first clear
+    #endif
+}
+
+void terminal_close(void) {
+    if (!opened) return;
+    fflush(stdout);
+    #ifdef __linux__
+        if (stream != NULL) {
+            stdout = real_stdout;
+            fclose(stream);
+            stream = NULL;
+        }
+    #endif
+    fputs(LEAVE_ALTERNATE, stdout);
+    fflush(stdout);
+    opened = false;
+}
+
+bool terminal_is_active(void) {
+    #ifdef __linux__
+        return stream != NULL;
+    #else
+        return false;
+    #endif
+}
+
+void terminal_clear(void) {
+    #ifdef __linux__
+        if (stream != NULL) {
+            flockfile(stream);
+            fflush(stream);
+            if (resized) {
+                size_query();
+                scrolled = true;
+            }
+            Screen* done = current;
+            current = previous;
+            previous = done;
+            known = scrolled ? 0 : previous->count;
+
+            current->used = 0;
+            current->count = 0;
+            if (styled) out_put("\033[0m", 4);
+            if (known == 0) out_put(CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+            else out_put("\033[H", 3);
+            out_flush();
+
+            tracking = true;
+            scrolled = false;
+            styled = false;
+            row = 0;
+            line_length = 0;
+            funlockfile(stream);
+            return;
+        }
+    #endif
+
+    #ifdef _WIN32
+        if (!_isatty(_fileno(stdout))) return;
+    #else
+        if (!isatty(STDOUT_FILENO)) return;
+    #endif
+    fputs(CLEAR_SCREEN, stdout);
+    fflush(stdout);
+}
+
+void terminal_write(const char* data, size_t size) {
+    #ifdef __linux__
+        if (stream != NULL) {
+            flockfile(stream);
+            fflush(stream);
+            screen_write(data, size);
+            funlockfile(stream);
+            return;
+        }
+    #endif
+    fwrite(data, 1, size, stdout);
+    fflush(stdout);
+}
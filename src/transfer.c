@@ -0,0 +1,869 @@
+/**
+ * @file transfer.c
+ * @brief Bulk import and export implementation for Healthcare Management System
+ *
+ * Import memory does not grow with the input: rows are cut from one
+ * TRANSFER_CHUNK read buffer into one TRANSFER_LINE_MAX row buffer, fields
+ * are decoded into a second buffer of the same size, and a parsed row is
+ * checked in a single scratch record before it is appended. The only
+ * allocations are the set of IDs in use and, for users, the set of
+ * usernames, both sized by the table's capacity.
+ * A CSV row may span several lines inside quotes; a JSON row is one line.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/transfer.h"
+#include "../include/patient.h"
+#include "../include/doctor.h"
+#include "../include/receptionist.h"
+#include "../include/auth.h"
+#include "../include/appointment.h"
+#include "../include/appointment_archive.h"
+#include "../include/appointment_stats.h"
+#include "../include/shard.h"
+#include "../include/utils.h"
+#include "../include/hospital.h"
+
+#define TRANSFER_MAX_FIELDS 32      /* Fields per row, known or not */
+
+#define TEXT(type, field)   COL_TEXT, offsetof(type, field), sizeof(((type*)0)->field)
+
+/*
+ *==========================================================================
+ *                              TABLE CHECKS
+ *==========================================================================
+ */
+
+static const char* patient_check(void* record) {
+    Patient* patient = record;
+    if (patient->id != 0 && patient->id < PATIENT_ID_START) return "id out of range";
+    if (!utils_is_valid_name(patient->name)) return "invalid name";
+    if (patient->age <= 0 || patient->age >= 120) return "invalid age";
+    if (!utils_is_valid_phone(patient->phone)) return "invalid phone";
+    if (!utils_is_valid_address(patient->address)) return "invalid address";
+    if (!utils_is_valid_blood_group(patient->blood_group)) return "invalid blood group";
+    utils_fix_name(patient->name);
+    utils_str_to_upper(patient->blood_group);
+    return NULL;
+}
+
+static void patient_append(const void* record) {
+    const Patient* patient = record;
+    patients[patient_count++] = *patient;
+}
+
+/* Imported IDs come in any order; sorting also recounts the active patients. */
+static int patient_save(void) {
+    shard_adopt_patients(patients, patient_count);
+    return patient_save_to_file();
+}
+
+static const char* doctor_check(void* record) {
+    Doctor* doctor = record;
+    if (doctor->id != 0 && !utils_is_valid_id(doctor->id, ROLE_DOCTOR)) return "id out of range";
+    if (!utils_is_valid_name(doctor->name)) return "invalid name";
+    if (!utils_is_valid_phone(doctor->phone)) return "invalid phone";
+    if (!utils_is_valid_email(doctor->email)) return "invalid email";
+    if (doctor->specialization[0] == '\0') return "missing specialization";
+    if (doctor->room_number < 0) return "invalid room";
+    utils_fix_name(doctor->name);
+    return NULL;
+}
+
+static void doctor_append(const void* record) {
+    const Doctor* doctor = record;
+    doctors[doctor_count++] = *doctor;
+    if (doctor->is_active) doctor_available++;
+    else doctor_unavailable++;
+}
+
+static const char* receptionist_check(void* record) {
+    Receptionist* receptionist = record;
+    if (receptionist->id != 0 && !utils_is_valid_id(receptionist->id, ROLE_RECEPTIONIST)) return "id out of range";
+    if (!utils_is_valid_name(receptionist->name)) return "invalid name";
+    if (!utils_is_valid_phone(receptionist->phone)) return "invalid phone";
+    if (!utils_is_valid_email(receptionist->email)) return "invalid email";
+    utils_fix_name(receptionist->name);
+    return NULL;
+}
+
+static void receptionist_append(const void* record) {
+    const Receptionist* receptionist = record;
+    receptionists[receptionist_count++] = *receptionist;
+    if (receptionist->is_active) receptionist_available++;
+    else receptionist_unavailable++;
+}
+
+/* Usernames in use: open addressing on user index + 1, 0 marks a free slot */
+static int* name_slots;
+static size_t name_mask;
+
+static size_t name_hash(const char* username) {
+    uint32_t hash = 2166136261u;        /* FNV-1a */
+    for (const unsigned char* c = (const unsigned char*)username; *c != '\0'; c++) {
+        hash = (hash ^ *c) * 16777619u;
+    }
+    return hash;
+}
+
+static bool name_taken(const char* username) {
+    size_t slot = name_hash(username) & name_mask;
+    while (name_slots[slot] != 0) {
+        if (strcmp(users[name_slots[slot] - 1].username, username) == 0) return true;
+        slot = (slot + 1) & name_mask;
+    }
+    return false;
+}
+
+static void name_note(int index) {
+    size_t slot = name_hash(users[index].username) & name_mask;
+    while (name_slots[slot] != 0) slot = (slot + 1) & name_mask;
+    name_slots[slot] = index + 1;
+}
+
+static const char* user_check(void* record) {
+    User* user = record;
+    if (user->role == ROLE_PATIENT) return "invalid role";
+    if (!utils_is_valid_id(user->id, user->role)) return "id does not match role";
+    if (user->username[0] == '\0') return "missing username";
+    if (user->password[0] == '\0') return "missing password";
+    if (name_taken(user->username)) return "username taken";
+    encrypt(user->password);
+    return NULL;
+}
+
+static void user_append(const void* record) {
+    const User* user = record;
+    users[user_count] = *user;
+    name_note(user_count++);
+}
+
+static const char* appointment_check(void* record) {
+    Appointment* appt = record;
+    if (appt->id != 0 && appt->id < APPOINTMENT_ID_START) return "id out of range";
+    if (patient_search_id(appt->patient_id) == -1) return "unknown patient";
+    if (doctor_search_id(appt->doctor_id) == -1) return "unknown doctor";
+    if (utils_date_key(appt->date) == 0) return "invalid date";
+    if (utils_time_minutes(appt->time_slot) == -1) return "invalid time";
+    if (appt->reason[0] == '\0') return "missing reason";
+    return NULL;
+}
+
+/* Counted as it comes in; the counter file is saved with the table. */
+static void appointment_append(const void* record) {
+    const Appointment* appt = record;
+    appointments[appointment_count++] = *appt;
+    appointment_note_id(appt->id);
+    appointment_stats_add(appt);
+}
+
+/*
+ *==========================================================================
+ *                              TABLE LAYOUTS
+ *==========================================================================
+ */
+
+static const TransferColumn patient_columns[] = {
+    { "id", COL_INT, offsetof(Patient, id), 0, 0 },
+    { "name", TEXT(Patient, name), 0 },
+    { "age", COL_INT, offsetof(Patient, age), 0, 0 },
+    { "gender", COL_GENDER, offsetof(Patient, gender), 0, COLUMN_REQUIRED },
+    { "phone", TEXT(Patient, phone), 0 },
+    { "address", TEXT(Patient, address), 0 },
+    { "blood_group", TEXT(Patient, blood_group), 0 },
+    { "active", COL_BOOL, offsetof(Patient, is_active), 0, 0 }
+};
+
+static const TransferColumn doctor_columns[] = {
+    { "id", COL_INT, offsetof(Doctor, id), 0, 0 },
+    { "name", TEXT(Doctor, name), 0 },
+    { "phone", TEXT(Doctor, phone), 0 },
+    { "email", TEXT(Doctor, email), 0 },
+    { "specialization", TEXT(Doctor, specialization), 0 },
+    { "room", COL_INT, offsetof(Doctor, room_number), 0, 0 },
+    { "available", COL_BOOL, offsetof(Doctor, is_available), 0, 0 },
+    { "active", COL_BOOL, offsetof(Doctor, is_active), 0, 0 }
+};
+
+static const TransferColumn receptionist_columns[] = {
+    { "id", COL_INT, offsetof(Receptionist, id), 0, 0 },
+    { "name", TEXT(Receptionist, name), 0 },
+    { "phone", TEXT(Receptionist, phone), 0 },
+    { "email", TEXT(Receptionist, email), 0 },
+    { "available", COL_BOOL, offsetof(Receptionist, is_available), 0, 0 },
+    { "active", COL_BOOL, offsetof(Receptionist, is_active), 0, 0 }
+};
+
+static const TransferColumn user_columns[] = {
+    { "id", COL_INT, offsetof(User, id), 0, COLUMN_REQUIRED },
+    { "username", TEXT(User, username), 0 },
+    { "role", COL_ROLE, offsetof(User, role), 0, COLUMN_REQUIRED },
+    { "active", COL_BOOL, offsetof(User, is_active), 0, 0 },
+    { "password", TEXT(User, password), COLUMN_SECRET }
+};
+
+static const TransferColumn appointment_columns[] = {
+    { "id", COL_INT, offsetof(Appointment, id), 0, 0 },
+    { "patient_id", COL_INT, offsetof(Appointment, patient_id), 0, 0 },
+    { "doctor_id", COL_INT, offsetof(Appointment, doctor_id), 0, 0 },
+    { "date", TEXT(Appointment, date), 0 },
+    { "time", TEXT(Appointment, time_slot), 0 },
+    { "reason", TEXT(Appointment, reason), 0 },
+    { "status", COL_STATUS, offsetof(Appointment, status), 0, 0 }
+};
+
+#define COLUMNS(list)   list, (int)(sizeof(list) / sizeof(list[0]))
+
+/* The id column comes first in every table */
+static const TransferTable transfer_tables[] = {
+    { "patients", COLUMNS(patient_columns), patients, &patient_count, sizeof(Patient), MAX_PATIENTS,
+      PATIENT_ID_START, AUDIT_PATIENT, patient_check, patient_append, patient_save },
+    { "doctors", COLUMNS(doctor_columns), doctors, &doctor_count, sizeof(Doctor), MAX_DOCTORS,
+      DOCTOR_ID_START, AUDIT_DOCTOR, doctor_check, doctor_append, doctor_save_to_file },
+    { "receptionists", COLUMNS(receptionist_columns), receptionists, &receptionist_count, sizeof(Receptionist),
+      MAX_RECEPTIONISTS, RECEPTIONIST_ID_START, AUDIT_RECEPTIONIST, receptionist_check, receptionist_append,
+      receptionist_save_to_file },
+    { "users", COLUMNS(user_columns), users, &user_count, sizeof(User), MAX_USERS,
+      ADMIN_ID_START, AUDIT_USER, user_check, user_append, auth_save_to_file },
+    { "appointments", COLUMNS(appointment_columns), appointments, &appointment_count, sizeof(Appointment),
+      MAX_APPOINTMENTS, APPOINTMENT_ID_START, AUDIT_APPOINTMENT, appointment_check, appointment_append,
+      appointment_save_to_file }
+};
+
+#define TRANSFER_TABLE_COUNT    (int)(sizeof(transfer_tables) / sizeof(transfer_tables[0]))
+
+/* One parsed row, whatever the table */
+typedef union {
+    Patient patient;
+    Doctor doctor;
+    Receptionist receptionist;
+    User user;
+    Appointment appointment;
+} TransferRecord;
+
+const TransferTable* transfer_table(const char* name) {
+    for (int t = 0; t < TRANSFER_TABLE_COUNT; t++) {
+        if (strcmp(transfer_tables[t].name, name) == 0) return &transfer_tables[t];
+    }
+    return NULL;
+}
+
+static bool equal_ignore_case(const char* a, const char* b) {
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return *a == '\0' && *b == '\0';
+}
+
+static const char* role_name(UserRole role) {
+    switch (role) {
+        case ROLE_ADMIN:        return "admin";
+        case ROLE_DOCTOR:       return "doctor";
+        case ROLE_RECEPTIONIST: return "receptionist";
+        case ROLE_PATIENT:      return "patient";
+        default:                return "unknown";
+    }
+}
+
+void transfer_format_field(const TransferColumn* column, const void* record, char* out, size_t size) {
+    const char* field = (const char*)record + column->offset;
+    int value;
+
+    switch (column->type) {
+        case COL_INT:
+            memcpy(&value, field, sizeof(int));
+            snprintf(out, size, "%d", value);
+            break;
+        case COL_TEXT: {
+            size_t i = 0;
+            for (; i + 1 < size && i + 1 < column->size && field[i] != '\0'; i++) {
+                out[i] = (field[i] == '\t' || field[i] == '\n' || field[i] == '\r') ? ' ' : field[i];
+            }
+            out[i] = '\0';
+            break;
+        }
+        case COL_BOOL:
+            snprintf(out, size, "%d", *(const bool*)field ? 1 : 0);
+            break;
+        case COL_GENDER:
+            memcpy(&value, field, sizeof(int));
+            snprintf(out, size, "%s", value == MALE ? "M" : "F");
+            break;
+        case COL_ROLE:
+            memcpy(&value, field, sizeof(int));
+            snprintf(out, size, "%s", role_name((UserRole)value));
+            break;
+        case COL_STATUS:
+            memcpy(&value, field, sizeof(int));
+            snprintf(out, size, "%s", appointment_status_str((AppointmentStatus)value));
+            break;
+    }
+}
+
+bool transfer_parse_field(const TransferColumn* column, void* record, const char* text) {
+    char* field = (char*)record + column->offset;
+    int value = -1;
+
+    switch (column->type) {
+        case COL_INT: {
+            char* end;
+            long number = strtol(text, &end, 10);
+            if (*text == '\0' || *end != '\0' || number < 0 || number > 0x7FFFFFFFL) return false;
+            value = (int)number;
+            break;
+        }
+        case COL_TEXT:
+            if (strlen(text) >= column->size) return false;
+            strcpy(field, text);
+            return true;
+        case COL_BOOL:
+            if (equal_ignore_case(text, "1") || equal_ignore_case(text, "true") || equal_ignore_case(text, "yes")) {
+                *(bool*)field = true;
+            } else if (equal_ignore_case(text, "0") || equal_ignore_case(text, "false") || equal_ignore_case(text, "no")) {
+                *(bool*)field = false;
+            } else {
+                return false;
+            }
+            return true;
+        case COL_GENDER:
+            if (equal_ignore_case(text, "M") || equal_ignore_case(text, "Male")) value = MALE;
+            else if (equal_ignore_case(text, "F") || equal_ignore_case(text, "Female")) value = FEMALE;
+            break;
+        case COL_ROLE:
+            for (int role = ROLE_ADMIN; role <= ROLE_PATIENT; role++) {
+                if (equal_ignore_case(text, role_name((UserRole)role))) value = role;
+            }
+            break;
+        case COL_STATUS:
+            for (int status = APPT_PENDING; status <= APPT_CANCELLED; status++) {
+                if (equal_ignore_case(text, appointment_status_str((AppointmentStatus)status))) value = status;
+            }
+            break;
+    }
+    if (value < 0) return false;
+    memcpy(field, &value, sizeof(int));
+    return true;
+}
+
+TransferFormat transfer_format_of(const char* path) {
+    const char* dot = strrchr(path, '.');
+    if (dot != NULL && (equal_ignore_case(dot, ".jsonl") || equal_ignore_case(dot, ".json"))) {
+        return TRANSFER_JSONL;
+    }
+    return TRANSFER_CSV;
+}
+
+/*
+ *==========================================================================
+ *                              EXPORT
+ *==========================================================================
+ */
+
+/* Sealed appointments come through a callback */
+static const TransferTable* export_table;
+static TransferFormat export_format;
+static FILE* export_out;
+static long export_count;
+
+static void csv_write(FILE* out, const char* text) {
+    if (strpbrk(text, ",\"") == NULL && text[0] != ' ') {
+        fputs(text, out);
+        return;
+    }
+    putc('"', out);
+    for (; *text != '\0'; text++) {
+        if (*text == '"') putc('"', out);
+        putc(*text, out);
+    }
+    putc('"', out);
+}
+
+static void json_write(FILE* out, const char* text) {
+    putc('"', out);
+    for (; *text != '\0'; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            putc('\\', out);
+            putc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            putc(c, out);
+        }
+    }
+    putc('"', out);
+}
+
+static void export_record(const void* record) {
+    const TransferTable* table = export_table;
+    char field[TRANSFER_FIELD_SIZE];
+    bool first = true;
+
+    if (export_format == TRANSFER_JSONL) putc('{', export_out);
+    for (int c = 0; c < table->column_count; c++) {
+        const TransferColumn* column = &table->columns[c];
+        if (column->flags & COLUMN_SECRET) continue;
+        transfer_format_field(column, record, field, sizeof(field));
+
+        if (!first) putc(',', export_out);
+        first = false;
+        if (export_format == TRANSFER_CSV) {
+            csv_write(export_out, field);
+        } else {
+            fprintf(export_out, "\"%s\":", column->name);
+            if (column->type == COL_INT) fputs(field, export_out);
+            else if (column->type == COL_BOOL) fputs(field[0] == '1' ? "true" : "false", export_out);
+            else json_write(export_out, field);
+        }
+    }
+    if (export_format == TRANSFER_JSONL) putc('}', export_out);
+    putc('\n', export_out);
+    export_count++;
+}
+
+static void export_sealed(const Appointment* appt) {
+    export_record(appt);
+}
+
+long transfer_export(const TransferTable* table, TransferFormat format, FILE* out) {
+    export_table = table;
+    export_format = format;
+    export_out = out;
+    export_count = 0;
+
+    if (format == TRANSFER_CSV) {
+        bool first = true;
+        for (int c = 0; c < table->column_count; c++) {
+            if (table->columns[c].flags & COLUMN_SECRET) continue;
+            if (!first) putc(',', out);
+            fputs(table->columns[c].name, out);
+            first = false;
+        }
+        putc('\n', out);
+    }
+    if (table->records == appointments) {
+        appointment_archive_for_each(export_sealed);
+    }
+    const char* record = table->records;
+    for (int i = 0; i < *table->count; i++, record += table->record_size) {
+        export_record(record);
+    }
+    return fflush(out) == 0 && !ferror(out) ? export_count : -1;
+}
+
+/*
+ *==========================================================================
+ *                              ROW READER
+ *==========================================================================
+ */
+
+typedef struct {
+    FILE* in;
+    char chunk[TRANSFER_CHUNK];
+    size_t position;
+    size_t length;
+    char row[TRANSFER_LINE_MAX];
+    size_t used;
+    bool overlong;          /* The row did not fit; its text is cut short */
+    long line;              /* Line the row starts on */
+    long next_line;
+} RowReader;
+
+static RowReader reader;
+static char decoded[TRANSFER_LINE_MAX];     /* Field values of the current row */
+
+/*
+ * Reads the next row into reader.row. A newline inside CSV quotes
+ * belongs to the row. Returns 1 for a row, 0 at the end of the input,
+ * -1 on a read error.
+ */
+static int reader_next(bool csv) {
+    bool quoted = false;
+    reader.used = 0;
+    reader.overlong = false;
+    reader.line = reader.next_line;
+
+    while (1) {
+        if (reader.position == reader.length) {
+            reader.length = fread(reader.chunk, 1, TRANSFER_CHUNK, reader.in);
+            reader.position = 0;
+            if (reader.length == 0) {
+                if (ferror(reader.in)) return -1;
+                break;
+            }
+        }
+        char c = reader.chunk[reader.position++];
+        if (c == '\n') {
+            reader.next_line++;
+            if (!quoted) {
+                if (reader.used > 0 && reader.row[reader.used - 1] == '\r') reader.used--;
+                reader.row[reader.used] = '\0';
+                return 1;
+            }
+        }
+        if (csv && c == '"') quoted = !quoted;
+        if (reader.used + 1 < TRANSFER_LINE_MAX) reader.row[reader.used++] = c;
+        else reader.overlong = true;
+    }
+
+    if (reader.used == 0 && !reader.overlong) return 0;
+    reader.row[reader.used] = '\0';
+    return 1;
+}
+
+/* Splits a CSV row into decoded[]; returns the number of fields, or -1 if malformed. */
+static int csv_split(const char* row, const char** fields) {
+    char* out = decoded;
+    int count = 0;
+
+    while (1) {
+        if (count == TRANSFER_MAX_FIELDS) return -1;
+        fields[count++] = out;
+        if (*row == '"') {
+            row++;
+            while (1) {
+                if (*row == '\0') return -1;
+                if (*row == '"') {
+                    if (row[1] != '"') break;
+                    row++;
+                }
+                *out++ = *row++;
+            }
+            row++;
+            if (*row != ',' && *row != '\0') return -1;
+        } else {
+            while (*row != ',' && *row != '\0') *out++ = *row++;
+        }
+        *out++ = '\0';
+        if (*row == '\0') return count;
+        row++;
+    }
+}
+
+static const char* skip_space(const char* p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r') p++;
+    return p;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = (char)tolower((unsigned char)c);
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+/* Decodes a JSON string (after its opening quote) into *out; returns the text after it, or NULL. */
+static const char* json_string(const char* p, char** out) {
+    char* w = *out;
+    while (*p != '"') {
+        if (*p == '\0') return NULL;
+        if (*p != '\\') {
+            *w++ = *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case '"': case '\\': case '/':
+                *w++ = *p++;
+                break;
+            case 'b': case 'f': case 'n': case 'r': case 't':
+                *w++ = ' ';     /* No control characters in the tables */
+                p++;
+                break;
+            case 'u': {
+                int code = 0;
+                for (int i = 1; i <= 4; i++) {
+                    int digit = hex_value(p[i]);
+                    if (digit < 0) return NULL;
+                    code = code * 16 + digit;
+                }
+                *w++ = code < 0x80 ? (char)code : '?';
+                p += 5;
+                break;
+            }
+            default:
+                return NULL;
+        }
+    }
+    *w++ = '\0';
+    *out = w;
+    return p + 1;
+}
+
+/*
+ * Splits a flat JSON object into decoded[]; returns the number of pairs,
+ * or -1 if malformed. A null value is returned as NULL.
+ */
+static int json_split(const char* row, const char** keys, const char** values) {
+    char* out = decoded;
+    int count = 0;
+    const char* p = skip_space(row);
+
+    if (*p++ != '{') return -1;
+    p = skip_space(p);
+    if (*p == '}') return *skip_space(p + 1) == '\0' ? 0 : -1;
+
+    while (1) {
+        if (count == TRANSFER_MAX_FIELDS || *p++ != '"') return -1;
+        keys[count] = out;
+        if ((p = json_string(p, &out)) == NULL) return -1;
+        p = skip_space(p);
+        if (*p++ != ':') return -1;
+        p = skip_space(p);
+
+        if (*p == '"') {
+            values[count] = out;
+            if ((p = json_string(p + 1, &out)) == NULL) return -1;
+        } else {
+            const char* start = p;
+            while (*p != '\0' && *p != ',' && *p != '}' && *p != ' ' && *p != '\t') p++;
+            if (p == start) return -1;
+            size_t length = (size_t)(p - start);
+            values[count] = (length == 4 && strncmp(start, "null", 4) == 0) ? NULL : out;
+            memcpy(out, start, length);
+            out[length] = '\0';
+            out += length + 1;
+        }
+        count++;
+
+        p = skip_space(p);
+        if (*p == ',') {
+            p = skip_space(p + 1);
+            continue;
+        }
+        if (*p++ != '}') return -1;
+        return *skip_space(p) == '\0' ? count : -1;
+    }
+}
+
+/*
+ *==========================================================================
+ *                              IMPORT
+ *==========================================================================
+ */
+
+/* IDs in use: open addressing, 0 marks a free slot */
+static int* id_slots;
+static size_t id_mask;
+static int next_id;
+
+static bool id_insert(int id) {
+    size_t slot = ((size_t)id * 2654435761u) & id_mask;
+    while (id_slots[slot] != 0) {
+        if (id_slots[slot] == id) return false;
+        slot = (slot + 1) & id_mask;
+    }
+    id_slots[slot] = id;
+    return true;
+}
+
+static bool id_taken(int id) {
+    size_t slot = ((size_t)id * 2654435761u) & id_mask;
+    while (id_slots[slot] != 0) {
+        if (id_slots[slot] == id) return true;
+        slot = (slot + 1) & id_mask;
+    }
+    return false;
+}
+
+static void id_note(int id) {
+    id_insert(id);
+    if (id >= next_id) next_id = id + 1;
+}
+
+static void id_note_sealed(const Appointment* appt) {
+    id_note(appt->id);
+}
+
+static int record_id(const TransferTable* table, const void* record) {
+    int id;
+    memcpy(&id, (const char*)record + table->columns[0].offset, sizeof(int));
+    return id;
+}
+
+/* Collects the IDs in use; sealed appointments keep theirs too. */
+static int ids_prepare(const TransferTable* table) {
+    size_t capacity = 64;
+    size_t needed = (size_t)table->max + (table->records == appointments ? (size_t)appointment_archive_total() : 0);
+    while (capacity < 2 * needed) capacity *= 2;
+
+    id_slots = calloc(capacity, sizeof(int));
+    if (id_slots == NULL) return -1;
+    id_mask = capacity - 1;
+    if (table->records == users) {
+        name_slots = calloc(capacity, sizeof(int));
+        if (name_slots == NULL) {
+            free(id_slots);
+            id_slots = NULL;
+            return -1;
+        }
+        name_mask = capacity - 1;
+        for (int i = 0; i < user_count; i++) name_note(i);
+    }
+    next_id = table->min_id;
+
+    const char* record = table->records;
+    for (int i = 0; i < *table->count; i++, record += table->record_size) {
+        id_note(record_id(table, record));
+    }
+    if (table->records == appointments) {
+        appointment_archive_for_each(id_note_sealed);
+    }
+    return 0;
+}
+
+/* Gives the row its ID, or a reason it cannot have the one it names. */
+static const char* id_claim(const TransferTable* table, void* record) {
+    if (*table->count >= table->max) return "table is full";
+
+    int id = record_id(table, record);
+    if (id == 0) {
+        while (id_taken(next_id)) next_id++;
+        id = next_id;
+        memcpy((char*)record + table->columns[0].offset, &id, sizeof(int));
+    } else if (id_taken(id)) {
+        return "duplicate id";
+    }
+    id_note(id);
+    return NULL;
+}
+
+static int column_named(const TransferTable* table, const char* name) {
+    for (int c = 0; c < table->column_count; c++) {
+        if (strcmp(table->columns[c].name, name) == 0) return c;
+    }
+    return -1;
+}
+
+/*
+ * Parses a row into record. map gives the column of each CSV field
+ * (-1 to ignore it). Returns why the row is rejected, or NULL.
+ */
+static const char* row_parse(const TransferTable* table, TransferFormat format, const int* map, int map_count,
+                             void* record) {
+    static char reason[64];
+    const char* keys[TRANSFER_MAX_FIELDS];
+    const char* values[TRANSFER_MAX_FIELDS];
+    bool seen[TRANSFER_MAX_FIELDS] = { false };
+
+    memset(record, 0, table->record_size);
+    for (int c = 0; c < table->column_count; c++) {
+        if (table->columns[c].type == COL_BOOL) *((char*)record + table->columns[c].offset) = true;
+    }
+
+    int count = format == TRANSFER_CSV ? csv_split(reader.row, values) : json_split(reader.row, keys, values);
+    if (count < 0) return format == TRANSFER_CSV ? "malformed CSV" : "malformed JSON";
+    if (format == TRANSFER_CSV && count != map_count) return "wrong number of fields";
+
+    for (int i = 0; i < count; i++) {
+        int c = format == TRANSFER_CSV ? map[i] : column_named(table, keys[i]);
+        if (c < 0 || values[i] == NULL) continue;
+        if (!transfer_parse_field(&table->columns[c], record, values[i])) {
+            snprintf(reason, sizeof(reason), "invalid %s", table->columns[c].name);
+            return reason;
+        }
+        seen[c] = true;
+    }
+    for (int c = 0; c < table->column_count; c++) {
+        if ((table->columns[c].flags & COLUMN_REQUIRED) && !seen[c]) {
+            snprintf(reason, sizeof(reason), "missing %s", table->columns[c].name);
+            return reason;
+        }
+    }
+    return NULL;
+}
+
+/* Maps the CSV header's fields to columns; false if it is malformed. */
+static bool header_parse(const TransferTable* table, int* map, int* map_count) {
+    const char* fields[TRANSFER_MAX_FIELDS];
+    int count = csv_split(reader.row, fields);
+    if (count < 0) return false;
+    for (int i = 0; i < count; i++) {
+        map[i] = column_named(table, fields[i]);
+    }
+    *map_count = count;
+    return true;
+}
+
+/*
+ * Saves a batch and records it as one audit event; an import of many rows
+ * would otherwise fill the ring and rotate the older history away.
+ */
+static int batch_save(const TransferTable* table, int rows, int low, int high) {
+    char summary[AUDIT_VALUE_SIZE];
+    if (table->save() != 0) return -1;
+    snprintf(summary, sizeof(summary), "%d rows, IDs %d-%d", rows, low, high);
+    audit_record(table->entity, low, AUDIT_CREATE, "import", NULL, summary);
+    return 0;
+}
+
+int transfer_import(const TransferTable* table, TransferFormat format, FILE* in, FILE* rejects,
+                    TransferStats* stats) {
+    static TransferRecord row;
+    int map[TRANSFER_MAX_FIELDS];
+    int map_count = -1;
+    bool csv = format == TRANSFER_CSV;
+    int pending = 0, status = 0, result;
+    int low = 0, high = 0;          /* IDs appended since the last save */
+
+    memset(stats, 0, sizeof(*stats));
+    if (ids_prepare(table) != 0) return -1;
+    reader.in = in;
+    reader.position = reader.length = 0;
+    reader.next_line = 1;
+
+    while ((result = reader_next(csv)) > 0) {
+        if (reader.row[0] == '\0' || reader.row[0] == '#') continue;
+
+        if (csv && map_count < 0) {
+            // The rejects file gets the same header, so it can be imported once fixed
+            if (reader.overlong || !header_parse(table, map, &map_count)) {
+                fprintf(rejects, "# line %ld: unreadable header\n", reader.line);
+                status = -1;
+                break;
+            }
+            fprintf(rejects, "%s\n", reader.row);
+            continue;
+        }
+
+        stats->rows++;
+        const char* reason = reader.overlong ? "row too long" : row_parse(table, format, map, map_count, &row);
+        if (reason == NULL) reason = table->check(&row);
+        if (reason == NULL) reason = id_claim(table, &row);
+        if (reason != NULL) {
+            stats->rejected++;
+            if (reader.overlong) fprintf(rejects, "# line %ld: %s (not copied)\n", reader.line, reason);
+            else fprintf(rejects, "# line %ld: %s\n%s\n", reader.line, reason, reader.row);
+            continue;
+        }
+
+        int id = record_id(table, &row);
+        if (pending == 0 || id < low) low = id;
+        if (pending == 0 || id > high) high = id;
+        table->append(&row);
+        stats->accepted++;
+        if (++pending == TRANSFER_BATCH) {
+            if (batch_save(table, pending, low, high) != 0) {
+                status = -1;
+                break;
+            }
+            stats->batches++;
+            pending = 0;
+        }
+    }
+    if (result < 0) status = -1;
+    if (status == 0 && pending > 0) {
+        if (batch_save(table, pending, low, high) != 0) status = -1;
+        else stats->batches++;
+    }
+
+    free(id_slots);
+    free(name_slots);
+    id_slots = NULL;
+    name_slots = NULL;
+    return status;
+}
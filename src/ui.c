@@ -9,8 +9,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <errno.h>
 #include <string.h>
 #include "../include/ui.h"
+#include "../include/terminal.h"
 #include "../include/utils.h"
 
 #ifdef _WIN32
@@ -19,48 +21,198 @@
     #include <unistd.h>
 #endif
 
-void ui_clear_screen(void) {
+/*
+ *==========================================================================
+ *                              FRAME BUFFER
+ *==========================================================================
+ */
+
+/*
+ * Menus and cards are composed here and written with one write() instead
+ * of a printf per glyph. A frame opened with ui_frame_begin() collects
+ * several cards; otherwise each menu is its own frame. Finished frames go
+ * to the selected sink, which is stdout unless a test picks another.
+ */
+static char frame[UI_FRAME_SIZE];
+static size_t frame_length;
+static int frame_depth;
+
+/* Where finished frames go; see ui_sink_select() */
+static UiSinkKind sink = UI_SINK_TERMINAL;
+static UiSinkStats sink_stats;
+static char *sink_data;
+static size_t sink_length;
+static size_t sink_capacity;
+
+static void sink_append(const char *data, size_t length) {
+    if (sink_length + length + 1 > sink_capacity) {
+        size_t capacity = sink_capacity == 0 ? 4096 : sink_capacity;
+        while (capacity < sink_length + length + 1) capacity *= 2;
+        char *grown = realloc(sink_data, capacity);
+        if (grown == NULL) return;
+        sink_data = grown;
+        sink_capacity = capacity;
+    }
+    memcpy(sink_data + sink_length, data, length);
+    sink_length += length;
+    sink_data[sink_length] = '\0';
+}
+
+static void frame_flush(void) {
+    if (frame_length == 0) return;
+    sink_stats.writes++;
+    sink_stats.bytes += frame_length;
+
+    if (sink == UI_SINK_BUFFER) {
+        sink_append(frame, frame_length);
+        frame_length = 0;
+        return;
+    }
+    if (sink == UI_SINK_NULL) {
+        frame_length = 0;
+        return;
+    }
+
+    fflush(stdout);     // Anything printed before the frame goes first
+    if (terminal_is_active()) {
+        terminal_write(frame, frame_length);
+        frame_length = 0;
+        return;
+    }
     #ifdef _WIN32
-        system("cls");
-        #else
-        system("clear");
+        fwrite(frame, 1, frame_length, stdout);
+        fflush(stdout);
+    #else
+        size_t done = 0;
+        while (done < frame_length) {
+            ssize_t n = write(STDOUT_FILENO, frame + done, frame_length - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += (size_t)n;
+        }
     #endif
+    frame_length = 0;
+}
+
+static void frame_put(const char *text, size_t length) {
+    if (frame_length + length > sizeof(frame)) frame_flush();
+    if (length > sizeof(frame)) length = sizeof(frame);
+    memcpy(frame + frame_length, text, length);
+    frame_length += length;
+}
+
+static void frame_puts(const char *text) {
+    frame_put(text, strlen(text));
+}
+
+static void frame_fill(char c, int count) {
+    if (count <= 0) return;
+    if (frame_length + (size_t)count > sizeof(frame)) frame_flush();
+    if ((size_t)count > sizeof(frame)) count = (int)sizeof(frame);
+    memset(frame + frame_length, c, (size_t)count);
+    frame_length += (size_t)count;
+}
+
+/* Repeats a glyph that may be several bytes long, doubling the copied run. */
+static void frame_repeat(const char *glyph, int count) {
+    size_t length = strlen(glyph);
+    if (count <= 0) return;
+    if (frame_length + length * (size_t)count > sizeof(frame)) frame_flush();
+    if (length * (size_t)count > sizeof(frame)) count = (int)(sizeof(frame) / length);
+
+    char *run = frame + frame_length;
+    size_t total = length * (size_t)count;
+    size_t filled = length;
+    memcpy(run, glyph, length);
+    while (filled < total) {
+        size_t copy = filled < total - filled ? filled : total - filled;
+        memcpy(run + filled, run, copy);
+        filled += copy;
+    }
+    frame_length += total;
+}
+
+static void frame_int(int value) {
+    char digits[16];
+    int length = snprintf(digits, sizeof(digits), "%d", value);
+    frame_put(digits, (size_t)length);
+}
+
+/* Prints one line of text in a colour as its own frame. */
+static void frame_message(const char *color, const char *message) {
+    ui_frame_begin();
+    frame_puts(color);
+    frame_puts("\n");
+    frame_puts(message);
+    frame_puts(RESET);
+    ui_frame_end();
+}
+
+void ui_sink_select(UiSinkKind kind) {
+    frame_flush();
+    sink = kind;
+}
+
+const char* ui_sink_buffer(size_t *length) {
+    if (length != NULL) *length = sink_length;
+    return sink_data != NULL ? sink_data : "";
+}
+
+void ui_sink_reset(void) {
+    sink_length = 0;
+    if (sink_data != NULL) sink_data[0] = '\0';
+    sink_stats.writes = 0;
+    sink_stats.bytes = 0;
+}
+
+UiSinkStats ui_sink_stats(void) {
+    return sink_stats;
+}
+
+void ui_clear_screen(void) {
+    if (sink == UI_SINK_TERMINAL) terminal_clear();
 }
 
 void ui_pause(void) {
-    printf("\nPress enter to continue...");
-    getchar();
+    ui_frame_begin();
+    frame_puts("\nPress enter to continue...");
+    ui_frame_end();
+    char line[UTILS_LINE_SIZE];
+    utils_read_line(line, sizeof(line));
 }
 
 void ui_print_header(const char *title) {
-    printf(BG_NEON_PURPLE BOLD "  %s  " RESET, title);
+    ui_frame_begin();
+    frame_puts(BG_NEON_PURPLE BOLD "  ");
+    frame_puts(title);
+    frame_puts("  " RESET);
+    ui_frame_end();
 }
 
 void ui_print_success(const char *message) {
-    printf(SOFT_GREEN "\n%s" RESET , message);
+    frame_message(SOFT_GREEN, message);
 }
 
 void ui_print_error(const char *message) {
-    printf(SOFT_RED "\n%s" RESET , message);
+    frame_message(SOFT_RED, message);
 }
 
 void ui_print_warning(const char *message) {
-    printf(SOFT_YELLOW "\n%s" RESET , message);
+    frame_message(SOFT_YELLOW, message);
 }
 
 void ui_print_info(const char *message) {
-    printf(SOFT_BLUE "\n%s" RESET , message);
+    frame_message(SOFT_BLUE, message);
 }
 
 
 void ui_print_banner(void){
     #ifdef _WIN32
-        unsigned char b = 219;  // █ Full block character (Windows)
-        #define PRINT_BLOCK(color) printf(color "%c%c" RESET, b, b)
+        const char* b = "\xDB";  // █ Full block character (Windows)
     #else
         const char* b = "█";  // UTF-8 full block (Linux/Mac)
-        #define PRINT_BLOCK(color) printf(color "%s%s" RESET, b, b)
     #endif
+    #define PRINT_BLOCK(color) frame_puts(color), frame_puts(b), frame_puts(b), frame_puts(RESET)
     
     char* hms = 
     "#####################################\n"
@@ -75,7 +227,8 @@ void ui_print_banner(void){
     "#                                   #\n"
     "#####################################\n";
     
-    printf("\n");
+    ui_frame_begin();
+    frame_puts("\n");
     
     while (*hms) {
         if (*hms == 'X') {
@@ -85,21 +238,32 @@ void ui_print_banner(void){
             PRINT_BLOCK(SOFT_GRAY);
         }
         else if (*hms == '\n') {
-            printf("\n");
+            frame_puts("\n");
         } 
         else if (isalpha(*hms)){
-            printf(BOLD CYAN "%c" RESET " ", *hms);
+            frame_puts(BOLD CYAN);
+            frame_put(hms, 1);
+            frame_puts(RESET " ");
         } 
         else {
-            printf("  ");
+            frame_puts("  ");
         }
         hms++;
     }
-    printf("\n");
+    frame_puts("\n");
+    ui_frame_end();
     
     #undef PRINT_BLOCK
 }
 
+void ui_frame_begin(void) {
+    frame_depth++;
+}
+
+void ui_frame_end(void) {
+    if (frame_depth > 0 && --frame_depth == 0) frame_flush();
+}
+
 void ui_print_menu
     (
     const char *title, 
@@ -108,26 +272,28 @@ void ui_print_menu
     int box_width
     ) {
     #ifdef _WIN32
-        unsigned char h = 205;  // ═
-        unsigned char v = 186;  // ║
-        unsigned char tl = 201; // ╔
-        unsigned char tr = 187; // ╗
-        unsigned char bl = 200; // ╚
-        unsigned char br = 188; // ╝
-        #define BOX_FMT "%c"
+        const char *h = "\xCD";     // ═
+        const char *v = "\xBA";     // ║
+        const char *tl = "\xC9";    // ╔
+        const char *tr = "\xBB";    // ╗
+        const char *bl = "\xC8";    // ╚
+        const char *br = "\xBC";    // ╝
     #else
-        const char* h = "═";
-        const char* v = "║";
-        const char* tl = "╔";
-        const char* tr = "╗";
-        const char* bl = "╚";
-        const char* br = "╝";
-        #define BOX_FMT "%s"
+        const char *h = "═";
+        const char *v = "║";
+        const char *tl = "╔";
+        const char *tr = "╗";
+        const char *bl = "╚";
+        const char *br = "╝";
     #endif
-    
-    printf(BRIGHT_BLACK BOX_FMT, tl);
-    for (int i = 0; i < box_width; i++) printf(BOX_FMT, h);
-    printf(BOX_FMT RESET "\n", tr);
+
+    ui_frame_begin();
+
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(tl);
+    frame_repeat(h, box_width);
+    frame_puts(tr);
+    frame_puts(RESET "\n");
 
     char title_upper[100];
     strncpy(title_upper, title, sizeof(title_upper) - 1);
@@ -136,33 +302,59 @@ void ui_print_menu
     
     int title_len = strlen(title_upper) + 4;
     int title_padding = (box_width - title_len) / 2;
-    printf(BRIGHT_BLACK BOX_FMT RESET, v);
-    for (int i = 0; i < title_padding; i++) printf(" ");
-    ui_print_header(title_upper);
-    for (int i = 0; i < box_width - title_padding - title_len; i++) printf(" ");
-    printf(BRIGHT_BLACK BOX_FMT RESET "\n", v);
-    
-    printf(BRIGHT_BLACK BOX_FMT RESET, v);
-    for (int i = 0; i < box_width; i++) printf(" ");
-    printf(BRIGHT_BLACK BOX_FMT RESET "\n", v);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET);
+    frame_fill(' ', title_padding);
+    frame_puts(BG_NEON_PURPLE BOLD "  ");
+    frame_puts(title_upper);
+    frame_puts("  " RESET);
+    frame_fill(' ', box_width - title_padding - title_len);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET "\n");
+
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET);
+    frame_fill(' ', box_width);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET "\n");
     
     for (int i = 0; i < item_count - 1; i++) {
         int item_len = strlen(items[i]);
-        printf(BRIGHT_BLACK BOX_FMT RESET "  " SOFT_YELLOW BOLD "%d. %s" RESET, v, i + 1, items[i]);
-        for (int j = 0; j < box_width - item_len - 5; j++) printf(" ");
-        printf(BRIGHT_BLACK BOX_FMT RESET "\n", v);
+        frame_puts(BRIGHT_BLACK);
+        frame_puts(v);
+        frame_puts(RESET "  " SOFT_YELLOW BOLD);
+        frame_int(i + 1);
+        frame_puts(". ");
+        frame_put(items[i], (size_t)item_len);
+        frame_puts(RESET);
+        frame_fill(' ', box_width - item_len - 5);
+        frame_puts(BRIGHT_BLACK);
+        frame_puts(v);
+        frame_puts(RESET "\n");
     }
     
-    printf(BRIGHT_BLACK BOX_FMT RESET, v);
-    for (int i = 0; i < box_width; i++) printf(" ");
-    printf(BRIGHT_BLACK BOX_FMT RESET "\n", v);
-    printf(BRIGHT_BLACK BOX_FMT, bl);
-    for (int i = 0; i < box_width; i++) printf(BOX_FMT, h);
-    printf(BOX_FMT RESET "\n\n", br);
-    
-    #undef BOX_FMT
-    
-    printf(BOLD SOFT_GREEN "%s" RESET, items[item_count - 1]);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET);
+    frame_fill(' ', box_width);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET "\n");
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(bl);
+    frame_repeat(h, box_width);
+    frame_puts(br);
+    frame_puts(RESET "\n\n");
+
+    frame_puts(BOLD SOFT_GREEN);
+    frame_puts(items[item_count - 1]);
+    frame_puts(RESET);
+
+    ui_frame_end();
 }
 
 void ui_print_patient(Patient patient, int index) {
@@ -286,6 +478,293 @@ void ui_print_receptionist(Receptionist receptionist, int index) {
     ui_print_menu(title, items, 7, 72);
 }
 
+/*
+ *==========================================================================
+ *                              TABLE VIEW
+ *==========================================================================
+ */
+
+/*
+ * A table is printed a page at a time. Rows are copied into the page as
+ * they come; when it is full, one pass over it sizes the columns and the
+ * page is composed in the frame buffer under its own copy of the title
+ * and headings.
+ */
+static const UiColumn *table_columns;
+static int table_column_count;
+static char table_title[100];
+static char table_page[UI_TABLE_PAGE_ROWS][UI_TABLE_MAX_COLUMNS][UI_TABLE_CELL_SIZE];
+static int table_page_rows;
+static int table_rows;          /* Rows printed on earlier pages */
+static bool table_open;
+static bool list_open;
+static int list_mode = -1;
+
+/* Display width of UTF-8 text */
+static int text_width(const char *text) {
+    int width = 0;
+    for (; *text != '\0'; text++) {
+        if (((unsigned char)*text & 0xC0) != 0x80) width++;
+    }
+    return width;
+}
+
+/* Writes text into exactly width columns, cut with "..." if it is longer. */
+static void frame_cell(const char *text, int width) {
+    int length = text_width(text);
+    if (length <= width) {
+        frame_puts(text);
+        frame_fill(' ', width - length);
+        return;
+    }
+    int keep = width > 3 ? width - 3 : width;
+    int columns = 0;
+    const char *end = text;
+    for (; *end != '\0'; end++) {
+        if (((unsigned char)*end & 0xC0) == 0x80) continue;
+        if (columns == keep) break;
+        columns++;
+    }
+    frame_put(text, (size_t)(end - text));
+    frame_fill('.', width - keep);
+}
+
+static void table_print_page(void) {
+    #ifdef _WIN32
+        const char *h = "\xCD", *v = "\xBA", *tl = "\xC9", *tr = "\xBB", *bl = "\xC8", *br = "\xBC";
+        const char *rule = "\xC4", *left = "\xC7", *right = "\xB6";
+    #else
+        const char *h = "═", *v = "║", *tl = "╔", *tr = "╗", *bl = "╚", *br = "╝";
+        const char *rule = "─", *left = "╟", *right = "╢";
+    #endif
+    int widths[UI_TABLE_MAX_COLUMNS];
+    int inner = UI_SIZE - 4;        /* Inside the border and one space of margin each side */
+
+    // One pass over the page sizes every column, capped by its limit
+    for (int c = 0; c < table_column_count; c++) {
+        widths[c] = text_width(table_columns[c].heading);
+    }
+    for (int r = 0; r < table_page_rows; r++) {
+        for (int c = 0; c < table_column_count; c++) {
+            int width = text_width(table_page[r][c]);
+            if (width > widths[c]) widths[c] = width;
+        }
+    }
+    int total = 2 * (table_column_count - 1);
+    for (int c = 0; c < table_column_count; c++) {
+        if (table_columns[c].max_width > 0 && widths[c] > table_columns[c].max_width) {
+            widths[c] = table_columns[c].max_width;
+        }
+        total += widths[c];
+    }
+    // Too wide for the box: the widest column gives way first
+    while (total > inner) {
+        int widest = 0;
+        for (int c = 1; c < table_column_count; c++) {
+            if (widths[c] > widths[widest]) widest = c;
+        }
+        if (widths[widest] <= 4) break;
+        widths[widest]--;
+        total--;
+    }
+
+    ui_frame_begin();
+
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(tl);
+    frame_repeat(h, UI_SIZE);
+    frame_puts(tr);
+    frame_puts(RESET "\n");
+
+    int title_len = strlen(table_title) + 4;
+    int title_padding = (UI_SIZE - title_len) / 2;
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET);
+    frame_fill(' ', title_padding);
+    frame_puts(BG_NEON_PURPLE BOLD "  ");
+    frame_puts(table_title);
+    frame_puts("  " RESET);
+    frame_fill(' ', UI_SIZE - title_padding - title_len);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET "\n");
+
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts(RESET "  " SOFT_YELLOW BOLD);
+    for (int c = 0; c < table_column_count; c++) {
+        frame_cell(table_columns[c].heading, widths[c]);
+        if (c + 1 < table_column_count) frame_fill(' ', 2);
+    }
+    frame_puts(RESET);
+    frame_fill(' ', UI_SIZE - 2 - total);
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(v);
+    frame_puts("\n");
+    frame_puts(left);
+    frame_repeat(rule, UI_SIZE);
+    frame_puts(right);
+    frame_puts(RESET "\n");
+
+    for (int r = 0; r < table_page_rows; r++) {
+        frame_puts(BRIGHT_BLACK);
+        frame_puts(v);
+        frame_puts(RESET "  ");
+        for (int c = 0; c < table_column_count; c++) {
+            frame_cell(table_page[r][c], widths[c]);
+            if (c + 1 < table_column_count) frame_fill(' ', 2);
+        }
+        frame_fill(' ', UI_SIZE - 2 - total);
+        frame_puts(BRIGHT_BLACK);
+        frame_puts(v);
+        frame_puts(RESET "\n");
+    }
+
+    frame_puts(BRIGHT_BLACK);
+    frame_puts(bl);
+    frame_repeat(h, UI_SIZE);
+    frame_puts(br);
+    frame_puts(RESET "\n" TEXT_MUTED "Rows ");
+    frame_int(table_rows + 1);
+    frame_puts("-");
+    frame_int(table_rows + table_page_rows);
+    frame_puts(RESET "\n");
+
+    ui_frame_end();
+
+    table_rows += table_page_rows;
+    table_page_rows = 0;
+}
+
+void ui_table_begin(const char *title, const UiColumn columns[], int column_count) {
+    table_columns = columns;
+    table_column_count = column_count < UI_TABLE_MAX_COLUMNS ? column_count : UI_TABLE_MAX_COLUMNS;
+    strncpy(table_title, title, sizeof(table_title) - 1);
+    table_title[sizeof(table_title) - 1] = '\0';
+    utils_str_to_upper(table_title);
+    table_page_rows = 0;
+    table_rows = 0;
+    table_open = true;
+}
+
+void ui_table_row(const char *const cells[]) {
+    if (!table_open) return;
+    if (table_page_rows == UI_TABLE_PAGE_ROWS) {
+        table_print_page();
+        // The next page comes under the same headings
+        ui_frame_begin();
+        frame_puts("Press enter for the next page...");
+        ui_frame_end();
+        char line[UTILS_LINE_SIZE];
+        utils_read_line(line, sizeof(line));
+        ui_clear_screen();
+    }
+    for (int c = 0; c < table_column_count; c++) {
+        char *cell = table_page[table_page_rows][c];
+        size_t i = 0;
+        for (; i + 1 < UI_TABLE_CELL_SIZE && cells[c][i] != '\0'; i++) {
+            cell[i] = (cells[c][i] == '\t' || cells[c][i] == '\n' || cells[c][i] == '\r') ? ' ' : cells[c][i];
+        }
+        cell[i] = '\0';
+    }
+    table_page_rows++;
+}
+
+int ui_table_end(void) {
+    if (!table_open) return 0;
+    if (table_page_rows > 0) table_print_page();
+    table_open = false;
+    return table_rows;
+}
+
+UiListMode ui_list_mode(void) {
+    if (list_mode < 0) {
+        const char *view = getenv("HMS_VIEW");
+        list_mode = view != NULL && strcmp(view, "cards") == 0 ? UI_LIST_CARDS : UI_LIST_TABLE;
+    }
+    return (UiListMode)list_mode;
+}
+
+void ui_list_begin(const char *title) {
+    strncpy(table_title, title, sizeof(table_title) - 1);
+    table_title[sizeof(table_title) - 1] = '\0';
+    list_open = true;
+    if (ui_list_mode() == UI_LIST_CARDS) ui_frame_begin();
+}
+
+void ui_list_row(const UiColumn columns[], int column_count, const char *const cells[]) {
+    if (list_open && !table_open) {
+        char title[sizeof(table_title)];
+        strcpy(title, table_title);
+        ui_table_begin(title, columns, column_count);
+    }
+    ui_table_row(cells);
+}
+
+void ui_list_end(void) {
+    if (!list_open) return;
+    list_open = false;
+    if (ui_list_mode() == UI_LIST_CARDS) ui_frame_end();
+    else ui_table_end();
+}
+
+static const UiColumn patient_columns[] = {
+    { "ID", 0 }, { "Name", 20 }, { "Age", 0 }, { "Sex", 0 },
+    { "Phone", 0 }, { "Blood", 0 }, { "Address", 0 }
+};
+
+static const UiColumn doctor_columns[] = {
+    { "ID", 0 }, { "Name", 20 }, { "Specialization", 16 }, { "Room", 0 },
+    { "Phone", 0 }, { "Available", 0 }
+};
+
+static const UiColumn receptionist_columns[] = {
+    { "ID", 0 }, { "Name", 20 }, { "Phone", 0 }, { "Email", 0 }, { "Available", 0 }
+};
+
+void ui_list_patient(Patient patient, int index) {
+    if (ui_list_mode() == UI_LIST_CARDS) {
+        ui_print_patient(patient, index);
+        return;
+    }
+    char id[12], age[12];
+    snprintf(id, sizeof(id), "%d", patient.id);
+    snprintf(age, sizeof(age), "%d", patient.age);
+    const char *cells[] = {
+        id, patient.name, age, patient.gender == MALE ? "M" : "F",
+        patient.phone, patient.blood_group, patient.address
+    };
+    ui_list_row(patient_columns, 7, cells);
+}
+
+void ui_list_doctor(Doctor doctor, int index) {
+    if (ui_list_mode() == UI_LIST_CARDS) {
+        ui_print_doctor(doctor, index);
+        return;
+    }
+    char id[12], room[12];
+    snprintf(id, sizeof(id), "%d", doctor.id);
+    snprintf(room, sizeof(room), "%d", doctor.room_number);
+    const char *cells[] = {
+        id, doctor.name, doctor.specialization, room, doctor.phone, doctor.is_available ? "Yes" : "No"
+    };
+    ui_list_row(doctor_columns, 6, cells);
+}
+
+void ui_list_receptionist(Receptionist receptionist, int index) {
+    if (ui_list_mode() == UI_LIST_CARDS) {
+        ui_print_receptionist(receptionist, index);
+        return;
+    }
+    char id[12];
+    snprintf(id, sizeof(id), "%d", receptionist.id);
+    const char *cells[] = {
+        id, receptionist.name, receptionist.phone, receptionist.email, receptionist.is_available ? "Yes" : "No"
+    };
+    ui_list_row(receptionist_columns, 5, cells);
+}
+
 void ui_dummy_loading(int time) {
     ui_clear_screen();
     ui_print_banner();
@@ -293,10 +772,14 @@ void ui_dummy_loading(int time) {
     const char arr[] = {'|', '/', '-', '\\'};
     int i = 0;
     int loading_time = 0;
-    printf("\n\n\n");
+    ui_frame_begin();
+    frame_puts("\n\n\n");
+    ui_frame_end();
     while (1) {
-        printf(BOLD BRIGHT_RED "\rLoading data from files... " RESET "%c", arr[i]);
-        fflush(stdout);
+        ui_frame_begin();
+        frame_puts(BOLD BRIGHT_RED "\rLoading data from files... " RESET);
+        frame_put(&arr[i], 1);
+        ui_frame_end();
         i = (i + 1) % 4;
 
         #ifdef _WIN32
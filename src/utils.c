@@ -7,68 +7,290 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <limits.h>
+#include <time.h>
 #include "../include/utils.h"
 
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+/**
+ *==========================================================
+ *                      Input Source
+ *==========================================================
+ */
+
+/*
+ * stdin is read in large blocks with read() rather than through stdio, and
+ * lines are cut out of the block with memchr(). A terminal still hands
+ * over one line per read(); piped input costs one system call per block.
+ */
+static char stdin_block[UTILS_INPUT_BLOCK];
+static size_t stdin_start;          /* First byte not yet returned */
+static size_t stdin_end;
+static bool stdin_eof;
+
+static bool stdin_fill(void) {
+    if (stdin_eof) return false;
+    if (stdin_start > 0) {
+        memmove(stdin_block, stdin_block + stdin_start, stdin_end - stdin_start);
+        stdin_end -= stdin_start;
+        stdin_start = 0;
+    }
+    while (1) {
+        #ifdef _WIN32
+            int n = _read(0, stdin_block + stdin_end, (unsigned int)(sizeof(stdin_block) - stdin_end));
+        #else
+            ssize_t n = read(STDIN_FILENO, stdin_block + stdin_end, sizeof(stdin_block) - stdin_end);
+            if (n < 0 && errno == EINTR) continue;
+        #endif
+        if (n <= 0) {
+            stdin_eof = true;
+            return false;
+        }
+        stdin_end += (size_t)n;
+        return true;
+    }
+}
+
+int utils_stdin_read_line(void *context, char *buffer, size_t size) {
+    (void)context;
+    size_t length = 0;          /* Bytes of the line kept in buffer */
+    bool found = false;
+
+    while (!found) {
+        char *start = stdin_block + stdin_start;
+        size_t available = stdin_end - stdin_start;
+        char *newline = memchr(start, '\n', available);
+        size_t take = newline != NULL ? (size_t)(newline - start) : available;
+
+        if (newline == NULL && available < sizeof(stdin_block) && stdin_fill()) continue;
+        if (newline == NULL && available == 0) {
+            if (length == 0) return -1;     // Ended, and not partway through a line
+            break;
+        }
+
+        // Whatever does not fit in buffer is dropped, up to the end of the line
+        size_t keep = take < size - 1 - length ? take : size - 1 - length;
+        memcpy(buffer + length, start, keep);
+        length += keep;
+        stdin_start += take + (newline != NULL);
+        found = newline != NULL;
+    }
+
+    buffer[length] = '\0';
+    if (length > 0 && buffer[length - 1] == '\r') buffer[--length] = '\0';
+    return (int)length;
+}
+
 void utils_clear_input_buffer(void) {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
+    char line[UTILS_LINE_SIZE];
+    utils_read_line(line, sizeof(line));
+}
+
+static const InputSource stdin_source = { utils_stdin_read_line, NULL };
+static const InputSource *input = &stdin_source;
+
+void utils_set_input(const InputSource *source) {
+    input = source != NULL ? source : &stdin_source;
+}
+
+int utils_read_line(char *buffer, size_t size) {
+    fflush(stdout);     // The prompt is on screen before the program waits
+    return input->read_line(input->context, buffer, size);
+}
+
+/* Ends the session once the input is exhausted; exit handlers save the data. */
+static void input_ended(void) {
+    static bool ended = false;
+    if (ended) return;      // Asked again by an exit handler: let it finish
+    ended = true;
+    exit(EXIT_SUCCESS);
+}
+
+static const char *skip_spaces(const char *text) {
+    while (*text == ' ' || *text == '\t') text++;
+    return text;
+}
+
+ParseStatus utils_parse_int(const char *text, int *value) {
+    const char *c = skip_spaces(text);
+    if (*c == '\0') return PARSE_EMPTY;
+
+    bool negative = *c == '-';
+    if (*c == '-' || *c == '+') c++;
+    if (*c < '0' || *c > '9') return PARSE_INVALID;
+
+    // Accumulated as a negative number, which reaches INT_MIN
+    long long number = 0;
+    bool overflow = false;
+    for (; *c >= '0' && *c <= '9'; c++) {
+        number = number * 10 - (*c - '0');
+        if (number < (long long)INT_MIN) {
+            overflow = true;
+            number = INT_MIN;
+        }
+    }
+    if (!negative && number == INT_MIN) overflow = true;
+    if (*skip_spaces(c) != '\0') return PARSE_TRAILING;
+    if (overflow) return PARSE_RANGE;
+
+    *value = (int)(negative ? number : -number);
+    return PARSE_OK;
+}
+
+ParseStatus utils_parse_double(const char *text, double *value) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char *c = skip_spaces(text);
+    if (*c == '\0') return PARSE_EMPTY;
+
+    bool negative = *c == '-';
+    if (*c == '-' || *c == '+') c++;
+
+    // Up to 19 significant digits are kept; the rest only move the exponent
+    unsigned long long mantissa = 0;
+    int digits = 0, significant = 0, exponent = 0;
+    for (; *c >= '0' && *c <= '9'; c++, digits++) {
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (unsigned)(*c - '0');
+            if (mantissa > 0) significant++;
+        } else {
+            exponent++;
+        }
+    }
+    if (*c == '.') {
+        for (c++; *c >= '0' && *c <= '9'; c++, digits++) {
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (unsigned)(*c - '0');
+                if (mantissa > 0) significant++;
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) return PARSE_INVALID;
+
+    if (*c == 'e' || *c == 'E') {
+        const char *e = c + 1;
+        bool negative_exponent = *e == '-';
+        if (*e == '-' || *e == '+') e++;
+        if (*e < '0' || *e > '9') return PARSE_TRAILING;
+        int power = 0;
+        for (; *e >= '0' && *e <= '9'; e++) {
+            if (power < 10000) power = power * 10 + (*e - '0');
+        }
+        exponent += negative_exponent ? -power : power;
+        c = e;
+    }
+    if (*skip_spaces(c) != '\0') return PARSE_TRAILING;
+
+    double number = (double)mantissa;
+    if (mantissa != 0) {
+        // Beyond these limits the result is certain to overflow or vanish
+        if (exponent > 330) return PARSE_RANGE;
+        if (exponent < -360) exponent = -360;
+        while (exponent > 22) { number *= 1e22; exponent -= 22; }
+        while (exponent < -22) { number /= 1e22; exponent += 22; }
+        number = exponent >= 0 ? number * powers[exponent] : number / powers[-exponent];
+        if (number > DBL_MAX) return PARSE_RANGE;
+    }
+
+    *value = negative ? -number : number;
+    return PARSE_OK;
+}
+
+const char *utils_parse_message(ParseStatus status) {
+    switch (status) {
+        case PARSE_OK:          return "OK";
+        case PARSE_EMPTY:       return "Input cannot be empty";
+        case PARSE_RANGE:       return "Number out of range";
+        case PARSE_TRAILING:    return "Unexpected text after the number";
+        default:                return "Invalid input";
+    }
 }
 
 void utils_pause(void) {
+    char line[UTILS_LINE_SIZE];
     printf("\nPress any key to continue...");
-    getchar();
+    utils_read_line(line, sizeof(line));
 }
 
 int utils_get_int(void) {
+    char line[UTILS_LINE_SIZE];
     int num;
-    while (scanf("%d", &num) != 1) {
-        printf("Invalid input. Please enter an integer: ");
-        utils_clear_input_buffer();
+    while (1) {
+        if (utils_read_line(line, sizeof(line)) < 0) {
+            input_ended();
+            return 0;
+        }
+        ParseStatus status = utils_parse_int(line, &num);
+        if (status == PARSE_OK) return num;
+        if (status != PARSE_EMPTY) printf("%s. Please enter an integer: ", utils_parse_message(status));
     }
-    utils_clear_input_buffer();
-    return num;
 }
 
 float utils_get_float(void) {
-    float num;
-    while (scanf("%f", &num) != 1) {
-        printf("Invalid input. Please enter a float: ");
-        utils_clear_input_buffer();
+    char line[UTILS_LINE_SIZE];
+    double num;
+    while (1) {
+        if (utils_read_line(line, sizeof(line)) < 0) {
+            input_ended();
+            return 0;
+        }
+        ParseStatus status = utils_parse_double(line, &num);
+        if (status == PARSE_OK && (num > FLT_MAX || num < -FLT_MAX)) status = PARSE_RANGE;
+        if (status == PARSE_OK) return (float)num;
+        if (status != PARSE_EMPTY) printf("%s. Please enter a float: ", utils_parse_message(status));
     }
-    utils_clear_input_buffer();
-    return num;
 }
 
 double utils_get_double(void) {
+    char line[UTILS_LINE_SIZE];
     double num;
-    while (scanf("%lf", &num) != 1) {
-        printf("Invalid input. Please enter a double: ");
-        utils_clear_input_buffer();
+    while (1) {
+        if (utils_read_line(line, sizeof(line)) < 0) {
+            input_ended();
+            return 0;
+        }
+        ParseStatus status = utils_parse_double(line, &num);
+        if (status == PARSE_OK) return num;
+        if (status != PARSE_EMPTY) printf("%s. Please enter a double: ", utils_parse_message(status));
     }
-    utils_clear_input_buffer();
-    return num;
 }
 
 char utils_get_char(void) {
-    char ch;
-    scanf(" %c", &ch);
-    utils_clear_input_buffer();
-    return ch;
+    char line[UTILS_LINE_SIZE];
+    const char *c;
+    do {
+        if (utils_read_line(line, sizeof(line)) < 0) {
+            input_ended();
+            return '\0';
+        }
+        c = skip_spaces(line);
+    } while (*c == '\0');
+    return *c;
 }
 
 char* utils_get_string(char *str, size_t size) {
     while (1) {
-        if (fgets(str, size, stdin) != NULL) {
-            str[strcspn(str, "\n")] = '\0';
-            if (str[0] != '\0') {
-                return str;
-            }
-            printf("Input cannot be empty. Try again: ");
-        } else {
+        if (utils_read_line(str, size) < 0) {
+            input_ended();
             return NULL;
         }
+        if (str[0] != '\0') {
+            return str;
+        }
+        printf("Input cannot be empty. Try again: ");
     }
 }
 
@@ -211,4 +433,85 @@ bool utils_is_valid_address(const char *address) {
         }
     }
     return true;
+}
+
+/**
+ *==========================================================
+ *                      Date Functions                      
+ *==========================================================
+ */
+
+static int days_in_month(int month, int year) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+int utils_date_key(const char *date) {
+    if (date == NULL) return 0;
+
+    int day, month, year, consumed = 0;
+    if (sscanf(date, "%2d-%2d-%4d%n", &day, &month, &year, &consumed) != 3) return 0;
+    if (date[consumed] != '\0') return 0;
+    if (month < 1 || month > 12 || year < 1900) return 0;
+    if (day < 1 || day > days_in_month(month, year)) return 0;
+
+    return year * 10000 + month * 100 + day;
+}
+
+int utils_today_key(void) {
+    time_t now = time(NULL);
+    struct tm* local = localtime(&now);
+    return (local->tm_year + 1900) * 10000 + (local->tm_mon + 1) * 100 + local->tm_mday;
+}
+
+char* utils_get_today(char *buffer, size_t size) {
+    int key = utils_today_key();
+    snprintf(buffer, size, "%02d-%02d-%04d", key % 100, (key / 100) % 100, key / 10000);
+    return buffer;
+}
+
+int utils_time_minutes(const char *time_slot) {
+    if (time_slot == NULL) return -1;
+
+    int hour, minute, consumed = 0;
+    if (sscanf(time_slot, "%2d:%2d%n", &hour, &minute, &consumed) != 2) return -1;
+    if (minute < 0 || minute > 59) return -1;
+
+    const char* rest = time_slot + consumed;
+    while (*rest == ' ') rest++;
+
+    if (*rest == '\0') {
+        if (hour < 0 || hour > 23) return -1;
+        return hour * 60 + minute;
+    }
+
+    char meridiem = toupper((unsigned char)rest[0]);
+    if ((meridiem != 'A' && meridiem != 'P') || toupper((unsigned char)rest[1]) != 'M' || rest[2] != '\0') {
+        return -1;
+    }
+    if (hour < 1 || hour > 12) return -1;
+
+    hour %= 12;
+    if (meridiem == 'P') hour += 12;
+    return hour * 60 + minute;
+}
+
+int utils_epoch_minutes(int date_key, int minute_of_day) {
+    if (date_key == 0 || minute_of_day < 0) return -1;
+
+    struct tm local = {0};
+    local.tm_year = date_key / 10000 - 1900;
+    local.tm_mon = (date_key / 100) % 100 - 1;
+    local.tm_mday = date_key % 100;
+    local.tm_hour = minute_of_day / 60;
+    local.tm_min = minute_of_day % 60;
+    local.tm_isdst = -1;
+
+    time_t t = mktime(&local);
+    return t == (time_t)-1 ? -1 : (int)(t / 60);
+}
+
+int utils_now_minutes(void) {
+    return (int)(time(NULL) / 60);
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+/**
+ * @file validate.c
+ * @brief Batch field validator implementation for Healthcare Management System
+ *
+ * A vector kernel tests a field a chunk at a time against its character
+ * class and keeps one bit per byte: in the class or not, and for emails
+ * '@' or not and '.' or not. The bits of a whole field fit in 128, so the
+ * rules become a few integer operations on them: "every byte before the
+ * NUL is in the class", "exactly one '@'", "the last '.' comes after it".
+ * A chunk is loaded straight from the array unless it would run past the
+ * last field, in which case it is copied out first, so nothing outside
+ * the fields is ever read.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../include/validate.h"
+#include "../include/utils.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define VALIDATE_VECTORS
+    #include <immintrin.h>
+#endif
+
+typedef enum {
+    FIELD_NAME,
+    FIELD_PHONE,
+    FIELD_EMAIL,
+    FIELD_ADDRESS,
+    FIELD_BLOOD
+} FieldKind;
+
+static const size_t field_widths[] = { NAME_SIZE, PHONE_SIZE, EMAIL_SIZE, ADDRESS_SIZE, BLOOD_SIZE };
+
+static int kernel = -1;     /* Picked on first use */
+
+/* The unterminated fields a string check would read past are refused. */
+static bool scalar_valid(FieldKind kind, const char* field) {
+    if (memchr(field, '\0', field_widths[kind]) == NULL) return false;
+    switch (kind) {
+        case FIELD_NAME:    return utils_is_valid_name(field);
+        case FIELD_PHONE:   return utils_is_valid_phone(field);
+        case FIELD_EMAIL:   return utils_is_valid_email(field);
+        case FIELD_ADDRESS: return utils_is_valid_address(field);
+        default:            return utils_is_valid_blood_group(field);
+    }
+}
+
+#ifdef VALIDATE_VECTORS
+
+#if ADDRESS_SIZE > 128 || NAME_SIZE > 128 || EMAIL_SIZE > 128
+    #error "The vector validators keep a field's masks in 128 bits"
+#endif
+
+typedef struct {
+    uint64_t bits[2];
+} Mask;
+
+/* What the kernels gather about one field */
+typedef struct {
+    Mask allowed;           /* Bytes of the field's character class */
+    Mask at, dot;           /* Emails only */
+    int length;             /* Bytes before the NUL, -1 if there is none */
+} FieldClasses;
+
+static void mask_set(Mask* mask, unsigned offset, uint32_t bits) {
+    mask->bits[offset / 64] |= (uint64_t)bits << (offset % 64);
+}
+
+/* Bits [0, length) */
+static Mask mask_below(int length) {
+    Mask mask;
+    mask.bits[0] = length >= 64 ? ~0ULL : (1ULL << length) - 1;
+    mask.bits[1] = length <= 64 ? 0 : (1ULL << (length - 64)) - 1;
+    return mask;
+}
+
+static bool mask_covers(Mask set, Mask wanted) {
+    return (set.bits[0] & wanted.bits[0]) == wanted.bits[0] &&
+           (set.bits[1] & wanted.bits[1]) == wanted.bits[1];
+}
+
+/* The checks of utils_is_valid_*, on what the kernel gathered */
+static bool classes_valid(FieldKind kind, const char* field, const FieldClasses* c) {
+    if (c->length <= 0) return false;
+    Mask before = mask_below(c->length);
+    if (!mask_covers(c->allowed, before)) return false;
+
+    switch (kind) {
+        case FIELD_PHONE:
+            return c->length == 11 && field[0] == '0' && field[1] == '1' && field[2] >= '3';
+        case FIELD_EMAIL: {
+            uint64_t at_lo = c->at.bits[0] & before.bits[0], at_hi = c->at.bits[1] & before.bits[1];
+            if (__builtin_popcountll(at_lo) + __builtin_popcountll(at_hi) != 1) return false;
+            int at_position = at_lo != 0 ? __builtin_ctzll(at_lo) : 64 + __builtin_ctzll(at_hi);
+
+            uint64_t dot_lo = c->dot.bits[0] & before.bits[0], dot_hi = c->dot.bits[1] & before.bits[1];
+            int last_dot = dot_hi != 0 ? 127 - __builtin_clzll(dot_hi)
+                         : dot_lo != 0 ? 63 - __builtin_clzll(dot_lo) : -1;
+            return at_position != 0 && last_dot > at_position && last_dot != c->length - 1;
+        }
+        default:
+            return true;
+    }
+}
+
+/*
+ *==========================================================================
+ *                              KERNELS
+ *==========================================================================
+ */
+
+/*
+ * The two kernels differ only in vector width, so one body serves both.
+ * Ranges are tested with one subtraction and one signed compare: byte -
+ * (lo + 128) is below (hi - lo - 127) exactly for lo..hi. Letters are
+ * folded to lower case first with | 0x20.
+ */
+#define KERNEL_BATCH(NAME, VEC, SET1, LOADU, SUB, OR, CMPGT, CMPEQ, MOVEMASK, CHUNK)        \
+static size_t NAME(FieldKind kind, const char* fields, size_t stride, size_t count, bool* valid) { \
+    const size_t width = field_widths[kind];                                                \
+    const char* end = fields + stride * (count - 1) + width;                                \
+    const VEC letter_base = SET1((char)('a' + 128)), letter_limit = SET1((char)(25 - 127)); \
+    const VEC digit_base = SET1((char)('0' + 128)), digit_limit = SET1((char)(9 - 127));   \
+    const VEC lower = SET1(0x20), nul = SET1(0), space = SET1(' ');                         \
+    const VEC at = SET1('@'), dot = SET1('.'), comma = SET1(',');                           \
+    size_t passed = 0;                                                                      \
+    for (size_t i = 0; i < count; i++) {                                                    \
+        const char* field = fields + stride * i;                                            \
+        FieldClasses classes = { .length = -1 };                                            \
+        for (size_t offset = 0; offset < width; offset += CHUNK) {                          \
+            const char* p = field + offset;                                                 \
+            size_t left = width - offset;                                                   \
+            VEC v;                                                                          \
+            if (p + CHUNK <= end) {                                                         \
+                v = LOADU((const void*)p);                                                  \
+            } else {                                                                        \
+                char copy[CHUNK] = { 0 };                                                   \
+                memcpy(copy, p, left < CHUNK ? left : CHUNK);                               \
+                v = LOADU((const void*)copy);                                               \
+            }                                                                               \
+            VEC letter = CMPGT(letter_limit, SUB(OR(v, lower), letter_base));               \
+            VEC digit = CMPGT(digit_limit, SUB(v, digit_base));                             \
+            VEC is_at = CMPEQ(v, at), is_dot = CMPEQ(v, dot);                               \
+            VEC allowed;                                                                    \
+            switch (kind) {                                                                 \
+                case FIELD_NAME:  allowed = OR(letter, CMPEQ(v, space)); break;             \
+                case FIELD_PHONE: allowed = digit; break;                                   \
+                case FIELD_EMAIL: allowed = OR(OR(letter, digit), OR(is_at, is_dot)); break; \
+                default:          allowed = OR(OR(letter, digit),                           \
+                                               OR(CMPEQ(v, space), OR(CMPEQ(v, comma), is_dot))); \
+            }                                                                               \
+            unsigned o = (unsigned)offset;                                                  \
+            mask_set(&classes.allowed, o, (uint32_t)MOVEMASK(allowed));                     \
+            if (kind == FIELD_EMAIL) {                                                      \
+                mask_set(&classes.at, o, (uint32_t)MOVEMASK(is_at));                        \
+                mask_set(&classes.dot, o, (uint32_t)MOVEMASK(is_dot));                      \
+            }                                                                               \
+            uint32_t in_field = left >= CHUNK ? (uint32_t)~0u >> (32 - CHUNK)               \
+                                              : ((uint32_t)1 << left) - 1;                  \
+            uint32_t zero = (uint32_t)MOVEMASK(CMPEQ(v, nul)) & in_field;                   \
+            if (zero != 0) {                                                                \
+                classes.length = (int)offset + __builtin_ctz(zero);                         \
+                break;                                                                      \
+            }                                                                               \
+        }                                                                                   \
+        valid[i] = classes_valid(kind, field, &classes);                                    \
+        passed += valid[i];                                                                 \
+    }                                                                                       \
+    return passed;                                                                          \
+}
+
+KERNEL_BATCH(batch_sse2, __m128i, _mm_set1_epi8, _mm_loadu_si128, _mm_sub_epi8, _mm_or_si128,
+             _mm_cmpgt_epi8, _mm_cmpeq_epi8, _mm_movemask_epi8, 16)
+
+__attribute__((target("avx2")))
+KERNEL_BATCH(batch_avx2, __m256i, _mm256_set1_epi8, _mm256_loadu_si256, _mm256_sub_epi8, _mm256_or_si256,
+             _mm256_cmpgt_epi8, _mm256_cmpeq_epi8, _mm256_movemask_epi8, 32)
+
+#undef KERNEL_BATCH
+
+#endif
+
+/*
+ *==========================================================================
+ *                              PUBLIC API
+ *==========================================================================
+ */
+
+static ValidateKernel best_kernel(void) {
+    #ifdef VALIDATE_VECTORS
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? VALIDATE_AVX2 : VALIDATE_SSE2;
+    #else
+        return VALIDATE_SCALAR;
+    #endif
+}
+
+ValidateKernel validate_select(ValidateKernel wanted) {
+    ValidateKernel best = best_kernel();
+    kernel = wanted < best ? wanted : best;
+    return (ValidateKernel)kernel;
+}
+
+ValidateKernel validate_kernel(void) {
+    if (kernel < 0) kernel = best_kernel();
+    return (ValidateKernel)kernel;
+}
+
+const char* validate_name(ValidateKernel k) {
+    switch (k) {
+        case VALIDATE_SSE2: return "sse2";
+        case VALIDATE_AVX2: return "avx2";
+        default:            return "scalar";
+    }
+}
+
+static size_t validate_batch(FieldKind kind, const char* fields, size_t stride, size_t count, bool* valid) {
+    if (count == 0) return 0;
+    size_t passed = 0;
+    ValidateKernel k = validate_kernel();
+
+    #ifdef VALIDATE_VECTORS
+        if (k == VALIDATE_AVX2 && kind != FIELD_BLOOD) return batch_avx2(kind, fields, stride, count, valid);
+        if (k == VALIDATE_SSE2 && kind != FIELD_BLOOD) return batch_sse2(kind, fields, stride, count, valid);
+    #endif
+
+    (void)k;
+    for (size_t i = 0; i < count; i++) {
+        valid[i] = scalar_valid(kind, fields + stride * i);
+        passed += valid[i];
+    }
+    return passed;
+}
+
+size_t validate_names(const char* fields, size_t stride, size_t count, bool* valid) {
+    return validate_batch(FIELD_NAME, fields, stride, count, valid);
+}
+
+size_t validate_phones(const char* fields, size_t stride, size_t count, bool* valid) {
+    return validate_batch(FIELD_PHONE, fields, stride, count, valid);
+}
+
+size_t validate_emails(const char* fields, size_t stride, size_t count, bool* valid) {
+    return validate_batch(FIELD_EMAIL, fields, stride, count, valid);
+}
+
+size_t validate_addresses(const char* fields, size_t stride, size_t count, bool* valid) {
+    return validate_batch(FIELD_ADDRESS, fields, stride, count, valid);
+}
+
+size_t validate_blood_groups(const char* fields, size_t stride, size_t count, bool* valid) {
+    return validate_batch(FIELD_BLOOD, fields, stride, count, valid);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file workload.c
+ * @brief Doctor workload tracking implementation for Healthcare Management System
+ *
+ * Each day a booking is asked for gets an indexed binary min-heap of the
+ * doctors ordered by their load on that day (booked minutes, then pending
+ * appointments). Heaps are built on first use from the appointment
+ * counters and kept for the last WORKLOAD_DAYS days asked for; a booking
+ * or status change re-reads one doctor's counters for its day, an O(1)
+ * lookup plus an O(log n) sift in that day's heap. Recommendations walk
+ * the heap in load order through a small frontier of heap nodes and stop
+ * as soon as enough matching doctors are found. Doctors are found by ID
+ * through a table indexed by id - DOCTOR_ID_START.
+ */
+
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+#include "../include/workload.h"
+#include "../include/appointment_stats.h"
+#include "../include/doctor.h"
+#include "../include/hospital.h"
+
+#define DOCTOR_ID_SPAN  (ADMIN_ID_START - DOCTOR_ID_START)
+
+typedef struct {
+    int doctor_id;
+    int booked_minutes;     /* Pending, confirmed and completed on the day */
+    int pending;
+} DoctorLoad;
+
+typedef struct {
+    int day;                /* YYYYMMDD, 0 if the heap is unused */
+    int built_for;          /* doctor_count when built; another count means doctors came or went */
+    unsigned int used;      /* Stamp of the last recommendation, for eviction */
+    int size;
+    DoctorLoad heap[DOCTOR_ID_SPAN];
+    int pos[DOCTOR_ID_SPAN];        /* doctor_id - DOCTOR_ID_START -> heap index + 1 */
+} DayHeap;
+
+static DayHeap days[WORKLOAD_DAYS];
+static unsigned int use_clock = 0;
+static int doctor_index[DOCTOR_ID_SPAN];    /* doctor_id - DOCTOR_ID_START -> index in doctors[] + 1 */
+
+static bool load_less(const DoctorLoad* a, const DoctorLoad* b) {
+    if (a->booked_minutes != b->booked_minutes) return a->booked_minutes < b->booked_minutes;
+    if (a->pending != b->pending) return a->pending < b->pending;
+    return a->doctor_id < b->doctor_id;
+}
+
+static void heap_swap(DayHeap* h, int i, int j) {
+    DoctorLoad tmp = h->heap[i];
+    h->heap[i] = h->heap[j];
+    h->heap[j] = tmp;
+    h->pos[h->heap[i].doctor_id - DOCTOR_ID_START] = i + 1;
+    h->pos[h->heap[j].doctor_id - DOCTOR_ID_START] = j + 1;
+}
+
+static void sift_up(DayHeap* h, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!load_less(&h->heap[i], &h->heap[parent])) break;
+        heap_swap(h, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(DayHeap* h, int i) {
+    while (1) {
+        int smallest = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < h->size && load_less(&h->heap[left], &h->heap[smallest])) smallest = left;
+        if (right < h->size && load_less(&h->heap[right], &h->heap[smallest])) smallest = right;
+        if (smallest == i) break;
+        heap_swap(h, i, smallest);
+        i = smallest;
+    }
+}
+
+/* Re-reads one doctor's load on the heap's day and restores the order. */
+static void heap_update(DayHeap* h, int doctor_id) {
+    int slot = doctor_id - DOCTOR_ID_START;
+    int i = h->pos[slot] - 1;
+    if (i < 0) {
+        i = h->size++;
+        h->heap[i].doctor_id = doctor_id;
+        h->pos[slot] = i + 1;
+    }
+    h->heap[i].booked_minutes = workload_booked_minutes(doctor_id, h->day);
+    h->heap[i].pending = appointment_stats_count(doctor_id, h->day, APPT_PENDING);
+
+    sift_up(h, i);
+    sift_down(h, h->pos[slot] - 1);
+}
+
+static void heap_build(DayHeap* h, int day) {
+    h->day = day;
+    h->built_for = doctor_count;
+    h->size = 0;
+    memset(h->pos, 0, sizeof(h->pos));
+    for (int i = 0; i < doctor_count; i++) {
+        if (doctors[i].id >= DOCTOR_ID_START && doctors[i].id < ADMIN_ID_START) {
+            heap_update(h, doctors[i].id);
+        }
+    }
+}
+
+/* The day's heap, built now if it is not kept or is out of date. */
+static DayHeap* heap_for(int day) {
+    DayHeap* h = NULL;
+    for (int d = 0; d < WORKLOAD_DAYS && h == NULL; d++) {
+        if (days[d].day == day) h = &days[d];
+    }
+    if (h == NULL) {
+        // Replace the day least recently asked for; unused heaps have never been
+        h = &days[0];
+        for (int d = 1; d < WORKLOAD_DAYS; d++) {
+            if (days[d].used < h->used) h = &days[d];
+        }
+    }
+    if (h->day != day || h->built_for != doctor_count) heap_build(h, day);
+    h->used = ++use_clock;
+    return h;
+}
+
+void workload_update(int doctor_id, int day) {
+    if (doctor_id < DOCTOR_ID_START || doctor_id >= ADMIN_ID_START) return;
+
+    for (int d = 0; d < WORKLOAD_DAYS; d++) {
+        if (days[d].day != 0 && (day == APPT_STATS_ANY_DAY || days[d].day == day)) {
+            heap_update(&days[d], doctor_id);
+        }
+    }
+}
+
+void workload_rebuild(void) {
+    for (int d = 0; d < WORKLOAD_DAYS; d++) {
+        days[d].day = 0;
+        days[d].used = 0;
+    }
+    memset(doctor_index, 0, sizeof(doctor_index));
+    for (int i = 0; i < doctor_count; i++) {
+        int slot = doctors[i].id - DOCTOR_ID_START;
+        if (slot >= 0 && slot < DOCTOR_ID_SPAN && doctor_index[slot] == 0) doctor_index[slot] = i + 1;
+    }
+}
+
+int workload_booked_minutes(int doctor_id, int day) {
+    int booked = appointment_stats_count(doctor_id, day, APPT_PENDING) +
+                 appointment_stats_count(doctor_id, day, APPT_CONFIRMED) +
+                 appointment_stats_count(doctor_id, day, APPT_COMPLETED);
+    return booked * APPT_SLOT_MINUTES;
+}
+
+static bool same_text(const char* a, const char* b) {
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/* Index of a doctor in doctors[]; the table is refreshed when it has fallen behind. */
+static int doctor_find(int doctor_id) {
+    int slot = doctor_id - DOCTOR_ID_START;
+    int idx = doctor_index[slot] - 1;
+    if (idx >= 0 && idx < doctor_count && doctors[idx].id == doctor_id) return idx;
+
+    idx = doctor_search_id(doctor_id);
+    doctor_index[slot] = idx + 1;
+    return idx;
+}
+
+static bool is_candidate(const DoctorLoad* load, const char* specialization) {
+    int idx = doctor_find(load->doctor_id);
+    if (idx == -1 || !doctors[idx].is_active || !doctors[idx].is_available) return false;
+    if (strcmp(specialization, "*") != 0 && !same_text(doctors[idx].specialization, specialization)) {
+        return false;
+    }
+    return load->booked_minutes + APPT_SLOT_MINUTES <= DOCTOR_DAY_MINUTES;
+}
+
+int workload_recommend(const char* specialization, int day, int* out_ids, int max) {
+    // Heap indices still to visit; it only grows by one per visit, so a linear pick is enough
+    static int frontier[DOCTOR_ID_SPAN];
+    const DayHeap* h = heap_for(day);
+    int frontier_size = 0;
+    int found = 0;
+
+    if (h->size > 0) frontier[frontier_size++] = 0;
+
+    while (frontier_size > 0 && found < max) {
+        // Pop the least loaded unvisited doctor
+        int best = 0;
+        for (int f = 1; f < frontier_size; f++) {
+            if (load_less(&h->heap[frontier[f]], &h->heap[frontier[best]])) best = f;
+        }
+        int i = frontier[best];
+        frontier[best] = frontier[--frontier_size];
+
+        if (is_candidate(&h->heap[i], specialization)) {
+            out_ids[found++] = h->heap[i].doctor_id;
+        }
+        if (2 * i + 1 < h->size) frontier[frontier_size++] = 2 * i + 1;
+        if (2 * i + 2 < h->size) frontier[frontier_size++] = 2 * i + 2;
+    }
+    return found;
+}
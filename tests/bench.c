@@ -0,0 +1,503 @@
+/**
+ * @file bench.c
+ * @brief Benchmark suite for the storage, search and render paths
+ *
+ * Seeds each table at sizes 10^2, 10^3, ... up to the table's capacity
+ * (MAX_PATIENTS and friends, so build with them raised) and times, through
+ * the same functions the menus call:
+ *
+ *   <table>_save       a save after every record changed (full rewrite)
+ *   <table>_save_one   a save after one record changed
+ *   <table>_load       a load of the whole table
+ *   patient_find_*     a lookup by ID, name or phone of a random patient
+ *   patient_delete     the permanent delete of a random patient
+ *   appointment_*      the lookup by ID, the counter rebuild and a doctor's
+ *                      list, which are whole-table scans
+ *   render_*           a patient card and the all-patients table, rendered
+ *                      into the null sink
+ *
+ * Each measurement repeats the operation until --time milliseconds have
+ * passed (at least once), with any setup between repetitions left out of
+ * the time. Results go to stdout as CSV, one line per operation and size,
+ * after '#' lines describing the build; the same run's progress goes to
+ * stderr. --compare reads two such files and points out the operations
+ * that got slower.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/bench [--max N] [--time MS] > results.csv
+ *        tests/bench --compare old.csv new.csv [percent]
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/appointment.h"
+#include "../include/appointment_stats.h"
+#include "../include/auth.h"
+#include "../include/doctor.h"
+#include "../include/hospital.h"
+#include "../include/patient.h"
+#include "../include/receptionist.h"
+#include "../include/shard.h"
+#include "../include/storage_io.h"
+#include "../include/ui.h"
+#include "../include/utils.h"
+
+#define BENCH_MAX_SIZE      10000000
+#define BENCH_MAX_OPS       (1L << 24)  /* Repetitions of one measurement at most */
+#define BENCH_DOCTORS       20          /* Doctors the appointments are spread over */
+#define COMPARE_MAX_ROWS    1024
+
+typedef struct {
+    const char* name;
+    int capacity;
+    void (*seed)(int count);
+    void (*touch)(int index);           /* Changes one record */
+    int (*save)(void);
+    int (*load)(void);
+} Table;
+
+typedef struct {
+    const char* name;
+    const Table* table;                 /* Sets the sizes and is seeded first */
+    void (*before)(int i);              /* Untimed setup before each repetition, or NULL */
+    void (*run)(int i);
+} Benchmark;
+
+static int size;                        /* Rows in the table being measured */
+static const Table* table;
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+static int found_one[1];
+
+static unsigned next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned)(rng_state >> 32);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/*
+ *==========================================================================
+ *                              SEEDING
+ *==========================================================================
+ */
+
+static const char* first_names[] = {
+    "Rahim", "Karim", "Nusrat", "Farhana", "Tanvir", "Sadia", "Imran", "Mitu"
+};
+
+/* A name no other index gives: the letters of i in base 26 come last. */
+static void unique_name(char* name, size_t length, int i) {
+    char tag[8];
+    int n = 0;
+    do {
+        tag[n++] = (char)('a' + i % 26);
+        i /= 26;
+    } while (i > 0 && n < (int)sizeof(tag) - 1);
+    tag[n] = '\0';
+    tag[0] = (char)(tag[0] - 'a' + 'A');
+    snprintf(name, length, "%s %s", first_names[n % 8], tag);
+}
+
+static void unique_phone(char* phone, int i) {
+    snprintf(phone, PHONE_SIZE, "01%d%08d", 3 + i / 100000000, i % 100000000);
+}
+
+static void seed_patients(int count) {
+    static const char* blood_groups[] = { "A+", "A-", "B+", "B-", "AB+", "AB-", "O+", "O-" };
+    for (int i = 0; i < count; i++) {
+        Patient* p = &patients[i];
+        memset(p, 0, sizeof(*p));
+        p->id = PATIENT_ID_START + i;
+        p->age = 1 + i % 95;
+        p->gender = i % 2 ? FEMALE : MALE;
+        p->is_active = true;
+        unique_name(p->name, NAME_SIZE, i);
+        unique_phone(p->phone, i);
+        snprintf(p->address, ADDRESS_SIZE, "%d Hospital Road, Dhaka", i % 500 + 1);
+        snprintf(p->blood_group, BLOOD_SIZE, "%s", blood_groups[i % 8]);
+    }
+    patient_count = patient_available = count;
+    patient_unavailable = 0;
+}
+
+static void seed_doctors(int count) {
+    for (int i = 0; i < count; i++) {
+        Doctor* d = &doctors[i];
+        memset(d, 0, sizeof(*d));
+        d->id = DOCTOR_ID_START + i;
+        d->room_number = 100 + i % 400;
+        d->is_available = d->is_active = true;
+        unique_name(d->name, NAME_SIZE, i);
+        unique_phone(d->phone, i);
+        snprintf(d->email, EMAIL_SIZE, "doctor%d@hms.local", i);
+        snprintf(d->specialization, SPEC_SIZE, "%s", i % 2 ? "Cardiology" : "Medicine");
+    }
+    doctor_count = doctor_available = count;
+    doctor_unavailable = 0;
+}
+
+static void seed_receptionists(int count) {
+    for (int i = 0; i < count; i++) {
+        Receptionist* r = &receptionists[i];
+        memset(r, 0, sizeof(*r));
+        r->id = RECEPTIONIST_ID_START + i;
+        r->is_available = r->is_active = true;
+        unique_name(r->name, NAME_SIZE, i);
+        unique_phone(r->phone, i);
+        snprintf(r->email, EMAIL_SIZE, "desk%d@hms.local", i);
+    }
+    receptionist_count = receptionist_available = count;
+    receptionist_unavailable = 0;
+}
+
+static void seed_users(int count) {
+    for (int i = 0; i < count; i++) {
+        User* u = &users[i];
+        memset(u, 0, sizeof(*u));
+        u->id = PATIENT_ID_START + i;
+        u->role = ROLE_PATIENT;
+        u->is_active = true;
+        snprintf(u->username, USERNAME_SIZE, "user%d", i);
+        snprintf(u->password, PASSWORD_SIZE, "%08x", next_random());
+    }
+    user_count = count;
+}
+
+static void seed_appointments(int count) {
+    int patient_rows = count < MAX_PATIENTS ? count : MAX_PATIENTS;
+    int doctor_rows = BENCH_DOCTORS < MAX_DOCTORS ? BENCH_DOCTORS : MAX_DOCTORS;
+    seed_patients(patient_rows);
+    seed_doctors(doctor_rows);
+
+    for (int i = 0; i < count; i++) {
+        Appointment* a = &appointments[i];
+        memset(a, 0, sizeof(*a));
+        a->id = APPOINTMENT_ID_START + i;
+        a->patient_id = PATIENT_ID_START + i % patient_rows;
+        a->doctor_id = DOCTOR_ID_START + i % doctor_rows;
+        a->status = (AppointmentStatus)(i % 4);
+        int day = i / doctor_rows / 32;
+        snprintf(a->date, DATE_SIZE, "%02d-%02d-%04d", day % 28 + 1, day / 28 % 12 + 1, 2030 + day / 336 % 50);
+        int minutes = 9 * 60 + i / doctor_rows % 32 * 15;
+        snprintf(a->time_slot, TIME_SIZE, "%d:%02d %s", (minutes / 60 + 11) % 12 + 1, minutes % 60,
+                 minutes < 12 * 60 ? "AM" : "PM");
+        snprintf(a->reason, REASON_SIZE, "Follow up visit");
+    }
+    appointment_count = count;
+}
+
+static void touch_patient(int i) { patients[i].age = 1 + (patients[i].age + 1) % 95; }
+static void touch_doctor(int i) { doctors[i].room_number++; }
+static void touch_receptionist(int i) { receptionists[i].is_available = !receptionists[i].is_available; }
+static void touch_user(int i) { users[i].password[0] ^= 1; }
+static void touch_appointment(int i) { appointments[i].reason[0] ^= 1; }
+
+static const Table tables[] = {
+    { "patient", MAX_PATIENTS, seed_patients, touch_patient, patient_save_to_file, patient_load_from_file },
+    { "doctor", MAX_DOCTORS, seed_doctors, touch_doctor, doctor_save_to_file, doctor_load_from_file },
+    { "receptionist", MAX_RECEPTIONISTS, seed_receptionists, touch_receptionist,
+      receptionist_save_to_file, receptionist_load_from_file },
+    { "user", MAX_USERS, seed_users, touch_user, auth_save_to_file, auth_load_from_file },
+    { "appointment", MAX_APPOINTMENTS, seed_appointments, touch_appointment,
+      appointment_save_to_file, appointment_load_from_file },
+};
+
+#define PATIENTS        (&tables[0])
+#define APPOINTMENTS    (&tables[4])
+
+/*
+ *==========================================================================
+ *                              OPERATIONS
+ *==========================================================================
+ */
+
+static void touch_all(int i) {
+    (void)i;
+    for (int r = 0; r < size; r++) table->touch(r);
+}
+
+static void touch_one(int i) {
+    table->touch((int)(next_random() % (unsigned)size));
+    (void)i;
+}
+
+static void run_save(int i) {
+    (void)i;
+    if (table->save() != 0) fprintf(stderr, "%s save failed\n", table->name);
+}
+
+static void run_load(int i) {
+    (void)i;
+    if (table->load() != 0) fprintf(stderr, "%s load failed\n", table->name);
+}
+
+static bool has_name(const Patient* patient, const void* name) {
+    return strcmp(patient->name, name) == 0;
+}
+
+static bool has_phone(const Patient* patient, const void* phone) {
+    return strcmp(patient->phone, phone) == 0;
+}
+
+static void find_id(int i) {
+    (void)i;
+    shard_find_patient(PATIENT_ID_START + (int)(next_random() % (unsigned)size));
+}
+
+static void find_name(int i) {
+    (void)i;
+    char name[NAME_SIZE];
+    unique_name(name, sizeof(name), (int)(next_random() % (unsigned)size));
+    shard_scan_patients(has_name, name, found_one, 1);
+}
+
+static void find_phone(int i) {
+    (void)i;
+    char phone[PHONE_SIZE];
+    unique_phone(phone, (int)(next_random() % (unsigned)size));
+    shard_scan_patients(has_phone, phone, found_one, 1);
+}
+
+static void refill_patients(int i) {
+    (void)i;
+    if (patient_count <= size / 2 || patient_count < 2) seed_patients(size);
+}
+
+static void delete_patient(int i) {
+    (void)i;
+    patient_remove((int)(next_random() % (unsigned)patient_count));
+}
+
+static void find_appointment(int i) {
+    (void)i;
+    appointment_search_id(APPOINTMENT_ID_START + (int)(next_random() % (unsigned)size));
+}
+
+static void rebuild_stats(int i) {
+    (void)i;
+    appointment_stats_rebuild();
+}
+
+static void doctor_appointments(int i) {
+    (void)i;
+    appointment_view_by_doctor(doctors[next_random() % (unsigned)doctor_count].id);
+}
+
+static void render_card(int i) {
+    (void)i;
+    ui_print_patient(patients[next_random() % (unsigned)size], 0);
+}
+
+static void render_table(int i) {
+    (void)i;
+    patient_view_all();
+}
+
+static const Benchmark benchmarks[] = {
+    { "patient_find_id", PATIENTS, NULL, find_id },
+    { "patient_find_name", PATIENTS, NULL, find_name },
+    { "patient_find_phone", PATIENTS, NULL, find_phone },
+    { "patient_delete", PATIENTS, refill_patients, delete_patient },
+    { "appointment_find_id", APPOINTMENTS, NULL, find_appointment },
+    { "appointment_stats_rebuild", APPOINTMENTS, NULL, rebuild_stats },
+    { "appointment_view_doctor", APPOINTMENTS, NULL, doctor_appointments },
+    { "render_patient_card", PATIENTS, NULL, render_card },
+    { "render_patient_table", PATIENTS, NULL, render_table },
+};
+
+/*
+ *==========================================================================
+ *                              MEASURING
+ *==========================================================================
+ */
+
+static double min_time_us = 200e3;
+
+/* Repeats run until min_time_us has been spent in it; prints a CSV line. */
+static void measure(const char* name, void (*before)(int), void (*run)(int)) {
+    long ops = 0;
+    double spent = 0;
+
+    if (before == NULL) {
+        // Cheap operations are timed in growing batches, not one by one
+        for (long batch = 1; spent < min_time_us && ops < BENCH_MAX_OPS; batch *= 2) {
+            double start = now_us();
+            for (long i = 0; i < batch; i++) run((int)(ops + i));
+            spent += now_us() - start;
+            ops += batch;
+        }
+    } else {
+        while (spent < min_time_us && ops < BENCH_MAX_OPS) {
+            before((int)ops);
+            double start = now_us();
+            run((int)ops);
+            spent += now_us() - start;
+            ops++;
+        }
+    }
+
+    printf("%s,%d,%ld,%.1f,%.1f\n", name, size, ops, spent, spent * 1e3 / ops);
+    fflush(stdout);
+    fprintf(stderr, "%-28s %9d %10.1f us/op\n", name, size, spent / ops);
+}
+
+static int no_input(void* context, char* buffer, size_t size) {
+    (void)context;
+    (void)buffer;
+    (void)size;
+    return -1;
+}
+
+static void remove_files(const char* dir) {
+    DIR* d = opendir(dir);
+    if (d == NULL) return;
+    struct dirent* entry;
+    char path[512];
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        remove(path);
+    }
+    closedir(d);
+}
+
+static void run_all(int max_size) {
+    for (size = 100; size <= max_size; size *= 10) {
+        for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); t++) {
+            table = &tables[t];
+            if (size > table->capacity) continue;
+            char name[64];
+
+            table->seed(size);
+            if (table->save() != 0) {
+                fprintf(stderr, "%s save failed\n", table->name);
+                continue;
+            }
+            snprintf(name, sizeof(name), "%s_save", table->name);
+            measure(name, touch_all, run_save);
+            snprintf(name, sizeof(name), "%s_save_one", table->name);
+            measure(name, touch_one, run_save);
+            snprintf(name, sizeof(name), "%s_load", table->name);
+            measure(name, NULL, run_load);
+        }
+
+        for (size_t b = 0; b < sizeof(benchmarks) / sizeof(benchmarks[0]); b++) {
+            table = benchmarks[b].table;
+            if (size > table->capacity) continue;
+            table->seed(size);
+            measure(benchmarks[b].name, benchmarks[b].before, benchmarks[b].run);
+        }
+    }
+}
+
+/*
+ *==========================================================================
+ *                              COMPARING
+ *==========================================================================
+ */
+
+typedef struct {
+    char name[64];
+    int size;
+    double ns;
+} Result;
+
+static int read_results(const char* path, Result* rows, int max) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+    char line[256];
+    int count = 0;
+    while (count < max && fgets(line, sizeof(line), file) != NULL) {
+        Result* r = &rows[count];
+        long ops;
+        double total;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63[^,],%d,%ld,%lf,%lf", r->name, &r->size, &ops, &total, &r->ns) == 5) count++;
+    }
+    fclose(file);
+    return count;
+}
+
+static int compare(const char* old_path, const char* new_path, double threshold) {
+    static Result old_rows[COMPARE_MAX_ROWS], new_rows[COMPARE_MAX_ROWS];
+    int old_count = read_results(old_path, old_rows, COMPARE_MAX_ROWS);
+    int new_count = read_results(new_path, new_rows, COMPARE_MAX_ROWS);
+    if (old_count < 0 || new_count < 0) return 2;
+
+    int regressions = 0;
+    printf("%-28s %9s %14s %14s %8s\n", "operation", "size", "old ns/op", "new ns/op", "change");
+    for (int n = 0; n < new_count; n++) {
+        const Result* now = &new_rows[n];
+        for (int o = 0; o < old_count; o++) {
+            const Result* was = &old_rows[o];
+            if (was->size != now->size || strcmp(was->name, now->name) != 0) continue;
+
+            double change = was->ns > 0 ? (now->ns / was->ns - 1) * 100 : 0;
+            bool slower = change > threshold;
+            regressions += slower;
+            printf("%-28s %9d %14.1f %14.1f %+7.1f%%%s\n", now->name, now->size, was->ns, now->ns,
+                   change, slower ? "  SLOWER" : "");
+            break;
+        }
+    }
+    printf("%d of %d operations more than %.0f%% slower\n", regressions, new_count, threshold);
+    return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && strcmp(argv[1], "--compare") == 0) {
+        return compare(argv[2], argv[3], argc > 4 ? atof(argv[4]) : 10.0);
+    }
+
+    int max_size = BENCH_MAX_SIZE;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--max") == 0) max_size = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--time") == 0) min_time_us = atof(argv[i + 1]) * 1e3;
+    }
+    if (max_size > BENCH_MAX_SIZE) max_size = BENCH_MAX_SIZE;
+
+    char scratch[] = "/tmp/hms_bench_XXXXXX";
+    if (mkdtemp(scratch) == NULL || chdir(scratch) != 0) {
+        fprintf(stderr, "Could not set up the scratch directory\n");
+        return 1;
+    }
+    ensure_data_dir();
+
+    // The pauses get an input that has already ended and screens go nowhere
+    static const InputSource ended = { no_input, NULL };
+    utils_set_input(&ended);
+    unsetenv("HMS_VIEW");
+    ui_sink_select(UI_SINK_NULL);
+
+    time_t started = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M", localtime(&started));
+    printf("# hms %s benchmark, %s\n", VERSION, date);
+    printf("# MAX_PATIENTS=%d MAX_DOCTORS=%d MAX_RECEPTIONISTS=%d MAX_USERS=%d MAX_APPOINTMENTS=%d "
+           "PATIENT_SHARDS=%d storage_io=%s\n", MAX_PATIENTS, MAX_DOCTORS, MAX_RECEPTIONISTS, MAX_USERS,
+           MAX_APPOINTMENTS, PATIENT_SHARDS, storage_io_name(storage_io_backend()));
+    printf("operation,size,ops,total_us,ns_per_op\n");
+
+    run_all(max_size);
+
+    remove_files("data");
+    remove_files("logs");
+    rmdir("data");
+    rmdir("logs");
+    chdir("/");
+    rmdir(scratch);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file replay_workload.c
+ * @brief Generates a front-desk workload script for hms --replay
+ *
+ * The script logs in as the default admin, registers a doctor and a
+ * receptionist, adds the patients and lists them, then logs in as the
+ * receptionist to book the appointments and discharge patients. Each
+ * step is a timed "@" operation, so the replay report gives percentiles
+ * per kind of step. The same arguments always give the same script.
+ *
+ * The script expects an empty data directory with one receptionist
+ * record (receptionists can only be imported) and the table view of
+ * listings. Patient IDs above 2000 cannot be typed into the menus, so
+ * appointments and discharges use the first 1000 patients; build hms
+ * with MAX_PATIENTS and MAX_APPOINTMENTS raised to fit the counts.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/replay_workload [patients] [appointments] [discharges] > workload.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SLOTS_PER_DAY   32      /* 9:00 AM to 4:45 PM, every 15 minutes */
+#define TYPABLE_IDS     1000    /* Patient IDs 1001 to 2000 */
+
+static const char* first_names[] = {
+    "Rahim", "Karim", "Nusrat", "Farhana", "Tanvir", "Sadia", "Imran", "Mitu",
+    "Arif", "Shirin", "Jamal", "Ruma", "Habib", "Lima", "Sohel", "Tania"
+};
+
+static const char* last_names[] = {
+    "Uddin", "Hossain", "Akter", "Rahman", "Islam", "Khatun", "Ahmed", "Chowdhury"
+};
+
+static const char* blood_groups[] = { "A+", "A-", "B+", "B-", "AB+", "AB-", "O+", "O-" };
+
+static const char* reasons[] = {
+    "Routine checkup", "Fever and cough", "Chest pain", "Follow up visit", "Back pain", "Headache"
+};
+
+/* Prints the date `day` days after 01-01-2030 as DD-MM-YYYY. */
+static void print_date(int day) {
+    static const int lengths[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int year = 2030, month = 0;
+    while (1) {
+        int length = lengths[month] + (month == 1 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+        if (day < length) break;
+        day -= length;
+        if (++month == 12) {
+            month = 0;
+            year++;
+        }
+    }
+    printf("%02d-%02d-%04d\n", day + 1, month + 1, year);
+}
+
+static void print_time(int slot) {
+    int minutes = 9 * 60 + slot * 15;
+    int hour = minutes / 60 % 12;
+    printf("%d:%02d %s\n", hour == 0 ? 12 : hour, minutes % 60, minutes < 12 * 60 ? "AM" : "PM");
+}
+
+int main(int argc, char* argv[]) {
+    int patients = argc > 1 ? atoi(argv[1]) : 10000;
+    int appointments = argc > 2 ? atoi(argv[2]) : 2000;
+    int discharges = argc > 3 ? atoi(argv[3]) : 500;
+    if (patients < 1) patients = 1;
+    int typable = patients < TYPABLE_IDS ? patients : TYPABLE_IDS;
+    if (discharges > typable) discharges = typable;
+
+    printf("# Workload: %d patients, %d appointments, %d discharges\n", patients, appointments, discharges);
+    printf("# Generated by tests/replay_workload; run with hms --replay in a prepared directory\n");
+
+    printf("@ login\n1\n1\nadmin\nadmin123\n");
+    printf("@ register_user\n1\n3\ndrhasan\ndoc12345\nHasan Mahmud\n01711111111\nhasan@hms.local\n"
+           "Cardiology\n101\nY\n\n");
+    printf("@ register_user\n1\n2\ndesk\ndesk1234\nY\n\n");
+
+    printf("@ open_menu\n2\n");
+    for (int i = 0; i < patients; i++) {
+        printf("@ add_patient\n1\n");
+        printf("%s %s\n", first_names[i % 16], last_names[i / 16 % 8]);
+        printf("%d\n", 1 + i * 7 % 95);
+        printf("%c\n", i % 2 ? 'F' : 'M');
+        printf("01%d%08d\n", 3 + i % 7, i);
+        printf("%d Hospital Road, Dhaka\n", i % 500 + 1);
+        printf("%s\n", blood_groups[i % 8]);
+        printf("Y\n\n");
+    }
+
+    // A page of the listing per Enter, the last one for the closing pause
+    printf("@ view_patients\n2\n");
+    for (int page = 0; page < (patients + 14) / 15; page++) printf("\n");
+
+    printf("@ logout\n9\n\n7\n\n");
+    printf("@ login\n2\ndesk\ndesk1234\n");
+
+    printf("@ open_menu\n2\n");
+    for (int i = 0; i < appointments; i++) {
+        printf("@ book_appointment\n1\n");
+        printf("%d\n", 1001 + i * 7 % typable);
+        print_date(i / SLOTS_PER_DAY);
+        printf("*\n2001\n");
+        print_time(i % SLOTS_PER_DAY);
+        printf("%s\n", reasons[i % 6]);
+        printf("Y\n\n");
+    }
+    printf("@ close_menu\n4\n\n");
+
+    printf("@ open_menu\n1\n");
+    for (int i = 0; i < discharges; i++) {
+        printf("@ discharge_patient\n6\n%d\n1\n\n", 1001 + i);
+    }
+    printf("@ close_menu\n7\n\n");
+
+    printf("@ logout\n3\n\n");
+    printf("@ exit\n4\n3\n\n");
+    return 0;
+}
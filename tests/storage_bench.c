@@ -0,0 +1,161 @@
+/**
+ * @file storage_bench.c
+ * @brief Commit latency benchmark for the storage write backends
+ *
+ * Seeds a patient table spread over every shard in a scratch directory,
+ * then times single-record edits through each backend twice: saved
+ * synchronously, where every save is one commit (the changed record, the
+ * counts, the header and an fsync), and as a burst queued to the writer
+ * thread while it commits, where the saves it finds waiting are synced
+ * together.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/storage_bench [edits]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/hospital.h"
+#include "../include/patient.h"
+#include "../include/storage.h"
+#include "../include/storage_io.h"
+#include "../include/shard.h"
+
+#define SEED_PATIENTS   100
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void remove_shards(void) {
+    char path[64];
+    for (int shard = 0; shard < PATIENT_SHARDS; shard++) {
+        snprintf(path, sizeof(path), PATIENT_SHARD_FMT, shard);
+        remove(path);
+    }
+}
+
+/* Fresh files, with the IDs spread over the whole range so every shard gets its share */
+static int seed(void) {
+    int seeded = SEED_PATIENTS < MAX_PATIENTS ? SEED_PATIENTS : MAX_PATIENTS;
+    int stride = MAX_PATIENTS / seeded;
+
+    remove_shards();
+    patient_count = seeded;
+    for (int i = 0; i < seeded; i++) {
+        memset(&patients[i], 0, sizeof(Patient));
+        patients[i].id = PATIENT_ID_START + i * stride;
+        patients[i].age = 20 + i % 60;
+        patients[i].is_active = true;
+        snprintf(patients[i].name, NAME_SIZE, "Patient %d", patients[i].id);
+    }
+    if (patient_save_to_file() != 0) return -1;
+    return storage_flush();
+}
+
+/* Changes one patient, taking the shards in turn so consecutive saves go to different files */
+static void edit(int i) {
+    int begin, end;
+    shard_patient_slice(i % PATIENT_SHARDS, &begin, &end);
+    Patient* patient = begin < end ? &patients[begin + (i / PATIENT_SHARDS) % (end - begin)]
+                                   : &patients[i % patient_count];
+    patient->age = patient->age >= 79 ? 20 : patient->age + 1;
+}
+
+static bool select_backend(StorageIoBackend wanted) {
+    if (storage_io_select(wanted) == wanted) return true;
+    printf("%-8s unavailable\n", storage_io_name(wanted));
+    return false;
+}
+
+static int run_sync(StorageIoBackend wanted, double* samples, int edits) {
+    if (!select_backend(wanted)) return 0;
+    if (seed() != 0) return -1;
+
+    double start = now_us();
+    for (int i = 0; i < edits; i++) {
+        edit(i);
+        double t = now_us();
+        if (patient_save_to_file() != 0) return -1;
+        samples[i] = now_us() - t;
+    }
+    double total = now_us() - start;
+
+    qsort(samples, (size_t)edits, sizeof(double), compare_double);
+    double sum = 0;
+    for (int i = 0; i < edits; i++) sum += samples[i];
+    printf("%-8s p50 %8.1f us  p99 %8.1f us  mean %8.1f us  %8.0f commits/s\n",
+           storage_io_name(wanted), samples[edits / 2], samples[edits * 99 / 100],
+           sum / edits, edits / (total / 1e6));
+    return 0;
+}
+
+/* Queues every edit to the writer thread as fast as it takes them, then waits for the last */
+static int run_burst(StorageIoBackend wanted, int edits) {
+    if (!select_backend(wanted)) return 0;
+    if (seed() != 0) return -1;
+
+    double start = now_us();
+    for (int i = 0; i < edits; i++) {
+        edit(i);
+        if (patient_save_to_file() != 0) return -1;
+    }
+    if (storage_flush() != 0) return -1;
+    double total = now_us() - start;
+
+    printf("%-8s total %8.1f ms  mean %8.1f us  %8.0f commits/s\n",
+           storage_io_name(wanted), total / 1e3, total / edits, edits / (total / 1e6));
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    int edits = argc > 1 ? atoi(argv[1]) : 2000;
+    if (edits <= 0) edits = 2000;
+
+    char scratch[] = "/tmp/hms_bench_XXXXXX";
+    double* samples = malloc(sizeof(double) * (size_t)edits);
+    if (samples == NULL || mkdtemp(scratch) == NULL || chdir(scratch) != 0) {
+        fprintf(stderr, "Could not set up the scratch directory\n");
+        return 1;
+    }
+    ensure_data_dir();
+
+    printf("%d single-record edits over %d patients in %d shards, saved one at a time\n",
+           edits, SEED_PATIENTS < MAX_PATIENTS ? SEED_PATIENTS : MAX_PATIENTS, PATIENT_SHARDS);
+    int failed = 0;
+    for (int b = STORAGE_IO_STDIO; b <= STORAGE_IO_URING; b++) {
+        if (run_sync(b, samples, edits) != 0) {
+            printf("%-8s FAILED\n", storage_io_name(b));
+            failed = 1;
+        }
+    }
+
+    printf("\nThe same edits as a burst through the writer thread\n");
+    if (storage_start_writer() != 0) {
+        printf("writer thread unavailable\n");
+        failed = 1;
+    }
+    for (int b = STORAGE_IO_STDIO; b <= STORAGE_IO_URING && !failed; b++) {
+        if (run_burst(b, edits) != 0) {
+            printf("%-8s FAILED\n", storage_io_name(b));
+            failed = 1;
+        }
+    }
+
+    remove_shards();
+    rmdir("data");
+    chdir("/");
+    rmdir(scratch);
+    free(samples);
+    return failed;
+}
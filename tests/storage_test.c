@@ -0,0 +1,152 @@
+/**
+ * @file storage_test.c
+ * @brief Two-terminal save tests for the storage layer
+ *
+ * Each case seeds the doctor table in a scratch directory, lets a second
+ * process (the other terminal) save its change from the same base, and
+ * then saves this terminal's change without a writer thread. The case
+ * checks whether that save went through or was refused, and what the
+ * data file holds afterwards. Every case runs in a process of its own,
+ * so the storage layer starts from nothing each time. Refused saves print
+ * the usual conflict message.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/storage_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../include/hospital.h"
+#include "../include/storage.h"
+
+#define SEED_DOCTORS    3
+
+typedef struct {
+    const char* name;
+    void (*theirs)(void);       /* The other terminal's change, saved first */
+    void (*ours)(void);
+    bool saved;                 /* Whether our save should go through */
+    int count;                  /* Doctors on disk afterwards */
+    int available;
+    int rooms[SEED_DOCTORS + 1];    /* Their room numbers on disk, in order */
+} StorageCase;
+
+static void seed(void) {
+    doctor_count = doctor_available = SEED_DOCTORS;
+    for (int i = 0; i < SEED_DOCTORS; i++) {
+        memset(&doctors[i], 0, sizeof(Doctor));
+        doctors[i].id = DOCTOR_ID_START + i;
+        doctors[i].room_number = 100 + i;
+        doctors[i].is_available = true;
+        doctors[i].is_active = true;
+        snprintf(doctors[i].name, NAME_SIZE, "Doctor %d", i);
+    }
+}
+
+static void add_doctor(int room) {
+    Doctor* d = &doctors[doctor_count];
+    memset(d, 0, sizeof(*d));
+    d->id = DOCTOR_ID_START + 10 + room;
+    d->room_number = room;
+    d->is_available = true;
+    d->is_active = true;
+    doctor_count++;
+    doctor_available++;
+}
+
+static void delete_doctor(int index) {
+    memmove(&doctors[index], &doctors[index + 1], (size_t)(doctor_count - index - 1) * sizeof(Doctor));
+    doctor_count--;
+    doctor_available--;
+}
+
+static void edit_first(void) { doctors[0].room_number = 600; }
+static void edit_second(void) { doctors[1].room_number = 500; }
+static void edit_first_too(void) { doctors[0].room_number = 700; }
+static void add_one(void) { add_doctor(300); }
+static void delete_second(void) { delete_doctor(1); }
+static void delete_last(void) { delete_doctor(SEED_DOCTORS - 1); }
+
+/* More saves than the header's change log holds */
+static void edit_last_often(void) {
+    for (int i = 0; i < 40; i++) {
+        doctors[SEED_DOCTORS - 1].room_number = 800 + i;
+        if (i < 39 && storage_save(TABLE_DOCTORS) != 0) _exit(1);
+    }
+}
+
+static const StorageCase cases[] = {
+    { "edits to different records both land", edit_second, edit_first, true, 3, 3, { 600, 500, 102 } },
+    { "an edit to the same record is refused", edit_first_too, edit_first, false, 3, 3, { 700, 101, 102 } },
+    { "a delete is refused after another terminal adds", add_one, delete_second, false, 4, 4, { 100, 101, 102, 300 } },
+    { "an add is refused after another terminal deletes", delete_second, add_one, false, 2, 2, { 100, 102 } },
+    { "an edit lands beside another terminal's delete", delete_last, edit_first, true, 2, 2, { 600, 101 } },
+    { "a save past the change log is refused", edit_last_often, edit_first, false, 3, 3, { 100, 101, 839 } },
+};
+
+/* Runs one case in this process; returns 0 if everything matched. */
+static int run_case(const StorageCase* c) {
+    seed();
+    if (storage_save(TABLE_DOCTORS) != 0) return 1;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        c->theirs();
+        _exit(storage_save(TABLE_DOCTORS) != 0);
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return 1;
+    }
+
+    c->ours();
+    bool saved = storage_save(TABLE_DOCTORS) == 0;
+    if (storage_load(TABLE_DOCTORS) != 0) return 1;
+
+    int failed = saved != c->saved || doctor_count != c->count || doctor_available != c->available;
+    for (int i = 0; i < doctor_count && i < c->count; i++) {
+        if (doctors[i].room_number != c->rooms[i]) failed = 1;
+    }
+    printf("  Expected: %s, %d doctors, %d available\n", c->saved ? "saved" : "refused", c->count, c->available);
+    printf("  Actual:   %s, %d doctors, %d available\n", saved ? "saved" : "refused", doctor_count, doctor_available);
+    return failed;
+}
+
+int main(void) {
+    char scratch[] = "/tmp/hms_storage_XXXXXX";
+    if (mkdtemp(scratch) == NULL || chdir(scratch) != 0) {
+        fprintf(stderr, "Could not set up the scratch directory\n");
+        return 1;
+    }
+    ensure_data_dir();
+
+    printf("=== STORAGE TWO-TERMINAL TEST ===\n\n");
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        remove(DOCTORS_FILE);
+        printf("%s:\n", cases[i].name);
+        fflush(stdout);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            int result = run_case(&cases[i]);
+            fflush(stdout);
+            _exit(result);
+        }
+        int status;
+        bool ok = pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        printf("\n  Success:  %s\n\n", ok ? "Yes" : "No");
+        if (!ok) failures++;
+    }
+
+    remove(DOCTORS_FILE);
+    rmdir("data");
+    rmdir("logs");
+    chdir("/");
+    rmdir(scratch);
+    printf("%s\n", failures == 0 ? "All passed." : "Some cases failed.");
+    return failures == 0 ? 0 : 1;
+}
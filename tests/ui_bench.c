@@ -0,0 +1,188 @@
+/**
+ * @file ui_bench.c
+ * @brief Card rendering benchmark for the frame buffer renderer
+ *
+ * Renders the same patient cards through the printf-per-glyph renderer the
+ * menus used before (kept here as legacy_print_menu) and through
+ * ui_print_patient, first into two files that must match byte for byte,
+ * then into /dev/null for timing, and last into the null sink, which
+ * leaves out the write() calls. Results go to stderr.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/ui_bench [cards]
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/hospital.h"
+#include "../include/ui.h"
+#include "../include/utils.h"
+
+#define SAMPLE_PATIENTS 64
+
+static Patient samples[SAMPLE_PATIENTS];
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* ui_print_menu as it was: one printf per glyph, padding space and line */
+static void legacy_print_menu(const char *title, const char *items[], int item_count, int box_width) {
+    const char* h = "═";
+    const char* v = "║";
+
+    printf(BRIGHT_BLACK "%s", "╔");
+    for (int i = 0; i < box_width; i++) printf("%s", h);
+    printf("%s" RESET "\n", "╗");
+
+    char title_upper[100];
+    strncpy(title_upper, title, sizeof(title_upper) - 1);
+    title_upper[sizeof(title_upper) - 1] = '\0';
+    utils_str_to_upper(title_upper);
+
+    int title_len = strlen(title_upper) + 4;
+    int title_padding = (box_width - title_len) / 2;
+    printf(BRIGHT_BLACK "%s" RESET, v);
+    for (int i = 0; i < title_padding; i++) printf(" ");
+    printf(BG_NEON_PURPLE BOLD "  %s  " RESET, title_upper);
+    for (int i = 0; i < box_width - title_padding - title_len; i++) printf(" ");
+    printf(BRIGHT_BLACK "%s" RESET "\n", v);
+
+    printf(BRIGHT_BLACK "%s" RESET, v);
+    for (int i = 0; i < box_width; i++) printf(" ");
+    printf(BRIGHT_BLACK "%s" RESET "\n", v);
+
+    for (int i = 0; i < item_count - 1; i++) {
+        int item_len = strlen(items[i]);
+        printf(BRIGHT_BLACK "%s" RESET "  " SOFT_YELLOW BOLD "%d. %s" RESET, v, i + 1, items[i]);
+        for (int j = 0; j < box_width - item_len - 5; j++) printf(" ");
+        printf(BRIGHT_BLACK "%s" RESET "\n", v);
+    }
+
+    printf(BRIGHT_BLACK "%s" RESET, v);
+    for (int i = 0; i < box_width; i++) printf(" ");
+    printf(BRIGHT_BLACK "%s" RESET "\n", v);
+    printf(BRIGHT_BLACK "%s", "╚");
+    for (int i = 0; i < box_width; i++) printf("%s", h);
+    printf("%s" RESET "\n\n", "╝");
+
+    printf(BOLD SOFT_GREEN "%s" RESET, items[item_count - 1]);
+}
+
+/* ui_print_patient's lines, handed to the legacy renderer */
+static void legacy_print_patient(Patient patient, int index) {
+    char lines[8][120];
+    snprintf(lines[0], sizeof(lines[0]), "Patient ID: %d", patient.id);
+    snprintf(lines[1], sizeof(lines[1]), "Name: %s", patient.name);
+    snprintf(lines[2], sizeof(lines[2]), "Age: %d", patient.age);
+    snprintf(lines[3], sizeof(lines[3]), "Gender: %s", patient.gender == MALE ? "Male" : "Female");
+    snprintf(lines[4], sizeof(lines[4]), "Phone: %s", patient.phone);
+    snprintf(lines[5], sizeof(lines[5]), "Address: %s", patient.address);
+    snprintf(lines[6], sizeof(lines[6]), "Blood Group: %s", patient.blood_group);
+    snprintf(lines[7], sizeof(lines[7]), "Status: %s", patient.is_active ? "Active" : "Inactive");
+
+    const char* items[] = { lines[0], lines[1], lines[2], lines[3], lines[4], lines[5], lines[6], lines[7], "" };
+    char title[70];
+    snprintf(title, sizeof(title), "Patient %d", index + 1);
+    legacy_print_menu(title, items, 9, 72);
+}
+
+/* Points stdout at path; returns the descriptor to restore it with. */
+static int redirect(const char* path) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+    return saved;
+}
+
+static void restore(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+static double render(bool legacy, bool framed, int cards, const char* path) {
+    int saved = redirect(path);
+    double start = now_us();
+    if (framed) ui_frame_begin();
+    for (int i = 0; i < cards; i++) {
+        if (legacy) legacy_print_patient(samples[i % SAMPLE_PATIENTS], i);
+        else ui_print_patient(samples[i % SAMPLE_PATIENTS], i);
+    }
+    if (framed) ui_frame_end();
+    fflush(stdout);
+    double elapsed = now_us() - start;
+    restore(saved);
+    return elapsed;
+}
+
+static bool same_file(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    bool same = fa != NULL && fb != NULL;
+    while (same) {
+        int ca = getc(fa), cb = getc(fb);
+        if (ca != cb) same = false;
+        if (ca == EOF) break;
+    }
+    if (fa != NULL) fclose(fa);
+    if (fb != NULL) fclose(fb);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    int cards = argc > 1 ? atoi(argv[1]) : 20000;
+    if (cards <= 0) cards = 20000;
+
+    for (int i = 0; i < SAMPLE_PATIENTS; i++) {
+        samples[i].id = PATIENT_ID_START + i;
+        samples[i].age = 20 + i % 60;
+        samples[i].gender = i % 2 ? FEMALE : MALE;
+        samples[i].is_active = i % 5 != 0;
+        snprintf(samples[i].name, NAME_SIZE, "Patient Number %d", i + 1);
+        snprintf(samples[i].phone, PHONE_SIZE, "017%08d", i);
+        snprintf(samples[i].address, ADDRESS_SIZE, "%d Hospital Road", i + 1);
+        snprintf(samples[i].blood_group, BLOOD_SIZE, "%s", i % 3 ? "A+" : "O-");
+    }
+
+    char legacy_path[] = "/tmp/hms_ui_legacy_XXXXXX";
+    char frame_path[] = "/tmp/hms_ui_frame_XXXXXX";
+    close(mkstemp(legacy_path));
+    close(mkstemp(frame_path));
+    render(true, false, SAMPLE_PATIENTS, legacy_path);
+    render(false, false, SAMPLE_PATIENTS, frame_path);
+    bool same = same_file(legacy_path, frame_path);
+    remove(legacy_path);
+    remove(frame_path);
+    if (!same) {
+        fprintf(stderr, "FAILED: frame output differs from the printf renderer\n");
+        return 1;
+    }
+
+    double legacy = render(true, false, cards, "/dev/null");
+    double card = render(false, false, cards, "/dev/null");
+    double screen = render(false, true, cards, "/dev/null");
+    ui_sink_select(UI_SINK_NULL);
+    ui_sink_reset();
+    double headless = render(false, false, cards, "/dev/null");
+    UiSinkStats stats = ui_sink_stats();
+    ui_sink_select(UI_SINK_TERMINAL);
+
+    fprintf(stderr, "%d patient cards, output identical\n", cards);
+    fprintf(stderr, "%-14s %9.0f us  %8.0f cards/s\n", "printf", legacy, cards / (legacy / 1e6));
+    fprintf(stderr, "%-14s %9.0f us  %8.0f cards/s  %5.1fx\n", "frame/card", card,
+            cards / (card / 1e6), legacy / card);
+    fprintf(stderr, "%-14s %9.0f us  %8.0f cards/s  %5.1fx\n", "frame/screen", screen,
+            cards / (screen / 1e6), legacy / screen);
+    fprintf(stderr, "%-14s %9.0f us  %8.0f cards/s  %5.1fx  (%zu frames, %zu bytes)\n", "null sink",
+            headless, cards / (headless / 1e6), legacy / headless, stats.writes, stats.bytes);
+    return 0;
+}
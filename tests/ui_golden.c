@@ -0,0 +1,191 @@
+/**
+ * @file ui_golden.c
+ * @brief Golden output tests for the ui_* renderers
+ *
+ * Renders the banner, a menu, every card, a two-page table and the
+ * messages into the buffer sink and compares each with its file in
+ * tests/golden. The pauses get an input that has already ended, so
+ * nothing is read from the keyboard. After an intended change to the
+ * look of a screen, run with --update to rewrite the files and review
+ * the diff.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/ui_golden [--update]   (from the project directory)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/appointment.h"
+#include "../include/hospital.h"
+#include "../include/ui.h"
+#include "../include/utils.h"
+
+#define GOLDEN_DIR "tests/golden"
+
+static bool update;
+static int failures;
+
+static void sample_data(void) {
+    patient_count = 20;
+    for (int i = 0; i < patient_count; i++) {
+        Patient* p = &patients[i];
+        memset(p, 0, sizeof(*p));
+        p->id = PATIENT_ID_START + i;
+        p->age = 20 + i * 3;
+        p->gender = i % 2 ? FEMALE : MALE;
+        p->is_active = true;
+        snprintf(p->name, NAME_SIZE, "%s", i == 3 ? "Bartholomew Alexander Montgomery-Smythe" : "Rahim Uddin");
+        snprintf(p->phone, PHONE_SIZE, "017%08d", i);
+        snprintf(p->address, ADDRESS_SIZE, "%d Hospital Road, Dhaka", i + 1);
+        snprintf(p->blood_group, BLOOD_SIZE, "%s", i % 3 ? "A+" : "O-");
+    }
+
+    doctor_count = 1;
+    memset(&doctors[0], 0, sizeof(doctors[0]));
+    doctors[0].id = DOCTOR_ID_START;
+    doctors[0].room_number = 204;
+    doctors[0].is_available = true;
+    doctors[0].is_active = true;
+    snprintf(doctors[0].name, NAME_SIZE, "Farhana Akter");
+    snprintf(doctors[0].phone, PHONE_SIZE, "01811111111");
+    snprintf(doctors[0].email, EMAIL_SIZE, "farhana@hms.local");
+    snprintf(doctors[0].specialization, sizeof(doctors[0].specialization), "Cardiology");
+
+    receptionist_count = 1;
+    memset(&receptionists[0], 0, sizeof(receptionists[0]));
+    receptionists[0].id = RECEPTIONIST_ID_START;
+    receptionists[0].is_active = true;
+    snprintf(receptionists[0].name, NAME_SIZE, "Nusrat Jahan");
+    snprintf(receptionists[0].phone, PHONE_SIZE, "01922222222");
+    snprintf(receptionists[0].email, EMAIL_SIZE, "nusrat@hms.local");
+
+    appointment_count = 1;
+    memset(&appointments[0], 0, sizeof(appointments[0]));
+    appointments[0].id = APPOINTMENT_ID_START;
+    appointments[0].patient_id = patients[3].id;
+    appointments[0].doctor_id = doctors[0].id;
+    appointments[0].status = APPT_CONFIRMED;
+    snprintf(appointments[0].date, sizeof(appointments[0].date), "05-12-2025");
+    snprintf(appointments[0].time_slot, sizeof(appointments[0].time_slot), "10:00 AM");
+    snprintf(appointments[0].reason, REASON_SIZE, "Chest pain after exercise");
+}
+
+static int no_input(void* context, char* buffer, size_t size) {
+    (void)context;
+    (void)buffer;
+    (void)size;
+    return -1;
+}
+
+static const InputSource ended = { no_input, NULL };
+
+static char* read_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* data = malloc(size > 0 ? (size_t)size : 1);
+    *length = data != NULL ? fread(data, 1, (size_t)size, file) : 0;
+    fclose(file);
+    return data;
+}
+
+/* Compares what the buffer sink holds with the golden file, or rewrites it. */
+static void check(const char* name) {
+    char path[256];
+    snprintf(path, sizeof(path), GOLDEN_DIR "/%s.txt", name);
+
+    size_t length;
+    const char* output = ui_sink_buffer(&length);
+
+    if (update) {
+        FILE* file = fopen(path, "wb");
+        if (file == NULL || fwrite(output, 1, length, file) != length) {
+            printf("  %-20s could not write %s\n", name, path);
+            failures++;
+        } else {
+            printf("  %-20s updated (%zu bytes)\n", name, length);
+        }
+        if (file != NULL) fclose(file);
+        ui_sink_reset();
+        return;
+    }
+
+    size_t expected_length = 0;
+    char* expected = read_file(path, &expected_length);
+    if (expected == NULL) {
+        printf("  %-20s FAILED: %s missing (run with --update)\n", name, path);
+        failures++;
+        ui_sink_reset();
+        return;
+    }
+
+    size_t at = 0;
+    while (at < length && at < expected_length && output[at] == expected[at]) at++;
+    if (at == length && at == expected_length) {
+        printf("  %-20s ok\n", name);
+    } else {
+        int line = 1;
+        for (size_t i = 0; i < at; i++) {
+            if (output[i] == '\n') line++;
+        }
+        printf("  %-20s FAILED: differs from %s at byte %zu (line %d)\n", name, path, at, line);
+        failures++;
+    }
+    free(expected);
+    ui_sink_reset();
+}
+
+int main(int argc, char* argv[]) {
+    update = argc > 1 && strcmp(argv[1], "--update") == 0;
+    unsetenv("HMS_VIEW");       // Listings in their default table view
+    sample_data();
+
+    utils_set_input(&ended);
+    ui_sink_select(UI_SINK_BUFFER);
+    ui_sink_reset();
+    printf("UI golden output (%s):\n", GOLDEN_DIR);
+
+    ui_print_banner();
+    check("banner");
+
+    const char* menu[] = { "Patient Management", "Doctor Management", "Appointments", "Logout", ">> " };
+    ui_print_menu("Admin Menu", menu, 5, UI_SIZE);
+    check("menu");
+
+    ui_print_patient(patients[3], 0);
+    check("patient_card");
+
+    ui_print_doctor(doctors[0], 0);
+    check("doctor_card");
+
+    ui_print_receptionist(receptionists[0], 0);
+    check("receptionist_card");
+
+    ui_print_appointment(appointments[0], 0);
+    check("appointment_card");
+
+    ui_list_begin("All Patients");
+    for (int i = 0; i < patient_count; i++) ui_list_patient(patients[i], i);
+    ui_list_end();
+    check("patient_table");
+
+    ui_list_begin("Appointments");
+    ui_list_appointment(appointments[0], 0);
+    ui_list_end();
+    check("appointment_table");
+
+    ui_print_success("Patient added successfully!");
+    ui_print_error("Invalid choice!");
+    ui_print_warning("No appointments found.");
+    ui_print_info("Data saved.");
+    ui_pause();
+    check("messages");
+
+    ui_sink_select(UI_SINK_TERMINAL);
+    printf("%s\n", failures == 0 ? "All passed." : "Some outputs differ.");
+    return failures == 0 ? 0 : 1;
+}
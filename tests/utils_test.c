@@ -161,6 +161,57 @@ void test_utils_is_valid_address() {
     printf("  Success:  %s\n\n", (expected3 == actual3) ? "Yes" : "No");
 }
 
+void test_utils_parse_int() {
+    printf("Testing utils_parse_int():\n\n");
+
+    const char *inputs[] = { " 42 ", "-2147483648", "2147483648", "12abc", "abc", "" };
+    ParseStatus expected[] = { PARSE_OK, PARSE_OK, PARSE_RANGE, PARSE_TRAILING, PARSE_INVALID, PARSE_EMPTY };
+    int values[] = { 42, -2147483647 - 1, 0, 0, 0, 0 };
+
+    for (int i = 0; i < 6; i++) {
+        int value = 0;
+        ParseStatus actual = utils_parse_int(inputs[i], &value);
+        int success = (actual == expected[i]) && (actual != PARSE_OK || value == values[i]);
+        printf("  Input:    \"%s\"\n", inputs[i]);
+        printf("  Expected: %s\n", utils_parse_message(expected[i]));
+        printf("  Actual:   %s\n", utils_parse_message(actual));
+        printf("  Success:  %s\n\n", success ? "Yes" : "No");
+    }
+}
+
+void test_utils_parse_double() {
+    printf("Testing utils_parse_double():\n\n");
+
+    const char *inputs[] = { "3.14", "-.5", "1e-3", "1e999", "1e", "." };
+    ParseStatus expected[] = { PARSE_OK, PARSE_OK, PARSE_OK, PARSE_RANGE, PARSE_TRAILING, PARSE_INVALID };
+    double values[] = { 3.14, -0.5, 0.001, 0, 0, 0 };
+
+    for (int i = 0; i < 6; i++) {
+        double value = 0;
+        ParseStatus actual = utils_parse_double(inputs[i], &value);
+        int success = (actual == expected[i]) && (actual != PARSE_OK || value == values[i]);
+        printf("  Input:    \"%s\"\n", inputs[i]);
+        printf("  Expected: %s\n", utils_parse_message(expected[i]));
+        printf("  Actual:   %s\n", utils_parse_message(actual));
+        printf("  Success:  %s\n\n", success ? "Yes" : "No");
+    }
+}
+
+void test_utils_date_key() {
+    printf("Testing utils_date_key():\n\n");
+
+    const char *inputs[] = { "31-01-2025", "31-04-2025", "29-02-2024", "29-02-2025", "29-02-1900", "29-02-2000" };
+    int expected[] = { 20250131, 0, 20240229, 0, 0, 20000229 };
+
+    for (int i = 0; i < 6; i++) {
+        int actual = utils_date_key(inputs[i]);
+        printf("  Input:    \"%s\"\n", inputs[i]);
+        printf("  Expected: %d\n", expected[i]);
+        printf("  Actual:   %d\n", actual);
+        printf("  Success:  %s\n\n", (actual == expected[i]) ? "Yes" : "No");
+    }
+}
+
 int main() {
     printf("=== UTILITY FUNCTIONS TEST ===\n\n");
     
@@ -174,6 +225,9 @@ int main() {
     test_utils_str_to_upper();
     test_utils_is_valid_blood_group();
     test_utils_is_valid_address();
+    test_utils_parse_int();
+    test_utils_parse_double();
+    test_utils_date_key();
     
     return 0;
 }
\ No newline at end of file
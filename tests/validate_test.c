@@ -0,0 +1,170 @@
+/**
+ * @file validate_test.c
+ * @brief Differential test of the batch field validators
+ *
+ * Fills arrays of fixed-width fields with random values close to the
+ * rules (mostly the allowed characters, with stray high bytes, misplaced
+ * '@' and '.', wrong lengths, empty and unterminated fields) and checks
+ * that every kernel gives the same answer as utils_is_valid_* for each
+ * field, at a stride equal to the width and at an odd one. Then times the
+ * kernels on valid fields. Results go to stderr.
+ *
+ * Build: see the Testing section of README.md
+ * Usage: tests/validate_test [fields]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/utils.h"
+#include "../include/validate.h"
+
+typedef struct {
+    const char* name;
+    size_t width;
+    const char* alphabet;
+    size_t (*batch)(const char*, size_t, size_t, bool*);
+    bool (*single)(const char*);
+    const char* sample;     /* A valid value, for timing */
+} FieldCase;
+
+static const FieldCase cases[] = {
+    { "name", NAME_SIZE, "abcxyzABCXYZ    ", validate_names, utils_is_valid_name, "Farhana Chowdhury" },
+    { "phone", PHONE_SIZE, "0123456789", validate_phones, utils_is_valid_phone, "01712345678" },
+    { "email", EMAIL_SIZE, "abz09AZ@..", validate_emails, utils_is_valid_email, "farhana.chowdhury@hms.local" },
+    { "address", ADDRESS_SIZE, "aZ09 ,.", validate_addresses, utils_is_valid_address,
+      "House 12, Road 7, Dhanmondi, Dhaka" },
+    { "blood group", BLOOD_SIZE, "ABOabo+-U", validate_blood_groups, utils_is_valid_blood_group, "AB+" },
+};
+
+static unsigned long long rng_state = 0x2545F4914F6CDD1DULL;
+
+static unsigned next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (unsigned)(rng_state >> 32);
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void random_field(const FieldCase* c, char* field) {
+    memset(field, 0, c->width);
+    size_t alphabet = strlen(c->alphabet);
+    unsigned shape = next_random() % 16;
+    size_t length;
+
+    if (shape == 0) length = 0;
+    else if (shape == 1) length = c->width;                 // No NUL
+    else if (shape == 2) length = c->width - 1;
+    else if (strcmp(c->name, "phone") == 0 && shape < 10) length = 11;
+    else length = 1 + next_random() % (c->width - 1);
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned pick = next_random() % 64;
+        if (pick == 0) field[i] = (char)(0x80 | next_random() % 128);
+        else if (pick == 1) field[i] = (char)(1 + next_random() % 127);
+        else field[i] = c->alphabet[next_random() % alphabet];
+    }
+    if (strcmp(c->name, "phone") == 0 && length == 11 && shape < 8) {
+        field[0] = '0';
+        field[1] = '1';
+    }
+    if (shape == 3 && length > 0) field[0] = '@';
+    // Garbage after the NUL must not matter
+    if (length + 1 < c->width) field[c->width - 1] = (char)next_random();
+}
+
+/* Checks each kernel against the single-string function; returns the mismatches. */
+static int differential(const FieldCase* c, size_t count, size_t stride) {
+    char* fields = malloc(stride * count);
+    bool* expected = malloc(count);
+    bool* actual = malloc(count);
+    if (fields == NULL || expected == NULL || actual == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    memset(fields, 'x', stride * count);
+    for (size_t i = 0; i < count; i++) {
+        char* field = fields + stride * i;
+        random_field(c, field);
+        expected[i] = memchr(field, '\0', c->width) != NULL && c->single(field);
+    }
+
+    int mismatches = 0;
+    for (int k = VALIDATE_SCALAR; k <= VALIDATE_AVX2; k++) {
+        if (validate_select((ValidateKernel)k) != (ValidateKernel)k) continue;
+        size_t passed = c->batch(fields, stride, count, actual);
+        size_t want = 0;
+        for (size_t i = 0; i < count; i++) {
+            want += expected[i];
+            if (actual[i] == expected[i]) continue;
+            if (mismatches++ < 5) {
+                fprintf(stderr, "  %s/%s: field %zu \"%.*s\" expected %s\n", c->name, validate_name((ValidateKernel)k),
+                        i, (int)c->width, fields + stride * i, expected[i] ? "valid" : "invalid");
+            }
+        }
+        if (passed != want) mismatches++;
+    }
+
+    free(fields);
+    free(expected);
+    free(actual);
+    return mismatches;
+}
+
+static void throughput(const FieldCase* c, size_t count) {
+    char* fields = calloc(count, c->width);
+    bool* valid = malloc(count);
+    if (fields == NULL || valid == NULL) return;
+    for (size_t i = 0; i < count; i++) snprintf(fields + c->width * i, c->width, "%s", c->sample);
+
+    double scalar = 0;
+    for (int k = VALIDATE_SCALAR; k <= VALIDATE_AVX2; k++) {
+        if (validate_select((ValidateKernel)k) != (ValidateKernel)k) continue;
+        double elapsed = 0;
+        size_t passed = 0;
+        for (int run = 0; run < 3; run++) {     // Best of three
+            double start = now_us();
+            passed = c->batch(fields, c->width, count, valid);
+            double time = now_us() - start;
+            if (run == 0 || time < elapsed) elapsed = time;
+        }
+        if (k == VALIDATE_SCALAR) scalar = elapsed;
+
+        fprintf(stderr, "%-12s %-7s %9.0f us  %6.1f Mfields/s  %5.1fx%s\n", c->name,
+                validate_name((ValidateKernel)k), elapsed, count / elapsed, scalar / elapsed,
+                passed == count ? "" : "  (MISMATCH)");
+    }
+
+    free(fields);
+    free(valid);
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 200000;
+    if (count < 1) count = 1;
+    int failures = 0;
+
+    ValidateKernel best = validate_kernel();
+    fprintf(stderr, "Best kernel on this CPU: %s\n", validate_name(best));
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        int mismatches = differential(&cases[i], count, cases[i].width)
+                       + differential(&cases[i], count, cases[i].width + 7);
+        fprintf(stderr, "%-12s %s\n", cases[i].name, mismatches == 0 ? "identical" : "FAILED");
+        failures += mismatches != 0;
+    }
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) throughput(&cases[i], count * 5);
+
+    validate_select(best);
+    fprintf(stderr, "%s\n", failures == 0 ? "All passed." : "Some kernels differ from the scalar checks.");
+    return failures == 0 ? 0 : 1;
+}